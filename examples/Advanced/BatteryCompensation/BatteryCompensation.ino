@@ -0,0 +1,75 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * IMPORTANT!!!!
+ * Before you use this example you MUST calibrate the line sensor. Use example
+ * CalibrateLineSensor first!!!
+ *
+ * Description:
+ * The robot follows the line with a PID controller, as in the LineFollowPID
+ * example, but drives the motors with open-loop moveRAW() duty cycles. The
+ * duty cycles and the gains are scaled by the nominal over the measured
+ * battery voltage, so the robot behaves the same with a full or a discharged
+ * battery. The speeds of move() are held by the co-processor and need no
+ * compensation. The filtered voltage and the predicted remaining runtime are
+ * shown on the LCD.
+ * Place the robot on the line and press a push button to start.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/BatteryCompensator.h"
+#include "utils/PidController.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define NOMINAL_BATTERY_V 12.0  // Battery voltage at which gains were tuned
+#define CONTROL_PERIOD_MS 10    // Control cycle time in loop
+#define DUTY_CYCLE 40           // Duty cycle of both wheels on a straight line
+#define KP 1.3                  // PID gains tuned at NOMINAL_BATTERY_V
+#define KI 0.01
+#define KD 0.35
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A+
+BatteryCompensator battery(one, NOMINAL_BATTERY_V, MINIMUM_BATTERY_V);
+PidController pid(KP, KI, KD);
+unsigned long tcycle;    // Control cycle time in loop
+unsigned long tdisplay;  // Time of the next LCD update
+
+void setup() {
+  one.spiConnect(SSPIN);                  // Start SPI communication module
+  one.stop();                             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("Battery Compens.");
+  one.lcd2("Press a Button!!");
+  // Wait a button to be pressed <> Espera que pressione um botão
+  while (one.readButton() == 0)
+    ;
+  // Wait for button release <> Espera que largue o botão
+  while (one.readButton() != 0)
+    ;
+  tcycle = millis();  // Set start value for tcycle
+  tdisplay = tcycle;
+}
+
+void loop() {
+  if (millis() < tcycle) return;
+  tcycle += CONTROL_PERIOD_MS;
+
+  battery.update();  // Reads the battery only every few hundred milliseconds
+  pid.setGains(battery.compensateGain(KP),
+               battery.compensateGain(KI),
+               battery.compensateGain(KD));
+  const int duty_cycle = battery.compensate(DUTY_CYCLE);
+  const int output = pid.compute(0, one.readLine());
+  one.moveRAW(duty_cycle - output, duty_cycle + output);
+
+  if (millis() >= tdisplay) {
+    tdisplay += 1000;
+    one.lcd1("Battery(mV):", (int)(battery.getVoltage() * 1000));
+    one.lcd2("Runtime(s):", (int)battery.getRemainingRuntimeS());
+  }
+}
@@ -0,0 +1,57 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * The robot moves straight forward and back for one meter at high speed
+ * holding its heading. The split of the wheel speeds is corrected every
+ * control cycle from the heading change measured by the encoders. If
+ * USE_COMPASS is defined the heading is also fused with the CMPS11/CMPS12
+ * compass, which does not drift.
+ * Press push button 1 to start.
+ */
+
+#include <BnrCompass.h>   // Compass library
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/MotionGenerator.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define ADDRESS 0x60            // CMPS11 I2C address
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define DISTANCE_MM 1000        // Distance to travel
+#define SPEED_MMPS 600          // Speed of the motion
+#define HEADING_GAIN 6.0        // Heading correction gain (1/s)
+// #define USE_COMPASS          // Uncomment if the compass is installed
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+BnrCompass compass(ADDRESS);
+MotionGenerator one_mg(one);
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("  Heading Hold  ");
+  one.lcd2("Press PB1");
+
+  one_mg.setVelocityProfile(VelocityProfile::Type::TRAPEZOIDAL);
+#ifdef USE_COMPASS
+  one_mg.setHeadingHold(HEADING_GAIN, &compass);
+#else
+  one_mg.setHeadingHold(HEADING_GAIN);
+#endif
+}
+
+void loop() {
+  if (one.readButton() != 1) return;
+
+  delay(1000);  // Time to release the button
+  one_mg.moveStraightAtSpeed(DISTANCE_MM, SPEED_MMPS);
+  delay(500);
+  one_mg.moveStraightAtSpeed(DISTANCE_MM, -SPEED_MMPS);
+}
@@ -0,0 +1,91 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * Runs motion scripts with the MotionScript class.
+ * Push button 1 runs the script stored in PROGMEM: the robot draws squares
+ * and backs away whenever an obstacle is detected in front of it.
+ * Push button 2 waits for a script sent over the serial port and saves it in
+ * EEPROM. The script is sent as its size (2 bytes, most significant first),
+ * the script bytes and the 8 bit sum of the script bytes.
+ * Push button 3 runs the script saved in EEPROM.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/MotionScript.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define MAX_SCRIPT_SIZE 128     // Size of the buffer for received scripts
+
+// Squares of 300 mm, backing away from obstacles
+const byte SQUARES[] PROGMEM = {MS_SPEED(200),
+                                MS_LOOP(3),
+                                MS_LOOP(4),
+                                MS_IF_OBSTACLE(3),
+                                MS_LINE(-100),
+                                MS_ROTATE(180),
+                                MS_ELSE,
+                                MS_LINE(300),
+                                MS_ROTATE(90),
+                                MS_END_IF,
+                                MS_END_LOOP,
+                                MS_WAIT(1000),
+                                MS_END_LOOP,
+                                MS_END};
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+MotionGenerator one_mg(one);
+MotionScript script(one, one_mg);
+byte received_script[MAX_SCRIPT_SIZE];
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.obstacleSensorsEmitters(true);      // Activate IR emitters
+  one.lcd1(" Motion Script  ");
+  one.lcd2("PB1 PB2 PB3");
+}
+
+void receiveScript() {
+  one.lcd2("Waiting script");
+  const int size =
+      MotionScript::receiveScript(Serial, received_script, MAX_SCRIPT_SIZE);
+  if (size > 0 && MotionScript::saveToEeprom(received_script, size)) {
+    one.lcd2("Saved bytes:", size);
+  } else {
+    one.lcd2("Receive failed");
+  }
+}
+
+void loop() {
+  if (!script.isDone()) {
+    script.step();
+    return;
+  }
+
+  switch (one.readButton()) {
+    case 1:
+      script.setScript(SQUARES, sizeof(SQUARES), true);
+      script.start();
+      one.lcd2("Running PROGMEM");
+      break;
+    case 2:
+      receiveScript();
+      break;
+    case 3:
+      if (script.setScriptFromEeprom() && script.start()) {
+        one.lcd2("Running EEPROM");
+      } else {
+        one.lcd2("No valid script");
+      }
+      break;
+  }
+}
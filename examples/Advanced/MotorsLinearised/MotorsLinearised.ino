@@ -0,0 +1,58 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * The robot moves with open-loop moveRAW() commands linearised by the PWM
+ * table that MotorsCalibrate stores in EEPROM. With the table the commands
+ * are speeds in % of the top speed: the dead band of the motors is skipped,
+ * so the robot moves even at 5 %, and both wheels turn at the same speed.
+ * Run MotorsCalibrate first.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/PwmTable.h"
+
+BnrOneAPlus one;  // object to control the Bot'n Roll ONE A+
+PwmTable pwm_table;
+
+// constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // safety voltage for discharging the battery
+
+void setup() {
+  Serial.begin(115200);   // set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // start SPI communication module
+  one.stop();             // stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // battery discharge protection
+
+  one.lcd1("Motors Linearise");
+  if (pwm_table.load()) {
+    one.setPwmTable(&pwm_table);
+    one.lcd2(" Press a button ");
+  } else {
+    one.lcd2("Run MotorsCalib.");
+  }
+  // Wait a button to be pushed <> Espera que pressione um botão
+  while (one.readButton() == 0);
+}
+
+void loop() {
+  // Slow and fast moves with the same open-loop commands
+  const int speeds[] = {5, 10, 50, -5, -50};
+  for (const int speed : speeds) {
+    one.lcd2("   Speed %:", speed);
+    one.moveRAW(speed, speed);
+    delay(1500);
+    one.stop();
+    delay(500);
+  }
+  one.lcd2("  Rotate slowly ");
+  one.moveRAW(5, -5);
+  delay(1500);
+  one.stop();
+  delay(1500);
+}
@@ -0,0 +1,58 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * The robot moves straight for one meter using the non-blocking mode of the
+ * MotionGenerator class. While the motion is in progress the obstacle sensors
+ * are read and the progress is shown on the LCD. The motion is aborted as
+ * soon as an obstacle is detected.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/MotionGenerator.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define DISTANCE_MM 1000        // Distance to travel
+#define SPEED_MMPS 200          // Speed of the motion
+
+// Slip factor depends on the surface
+// wood: 1.0
+// vinyl: 0.985
+// carpet: 0.985
+const float SLIP_FACTOR = 0.94;
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+MotionGenerator one_mg(one, SLIP_FACTOR);
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.obstacleSensorsEmitters(true);      // Activate IR emitters
+  one.lcd1("Non Blocking Mov");
+  one.lcd2("www.botnroll.com");
+  delay(3000);
+  one_mg.startStraight(DISTANCE_MM, SPEED_MMPS, DISTANCE_MM / 5);
+}
+
+void loop() {
+  if (one_mg.isDone()) return;
+
+  if (one.readObstacleSensors() != 0) {
+    one_mg.abort();
+    one.lcd1("Obstacle!");
+  } else {
+    one_mg.step();
+    one.lcd1("Progress %:", (int)(one_mg.progress() * 100));
+  }
+  if (one_mg.isDone()) {
+    one.lcd2("Done");
+  }
+}
@@ -0,0 +1,61 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * The robot follows a path given by a list of waypoints stored in PROGMEM,
+ * using the PathFollower class. The robot starts at the first waypoint facing
+ * the positive x axis. The speed is lowered automatically on the curves and
+ * the robot stops at the last waypoint.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/PathFollower.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+
+// Figure of eight made of two squares, in millimeters
+const Waypoint PATH[] PROGMEM = {{0, 0},
+                                 {400, 0},
+                                 {400, 400},
+                                 {0, 400},
+                                 {0, -400},
+                                 {-400, -400},
+                                 {-400, 0},
+                                 {0, 0}};
+const int NUM_WAYPOINTS = sizeof(PATH) / sizeof(PATH[0]);
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+PathFollower follower(one);
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1(" Path Following ");
+  one.lcd2("www.botnroll.com");
+  delay(3000);
+
+  follower.setPath(PATH, NUM_WAYPOINTS, true);
+  follower.setLookAheadMm(120);
+  follower.setSpeedLimits(300, 400);
+  follower.start();
+}
+
+void loop() {
+  static unsigned long last_display_ms = 0;
+  if (follower.isDone()) return;
+
+  follower.step();
+  // Refresh the LCD at a low rate to keep the control loop fast
+  if (millis() - last_display_ms > 250) {
+    last_display_ms = millis();
+    one.lcd2("Remaining:", (int)follower.getRemainingMm());
+  }
+}
@@ -0,0 +1,90 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * IMPORTANT!!!!
+ * Before you use this example you MUST calibrate the line sensor. Use example
+ * CalibrateLineSensor first!!!
+ *
+ * Description:
+ * Line following with a control loop run every 5 ms by a ControlTimer. Timer1
+ * flags the ticks at an exact period and loop() runs the control callback as
+ * soon as it sees the flag. Every two seconds the timing statistics are
+ * printed on the serial monitor: the delay from tick to run (latency), the
+ * largest error of the period between runs (jitter) and the ticks missed
+ * because loop() was busy.
+ * Place the robot on the line and press a push button to start.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/ControlTimer.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define CONTROL_PERIOD_US 5000  // Control loop period
+#define STATS_PERIOD_MS 2000    // Statistics print period
+#define SPEED 30                // Speed on a straight line
+#define LINEAR_GAIN 0.75        // Speed difference per line unit
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A+
+ControlTimer control_timer;
+unsigned long tstats;  // Statistics print time
+
+CONTROL_TIMER_ISR(control_timer)
+
+void control() {
+  const int line = one.readLine();
+  const int left_speed = constrain(SPEED + line * LINEAR_GAIN, -5, SPEED + 4);
+  const int right_speed = constrain(SPEED - line * LINEAR_GAIN, -5, SPEED + 4);
+  one.move(left_speed, right_speed);
+}
+
+void printStats() {
+  const ControlTimerStats& stats = control_timer.getStats();
+  Serial.print("Runs: ");
+  Serial.print(stats.runs);
+  Serial.print(" missed: ");
+  Serial.print(stats.missed_ticks);
+  Serial.print(" latency us mean: ");
+  Serial.print(control_timer.getMeanLatencyUs());
+  Serial.print(" max: ");
+  Serial.print(stats.max_latency_us);
+  Serial.print(" jitter us: ");
+  Serial.print(stats.max_jitter_us);
+  Serial.print(" run us: ");
+  Serial.println(stats.max_run_us);
+  control_timer.resetStats();
+}
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("Precise Control ");
+  one.lcd2("Press a Button!!");
+  // Wait a button to be pressed <> Espera que pressione um botão
+  while (one.readButton() == 0)
+    ;
+  // Wait for button release <> Espera que largue o botão
+  while (one.readButton() != 0)
+    ;
+  one.lcd2("Line following");
+
+  control_timer.begin(CONTROL_PERIOD_US, control);
+  tstats = millis() + STATS_PERIOD_MS;
+}
+
+void loop() {
+  control_timer.run();
+
+  // Other work must be short compared to the slack of the control period
+  if (millis() >= tstats) {
+    tstats += STATS_PERIOD_MS;
+    printStats();
+  }
+}
@@ -7,13 +7,18 @@
  * Description:
  * The robot moves by taking in speed values in rpm (rotations per minute)
  * It then reads both incremental encoders and stop the motors when the desired
- * value is reached. Incremental encoder counting will overflow when value is
- * higher than +32767 ou lower than -32768.
+ * value is reached. The 16 bit incremental counters are extended to 32 bits by
+ * an EncoderAccumulator, so the counts do not overflow and the encoders are
+ * never reset: each motion is measured from the counts at its start.
  */
 
 #include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
 #include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/EncoderAccumulator.h"
+
 BnrOneAPlus one;  // object to control the Bot'n Roll ONE A
+EncoderAccumulator encoders(one);
 
 // constants definition
 #define SSPIN 2                 // Slave Select (SS) pin for SPI communication
@@ -28,57 +33,43 @@ void setup() {
   one.lcd1(" Incremental Enc ");
   one.lcd2(" Press a button ");
   // Wait a button to be pushed <> Espera que pressione um botão
-  one.resetLeftEncoder();   // Reset encoder value to 0 <> Ler valor incremental
-                            // do encoder
-  one.resetRightEncoder();  /// Reset encoder value to 0
   while (one.readButton() == 0);
 }
 
-void printDebugInfo(const int left_encoder, const int right_encoder) {
+void printDebugInfo(const long left_encoder, const long right_encoder) {
   Serial.print("Left: ");
   Serial.print(left_encoder);
   Serial.print(" Right: ");
   Serial.println(right_encoder);
 }
 
-void resetEncoders() {
-  one.resetLeftEncoder();   // Reset encoder value to 0
-  one.resetRightEncoder();  // Reset encoder value to 0
-}
-
-void readAndPrintEncoders() {
-  int left_encoder =
-      one.readIncrementalLeftEncoder();  // Read incremental encoder
-  int right_encoder =
-      one.readIncrementalRightEncoder();  // Read incremental encoder
-  one.lcd1("Left: ", left_encoder);       // Print the encoder value
-  one.lcd2("Right: ", right_encoder);
+long readAndPrintEncoders() {
+  encoders.update();  // Read incremental encoders
+  const long left_encoder = encoders.getLeft();
+  const long right_encoder = encoders.getRight();
+  one.lcd1("Left: ", (int)left_encoder);  // Print the encoder value
+  one.lcd2("Right: ", (int)right_encoder);
   printDebugInfo(left_encoder, right_encoder);
+  return left_encoder;
 }
 
-void brakeResetAndPrintEncoders() {
+void brakeAndPrintEncoders() {
   one.brake();  // Brake motors
   delay(1500);
-  resetEncoders();
   readAndPrintEncoders();
   delay(1500);
 }
 
 void loop() {
-  int left_encoder = 0;
-  int right_encoder = 0;
-
+  encoders.reset();       // Count from the current position
   one.moveRpm(120, 120);  // Move motors in rpm
-
-  while (left_encoder < 1000) {
-    readAndPrintEncoders();
+  while (readAndPrintEncoders() < 1000) {
   }
-  brakeResetAndPrintEncoders();
+  brakeAndPrintEncoders();
 
+  encoders.reset();
   one.moveRpm(-60, -60);  // Move motors in rpm
-
-  while (left_encoder > -500) {
-    readAndPrintEncoders();
+  while (readAndPrintEncoders() > -500) {
   }
-  brakeResetAndPrintEncoders();
+  brakeAndPrintEncoders();
 }
@@ -0,0 +1,90 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * IMPORTANT!!!!
+ * Before you use this example you MUST calibrate the line sensor. Use example
+ * CalibrateLineSensor first!!!
+ *
+ * Description:
+ * Line following, obstacle detection, LCD refresh and telemetry run as tasks
+ * of a TaskScheduler instead of hand-rolled millis() checks and delays:
+ *  - control:   every 25 ms, highest priority,
+ *  - obstacles: every 50 ms, stops the robot while an obstacle is detected,
+ *  - telemetry: every second, prints the task statistics on the serial
+ *               monitor,
+ *  - lcd:       every 250 ms, lowest priority, shows the CPU load.
+ * The slow LCD and serial tasks run in the slack of the control task, which
+ * keeps its period.
+ * Place the robot on the line and press a push button to start.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/TaskScheduler.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define SPEED 30                // Speed on a straight line
+#define LINEAR_GAIN 0.75        // Speed difference per line unit
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A+
+TaskScheduler scheduler;
+int control_task;
+bool obstacle = false;
+
+void controlTask() {
+  if (obstacle) {
+    one.stop();
+    return;
+  }
+  const int line = one.readLine();
+  const int left_speed = constrain(SPEED + line * LINEAR_GAIN, -5, SPEED + 4);
+  const int right_speed = constrain(SPEED - line * LINEAR_GAIN, -5, SPEED + 4);
+  one.move(left_speed, right_speed);
+}
+
+void obstaclesTask() { obstacle = one.readObstacleSensors() > 0; }
+
+void lcdTask() { one.lcd2("Load %:", (int)scheduler.getLoad()); }
+
+void telemetryTask() {
+  const TaskStats& stats = scheduler.getStats(control_task);
+  Serial.print("Control runs: ");
+  Serial.print(stats.run_count);
+  Serial.print(" missed: ");
+  Serial.print(stats.missed_deadlines);
+  Serial.print(" mean us: ");
+  Serial.print(scheduler.getMeanRunUs(control_task));
+  Serial.print(" max us: ");
+  Serial.print(stats.max_run_us);
+  Serial.print(" max latency us: ");
+  Serial.println(stats.max_latency_us);
+}
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.obstacleSensorsEmitters(true);      // Activate IR emitters
+  one.lcd1("Scheduled Tasks ");
+  one.lcd2("Press a Button!!");
+  // Wait a button to be pressed <> Espera que pressione um botão
+  while (one.readButton() == 0)
+    ;
+  // Wait for button release <> Espera que largue o botão
+  while (one.readButton() != 0)
+    ;
+
+  control_task = scheduler.addTask(controlTask, 25, 3);
+  scheduler.addTask(obstaclesTask, 50, 2);
+  scheduler.addTask(telemetryTask, 1000, 1);
+  scheduler.addTask(lcdTask, 250, 0);
+  scheduler.start();
+}
+
+void loop() { scheduler.run(); }
@@ -0,0 +1,80 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * The robot launches hard towards a wall two meters away. A slip monitor
+ * compares the commanded and measured wheel speeds every control cycle: the
+ * speeds are backed off while the wheels spin, and the motion is aborted as
+ * soon as a wheel is blocked by the wall. The robot then backs away and
+ * turns instead of pushing the wall until the distance is travelled.
+ * Press push button 1 to start.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/MotionGenerator.h"
+#include "utils/SlipMonitor.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define DISTANCE_MM 2000        // Distance towards the wall
+#define SPEED_MMPS 700          // Speed of the motion
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+SlipMonitor slip_monitor;
+MotionGenerator one_mg(one);
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1(" Slip Detection ");
+  one.lcd2("Press PB1");
+
+  one_mg.setSlipMonitor(&slip_monitor);
+}
+
+void printState(const char* wheel, const SlipMonitor::WheelState state) {
+  Serial.print(wheel);
+  switch (state) {
+    case SlipMonitor::WheelState::OK:
+      Serial.println("ok");
+      break;
+    case SlipMonitor::WheelState::SLIPPING:
+      Serial.println("slipping");
+      break;
+    case SlipMonitor::WheelState::BLOCKED:
+      Serial.println("blocked");
+      break;
+    case SlipMonitor::WheelState::STALLED:
+      Serial.println("stalled");
+      break;
+  }
+}
+
+void loop() {
+  if (one.readButton() != 1) return;
+
+  delay(1000);  // Time to release the button
+  unsigned long start_ms = millis();
+  one_mg.startStraight(DISTANCE_MM, SPEED_MMPS);
+  while (one_mg.step()) {
+    if (slip_monitor.isSlipping()) one.lcd2("   Slipping!    ");
+  }
+  Serial.print("Time (ms): ");
+  Serial.println(millis() - start_ms);
+  printState("Left wheel: ", slip_monitor.getLeftState());
+  printState("Right wheel: ", slip_monitor.getRightState());
+
+  if (slip_monitor.isBlocked()) {
+    one.lcd2("  Wall ahead!   ");
+    one_mg.moveStraightAtSpeed(100, -300);
+    one_mg.rotateAngleDegAtSpeed(90, 200);
+  }
+  one.lcd2("Press PB1");
+}
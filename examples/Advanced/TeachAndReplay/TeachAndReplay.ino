@@ -0,0 +1,74 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * Records a path and replays it faster.
+ * Push button 1 starts recording: push the robot by hand along the path and
+ * press push button 2 at the end. The recording is saved in EEPROM.
+ * Push button 3 replays the saved path at twice the recorded speed, slowing
+ * down on the curves.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/TrajectoryReplayer.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define BUFFER_SIZE 400         // 200 samples of 50 ms, i.e. 10 seconds
+#define SPEED_MULTIPLIER 2.0    // Replay speed relative to the recording
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+MotionGenerator one_mg(one);
+byte buffer[BUFFER_SIZE];
+TrajectoryRecorder recorder(one, buffer, BUFFER_SIZE);
+TrajectoryReplayer replayer(recorder, one_mg);
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1(" Teach & Replay ");
+  one.lcd2("PB1:rec PB3:play");
+  replayer.setSpeedLimits(SPEED_MULTIPLIER);
+}
+
+void record() {
+  one.lcd2("Recording...");
+  recorder.start();
+  while (recorder.step() && one.readButton() != 2) {
+  }
+  recorder.stop();
+  if (recorder.save()) {
+    one.lcd2("Samples saved:", recorder.getNumSamples());
+  } else {
+    one.lcd2("Save failed");
+  }
+}
+
+void replay() {
+  if (!recorder.load()) {
+    one.lcd2("No recording");
+    return;
+  }
+  one.lcd2("Replaying...");
+  replayer.replay();
+  one.lcd2("PB1:rec PB3:play");
+}
+
+void loop() {
+  switch (one.readButton()) {
+    case 1:
+      record();
+      break;
+    case 3:
+      delay(1000);  // Time to release the button
+      replay();
+      break;
+  }
+}
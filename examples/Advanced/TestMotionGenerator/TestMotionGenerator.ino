@@ -23,6 +23,7 @@
 #include <BnrOneAPlus.h>
 
 #include "utils/ControlUtils.h"
+#include "utils/EncoderAccumulator.h"
 #include "utils/RobotParams.h"
 
 #define STRAIGHT_MOTION 32767
@@ -42,8 +43,6 @@ class MotionGeneratorTest {
         axis_length_mm_(robot_params.axis_length_mm),
         cut_(ControlUtils(robot_params)) {}
 
-  void resetEncoders() const { one_.resetEncoders(); }
-
   PoseSpeeds computePoseSpeeds(const float speed,
                                const float radius_of_curvature_mm,
                                const int direction) const {
@@ -87,12 +86,15 @@ class MotionGeneratorTest {
     const auto pose_speeds =
         computePoseSpeeds(speed, radius_of_curvature_mm, direction);
 
+    // Pulses are counted from the start of the motion, without resetting
+    // the encoders
+    EncoderAccumulator encoders(one_);
+    encoders.reset();
     long int encoder_count = 0;
     one_.moveRpm(200, 200);
     while (encoder_count < total_pulses) {
-      int left_encoder = one_.readAndResetLeftEncoder();
-      int right_encoder = one_.readAndResetRightEncoder();
-      encoder_count += (long int)((abs(left_encoder) + abs(right_encoder)) / 2);
+      encoders.update();
+      encoder_count = (abs(encoders.getLeft()) + abs(encoders.getRight())) / 2;
       long int pulses_remaining = round(total_pulses - encoder_count);
       Serial.println(pulses_remaining);
       if (pulses_remaining < 0) break;
@@ -133,7 +135,6 @@ class MotionGeneratorTest {
     Serial.println(slow_down_pulses);
     delay(2000);
 
-    resetEncoders();
     moveAndSlowDown(total_pulses, speed, 1, STRAIGHT_MOTION, slow_down_pulses);
   }
 
@@ -147,7 +148,6 @@ class MotionGeneratorTest {
     auto slow_down_pulses_thresh = cut_.computePulsesFromAngleAndCurvature(
         radians(slow_down_thresh_deg), radius_of_curvature_mm);
     slow_down_pulses_thresh = applySlip(slow_down_pulses_thresh);
-    resetEncoders();
     moveAndSlowDown(total_pulses,
                     abs(speed),
                     getSign(angle_deg),
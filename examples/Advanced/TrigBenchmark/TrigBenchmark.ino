@@ -0,0 +1,109 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * Compares the table based trigonometry in utils/FastTrig.h against the
+ * libm functions sin(), cos() and atan2().
+ * For each function it prints the average execution time per call (in
+ * microseconds and CPU cycles) and the maximum absolute error found over a
+ * sweep of angles.
+ * Open the serial monitor at 115200 baud to see the results.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/FastTrig.h"
+
+#define NUM_SAMPLES 500
+#define CYCLES_PER_MICROSECOND (F_CPU / 1000000L)
+
+volatile float g_sink = 0;  // Prevents the compiler from removing the calls
+
+float sampleAngle(const int i) {
+  return -TWO_PI + (2.0 * TWO_PI * i) / NUM_SAMPLES;
+}
+
+void printResult(const char name[],
+                 const unsigned long elapsed_us,
+                 const float max_error) {
+  const float us_per_call = (float)elapsed_us / NUM_SAMPLES;
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(us_per_call);
+  Serial.print(" us/call, ");
+  Serial.print(us_per_call * CYCLES_PER_MICROSECOND);
+  Serial.print(" cycles/call");
+  if (max_error >= 0) {
+    Serial.print(", max error: ");
+    Serial.print(max_error, 6);
+  }
+  Serial.println();
+}
+
+unsigned long timeSin(float (*function)(float)) {
+  const unsigned long start = micros();
+  for (int i = 0; i < NUM_SAMPLES; ++i) {
+    g_sink = function(sampleAngle(i));
+  }
+  return micros() - start;
+}
+
+unsigned long timeAtan2(float (*function)(float, float)) {
+  const unsigned long start = micros();
+  for (int i = 0; i < NUM_SAMPLES; ++i) {
+    g_sink = function(i - NUM_SAMPLES / 2, NUM_SAMPLES / 3 - i);
+  }
+  return micros() - start;
+}
+
+float libSin(float angle) { return sin(angle); }
+float libCos(float angle) { return cos(angle); }
+float libAtan2(float y, float x) { return atan2(y, x); }
+float lutSin(float angle) { return fastSin(angle); }
+float lutCos(float angle) { return fastCos(angle); }
+float lutAtan2(float y, float x) { return fastAtan2(y, x); }
+
+float maxSinError() {
+  float max_error = 0;
+  for (int i = 0; i < NUM_SAMPLES; ++i) {
+    const float angle = sampleAngle(i);
+    max_error = max(max_error, fabs(fastSin(angle) - sin(angle)));
+    max_error = max(max_error, fabs(fastCos(angle) - cos(angle)));
+  }
+  return max_error;
+}
+
+float maxAtan2Error() {
+  float max_error = 0;
+  for (int i = 0; i < NUM_SAMPLES; ++i) {
+    const float angle = sampleAngle(i);
+    const float y = 100.0 * sin(angle);
+    const float x = 100.0 * cos(angle);
+    float error = fabs(fastAtan2(y, x) - atan2(y, x));
+    if (error > PI) {
+      error = TWO_PI - error;  // Both ends of the range are the same angle
+    }
+    max_error = max(max_error, error);
+  }
+  return max_error;
+}
+
+void setup() {
+  Serial.begin(115200);  // Set baud rate to 115200bps for printing values at
+                         // serial monitor.
+  Serial.println("Trigonometry benchmark");
+  const unsigned long overhead_us = timeSin([](float angle) { return angle; });
+
+  printResult("sin (libm)    ", timeSin(libSin) - overhead_us, -1);
+  printResult("fastSin       ", timeSin(lutSin) - overhead_us, maxSinError());
+  printResult("cos (libm)    ", timeSin(libCos) - overhead_us, -1);
+  printResult("fastCos       ", timeSin(lutCos) - overhead_us, maxSinError());
+  printResult("atan2 (libm)  ", timeAtan2(libAtan2), -1);
+  printResult("fastAtan2     ", timeAtan2(lutAtan2), maxAtan2Error());
+}
+
+void loop() {
+  // Empty loop
+}
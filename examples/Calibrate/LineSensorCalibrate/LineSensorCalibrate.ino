@@ -94,6 +94,8 @@
 #include <BnrOneAPlus.h>  // Bot'n Roll ONE A library
 #include <SPI.h>          // SPI communication library required by BnrOne.cpp
 
+#include "utils/ControlTimer.h"
+
 // constants definitions
 #define SSPIN 2  // Slave Select (SS) pin for SPI communication
 #define M1 1     // Motor1
@@ -101,38 +103,12 @@
 #define VMAX 1000
 #define MINIMUM_BATTERY_V 10.5  // safety voltage for discharging the battery
 
-using uint = unsigned int;
-
 BnrOneAPlus one;            //  object to control the Bot'n Roll ONE A
 Config config;              // variable used to load and save config values
 LineDetector lineDetector;  // variable used to detect line
+ControlTimer timer;         // counts seconds with Timer1
 
-class Time {
- public:
-  void start() {
-    // Set Timer1 in CTC mode with prescaler of 256
-    TCCR1A = 0;  // No need to set anything for Timer1 in CTC mode
-    TCCR1B = (1 << WGM12) |
-             (1 << CS12);  // WGM12 for CTC mode, CS12 for 256 prescaler
-    // Set compare value for 1-second interval
-    OCR1A = 62500;  // (16e6 / (256 * 1)) - 1 = 62500
-    // Enable Timer1 interrupt
-    TIMSK1 |= (1 << OCIE1A);
-    // Enable global interrupts
-    sei();
-  }
-
-  void update() { time_ += 1; }
-
-  uint now() { return time_; }
-
- private:
-  volatile uint time_ = 0;
-};
-
-Time time;
-
-ISR(TIMER1_COMPA_vect) { time.update(); }
+CONTROL_TIMER_ISR(timer)
 
 /**
  * @brief Prints array of integers in the terminal
@@ -236,8 +212,8 @@ void saveConfig() {
 void CalibrateMinMax(int sensor_value_min[8], int sensor_value_max[8]) {
   printMsg("Computing min and max for sensor readings...");
   one.move(15, -15);
-  const auto start_time = time.now();
-  while (time.now() < (start_time + 6)) {
+  const auto start_time = timer.getTicks();
+  while (timer.getTicks() < (start_time + 6)) {
     const auto reading = one.readLineSensor();
     printArray("Readings: ", reading);
     for (int i = 0; i < 8; ++i) {
@@ -524,7 +500,7 @@ void setup() {
   one.spiConnect(SSPIN);                  // starts the SPI communication module
   one.stop();                             // stop motors
   one.setMinBatteryV(MINIMUM_BATTERY_V);  // battery discharge protection
-  time.start();
+  timer.begin(1000000);  // tick every second
   config.Load();
   config.Print();
   delay(1000);
@@ -3,142 +3,107 @@
  *
  * This example aquires motor and encoder information to be sent to PIC18F45K22
  * for PID control of the movement. The robot wheels must rotate freely and
- * should not touch the floor. Motors must have encoders. This process is done
- * in 3 steps: Step 1: PWM will increase from 0 until movement is detected from
- * the encoders. Setp 2: with motors at maximum power, encoders counting will be
- * aqquired every 25ms. Step 3: send data to PIC to be stored in EEPROM.
+ * should not touch the floor. Motors must have encoders. The
+ * MotorIdentification class applies a slow ramp, a staircase and a chirp of
+ * PWM while sampling the encoders every 5ms, and fits a model of each motor
+ * (dead band, gain and time constant) in about 6 seconds. The moving power and
+ * the control pulses at maximum speed are sent to the PIC to be stored in
+ * EEPROM, and the linearising PWM table is stored in the Arduino EEPROM.
+ * Both wheels are then driven at the same speed through the new table while
+ * a VelocityEstimator measures them, so their speeds can be compared.
  */
 
 #include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
 #include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
 
+#include "utils/MotorIdentification.h"
+#include "utils/VelocityEstimator.h"
+
 BnrOneAPlus one;  // object to control the Bot'n Roll ONE A+
 
 // constants definition
 #define SSPIN 2  // Slave Select (SS) pin for SPI communication
 #define MINIMUM_BATTERY_V 10.5  // safety voltage for discharging the battery
+#define CHECK_SPEED 50          // % of the top speed used to check the table
+#define CHECK_TIME_MS 1500      // time driven at the check speed
+#define SAMPLE_PERIOD_MS 5      // encoder sampling period
 
-int g_motor_power = 40;
-int g_left_enc_max = 0;
-int g_right_enc_max = 0;
-bool g_error_flag = false;
-
-void printDebugEncoderMax() {
-  Serial.print("  g_left_enc_max:");
-  Serial.print(g_left_enc_max);
-  Serial.print("  g_right_enc_max:");
-  Serial.print(g_right_enc_max);
-}
-
-void printDebugEncodersMaxPowerAndError() {
-  Serial.print("  g_motor_power:");
-  Serial.print(g_motor_power);
-  printDebugEncoderMax();
-  Serial.print("  g_error_flag:");
-  Serial.print(g_error_flag);
-  Serial.println();
-}
-
-void printDebugInfo(const int left_enc, const int right_enc) {
-  Serial.print("  left_enc:");
-  Serial.print(left_enc);
-  Serial.print("  right_enc:");
-  Serial.print(right_enc);
-  Serial.println();
+void printModel(const char name[], const MotorModel& model) {
+  Serial.print(name);
+  Serial.print("  dead_band:");
+  Serial.print(model.dead_band);
+  Serial.print("  gain_pps:");
+  Serial.print(model.gain_pps);
+  Serial.print("  time_constant_ms:");
+  Serial.println(model.time_constant_ms);
 }
 
-void startMoveDetection() {
-  bool exit_flag = false;
-  int left_enc = one.readAndResetLeftEncoder();    // Clear encoder count
-  int right_enc = one.readAndResetRightEncoder();  // Clear encoder count
-  unsigned long t1sec = millis() + 1000;
-  while (!exit_flag) {
-    if (millis() >= t1sec) {
-      t1sec += 500;  // Every second
-      one.moveRAW(g_motor_power, g_motor_power);
-      left_enc = one.readAndResetLeftEncoder();
-      right_enc = one.readAndResetRightEncoder();
-      one.lcd2(g_motor_power, left_enc, right_enc);
-      printDebugEncodersMaxPowerAndError();
-      if (abs(left_enc) < 100 || abs(right_enc) < 100)
-        g_motor_power++;  // if motors are not moving
-      else {
-        if (left_enc < 0) {  // if encoderL is Not ok
-          one.stop();
-          one.lcd1("Motor 1 -> ERROR");
-          Serial.println("ERROR: Motor 1 encoder is counting in reverse!!");
-          g_error_flag = true;
-        } else if (right_enc < 0) {  // if encoderR is Not ok
-          one.stop();
-          one.lcd2("Motor 2 -> ERROR");
-          Serial.println("ERROR: Motor 2 encoder is counting in reverse!!");
-          g_error_flag = true;
-        }
-        exit_flag = true;
-      }
-    }
+void printPwmTable(const PwmTable& table) {
+  Serial.println("  speed  left_pwm  right_pwm");
+  for (int speed = 0; speed <= 100; speed += 10) {
+    Serial.print("  ");
+    Serial.print(speed);
+    Serial.print("  ");
+    Serial.print(table.computeLeftDutyCycle(speed));
+    Serial.print("  ");
+    Serial.println(table.computeRightDutyCycle(speed));
   }
 }
 
-void maxPulsesDetection() {
-  unsigned long t_cycle;
-  unsigned long end_time;
-  if (!g_error_flag) {
-    one.lcd2(100, 0, 0);
-    one.moveRAW(100, 100);
-    delay(1000);
-    t_cycle = millis();
-    end_time = millis() + 2500;
-    int left_enc = one.readAndResetLeftEncoder();    // Clear encoder count
-    int right_enc = one.readAndResetRightEncoder();  // Clear encoder count
-    while (millis() < end_time) {
-      if (millis() >= t_cycle) {
-        t_cycle += 25;
-        left_enc = one.readAndResetLeftEncoder();
-        if (left_enc > g_left_enc_max) g_left_enc_max = left_enc;
-        right_enc = one.readAndResetRightEncoder();
-        if (right_enc > g_right_enc_max) g_right_enc_max = right_enc;
-        printDebugInfo(left_enc, right_enc);
-      }
-    }
-    one.stop();
-    g_left_enc_max = (int)((float)g_left_enc_max);
-    g_right_enc_max = (int)((float)g_right_enc_max);
-    one.lcd2(0, g_left_enc_max, g_right_enc_max);
-    printDebugEncoderMax();
-    delay(2000);
+// Drives both wheels at the same speed through the table and prints their
+// measured speeds, which should match
+void checkPwmTable(const PwmTable& table) {
+  VelocityEstimator estimator(RobotParams(),
+                              MAX_VELOCITY_WINDOW,
+                              VelocityEstimator::Method::LEAST_SQUARES);
+  one.setPwmTable(&table);
+  estimator.readAndUpdate(one);  // Clear encoder count
+  one.moveRAW(CHECK_SPEED, CHECK_SPEED);
+  const unsigned long start_ms = millis();
+  unsigned long tcycle = start_ms;
+  while (millis() - start_ms < CHECK_TIME_MS) {
+    if (millis() < tcycle) continue;
+    tcycle += SAMPLE_PERIOD_MS;
+    estimator.readAndUpdate(one);
   }
+  one.stop();
+  one.setPwmTable(nullptr);
+  Serial.print("  Speeds at ");
+  Serial.print(CHECK_SPEED);
+  Serial.print("%  left_pps:");
+  Serial.print(estimator.getLeftPulsesPerSec());
+  Serial.print("  right_pps:");
+  Serial.println(estimator.getRightPulsesPerSec());
 }
 
-void sendValues() {
-  int enc_min = 30000;  // Find minimum encoder value
-  if (!g_error_flag) {
-    if (g_left_enc_max < enc_min) enc_min = g_left_enc_max;
-    if (g_right_enc_max < enc_min) enc_min = g_right_enc_max;
-    one.setMotors(g_motor_power, enc_min);
-    Serial.println();
-    Serial.println(
-        "  Save values for void setMotors(int Smotor_power, int "
-        "ctrlPulses);");
-    Serial.print("  Smotor_power:");
-    Serial.println(g_motor_power);
-    Serial.print("  ctrlPulses:");
-    Serial.println(enc_min);
-    Serial.println("  Calibrate Finished!!");
-    while (1) {
-      one.lcd1("Smotor_power: ", g_motor_power);
-      one.lcd2("ctrlPulses: ", enc_min);
-      delay(2500);
-      one.lcd1("Save values for ");
-      one.lcd2("  setMotors();  ");
-      delay(2500);
-      one.lcd1("  Calibration   ");
-      one.lcd2("   finished!    ");
-      delay(2500);
-    }
+void sendValues(const MotorIdentification& identification) {
+  const int motor_power = identification.getMovingPower();
+  const int ctrl_pulses = identification.getMaxSpeedPulses();
+  one.setMotors(motor_power, ctrl_pulses);
+  identification.getPwmTable().save();
+  Serial.println();
+  printModel("Left motor: ", identification.getLeftModel());
+  printModel("Right motor:", identification.getRightModel());
+  printPwmTable(identification.getPwmTable());
+  Serial.println(
+      "  Save values for void setMotors(int Smotor_power, int "
+      "ctrlPulses);");
+  Serial.print("  Smotor_power:");
+  Serial.println(motor_power);
+  Serial.print("  ctrlPulses:");
+  Serial.println(ctrl_pulses);
+  Serial.println("  Calibrate Finished!!");
+  while (1) {
+    one.lcd1("Smotor_power: ", motor_power);
+    one.lcd2("ctrlPulses: ", ctrl_pulses);
+    delay(2500);
+    one.lcd1("Save values for ");
+    one.lcd2("  setMotors();  ");
+    delay(2500);
+    one.lcd1("  Calibration   ");
+    one.lcd2("   finished!    ");
+    delay(2500);
   }
-  while (1)
-    ;
 }
 
 void setup() {
@@ -162,14 +127,24 @@ void setup() {
   one.lcd2("   to start!    ");
   while (one.readButton() == 0)
     ;
-  one.lcd1("Power EncL EncR ");
 }
 
 void loop() {
-  // 1-Detect Start Moving Power
-  startMoveDetection();
-  // 2-Detect control pulses at max speed every 25ms
-  maxPulsesDetection();
+  // 1-Identify the motors with the wheels turning freely
+  MotorIdentification identification(one);
+  one.lcd1("  Identifying   ");
+  one.lcd2("    motors...   ");
+  if (!identification.identify()) {
+    one.lcd1("Motors -> ERROR ");
+    one.lcd2("Check encoders! ");
+    Serial.println("ERROR: a wheel did not move or counts in reverse!!");
+    while (1)
+      ;
+  }
+  // 2-Check that the table drives both wheels at the same speed
+  one.lcd1(" Checking table ");
+  one.lcd2("                ");
+  checkPwmTable(identification.getPwmTable());
   // 3-Send values to PIC18F45K22
-  sendValues();
-}
\ No newline at end of file
+  sendValues(identification);
+}
@@ -0,0 +1,113 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * Description:
+ * Calibration of the wheel diameters and track width (UMBmark procedure).
+ * The robot drives a square clockwise and then counterclockwise, NUM_RUNS
+ * times each. Mark the start position and heading of the robot on the floor
+ * and place it there before every run.
+ * After each run measure how far the robot stopped from the start mark along
+ * the initial heading: positive if it stopped ahead of the mark, negative if
+ * it stopped behind it. Enter the value in mm with the push buttons
+ * (PB1 +, PB2 -, PB3 ok).
+ * The corrected wheel diameters and track width are computed from the mean
+ * errors, displayed and saved in EEPROM.
+ * Use OdometryCalibration::load() to get the calibrated RobotParams in your
+ * own sketches:
+ *   OdometryCalibration calibration(one);
+ *   ShapeGenerator one_draw(one, SLIP_FACTOR, calibration.load());
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/OdometryCalibration.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define SIDE_MM 1000            // Side of the test square
+#define SPEED_MMPS 150          // Speed of the test runs
+#define NUM_RUNS 3              // Number of runs in each direction
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A
+OdometryCalibration calibration(one);
+
+void waitButtonPushAndRelease() {
+  while (one.readButton() == 0)
+    ;
+  while (one.readButton() != 0)
+    ;
+}
+
+int getUserInput(const char text[], const int value) {
+  int temp_var = value;
+  while (one.readButton() != 3) {
+    one.lcd2(text, temp_var);
+    delay(125);
+
+    if (one.readButton() == 1) {
+      ++temp_var;
+    }
+    if (one.readButton() == 2) {
+      --temp_var;
+    }
+  }
+  // Wait PB3 to be released
+  while (one.readButton() == 3)
+    ;
+
+  return temp_var;
+}
+
+float runSquares(const bool clockwise) {
+  float sum_errors = 0;
+  for (int i = 0; i < NUM_RUNS; ++i) {
+    one.lcd1(clockwise ? "Clockwise run" : "Counterclockwise");
+    one.lcd2(" Press a button ");
+    waitButtonPushAndRelease();
+    delay(1000);
+    calibration.driveSquare(SIDE_MM, clockwise, SPEED_MMPS);
+    one.lcd1("Error ahead mm:");
+    sum_errors += getUserInput("x error:", 0);
+  }
+  return sum_errors / NUM_RUNS;
+}
+
+void printParams(const RobotParams& params) {
+  Serial.print("Left wheel diameter (mm): ");
+  Serial.println(params.left_wheel_diameter_mm);
+  Serial.print("Right wheel diameter (mm): ");
+  Serial.println(params.right_wheel_diameter_mm);
+  Serial.print("Track width (mm): ");
+  Serial.println(params.track_width_mm);
+}
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("Odometry Calib.");
+  one.lcd2(" Press a button ");
+  waitButtonPushAndRelease();
+
+  const float x_error_cw_mm = runSquares(true);
+  const float x_error_ccw_mm = runSquares(false);
+
+  const RobotParams params = calibration.computeCorrectedParams(
+      SIDE_MM, x_error_cw_mm, x_error_ccw_mm);
+  calibration.save(params);
+  printParams(params);
+
+  // Values displayed in hundredths of mm
+  one.lcd1((int)(params.left_wheel_diameter_mm * 100),
+           (int)(params.right_wheel_diameter_mm * 100));
+  one.lcd2("Track:", (int)(params.track_width_mm * 100));
+}
+
+void loop() {
+  // Empty loop
+}
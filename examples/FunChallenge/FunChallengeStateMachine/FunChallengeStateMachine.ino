@@ -9,12 +9,17 @@
  *
  * Description:
  * This program detects automatic start and does the automatic end on the
- * RoboParty Fun Challenge.
+ * RoboParty Fun Challenge. A command shaper ramps the speeds when the robot
+ * reverses, so that the wheels do not spin.
  */
 
 #include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
 #include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/CommandShaper.h"
+
 BnrOneAPlus one;  // object to control the Bot'n Roll ONE A+
+CommandShaper shaper(400, 4000);  // max acceleration %/s and jerk %/s^2
 
 // constants definition
 #define SSPIN 2  // Slave Select (SS) pin for SPI communication
@@ -32,6 +37,7 @@ void setup() {
   one.spiConnect(SSPIN);                  // start SPI communication module
   one.setMinBatteryV(MINIMUM_BATTERY_V);  // battery discharge protection
   one.stop();                             // stop motors
+  one.setCommandShaper(&shaper);          // limit acceleration and jerk
   one.lcd1(" FUN CHALLENGE  ");           // print on LCD line 1
   one.lcd2(" Press a button ");           // print on LCD line 2
   while (one.readButton() == 0)
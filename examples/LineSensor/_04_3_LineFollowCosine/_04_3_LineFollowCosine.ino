@@ -35,6 +35,8 @@
 #include <EEPROM.h>       // EEPROM reading and writing
 #include <SPI.h>          // SPI communication library required by BnrOne.cpp
 
+#include "utils/FastTrig.h"  // Table based cosine <> Coseno por tabela
+
 BnrOneAPlus one;  // object to control the Bot'n Roll ONE A
 
 // constants definitions
@@ -99,7 +101,7 @@ void lineFollowCosine() {
   if (line <= 0) {
     // Inside wheel decreases speed according to cosine function
     // Roda interior diminui a velocidade de acordo com a função coseno
-    g_left_speed = (int)(cos(angle_radians) * g_speed);
+    g_left_speed = (int)(fastCos(angle_radians) * g_speed);
 
     // Outside wheel maintains or increases speed according to
     // g_wheel_boost_factor Roda exterior mantém ou aumenta a velocidade de
@@ -123,7 +125,7 @@ void lineFollowCosine() {
   // If line is on the right side of the sensor <> Se a linha está do lado
   // direito do sensor
   else if (line > 0) {
-    g_right_speed = (int)(cos(angle_radians) * g_speed);
+    g_right_speed = (int)(fastCos(angle_radians) * g_speed);
     g_left_speed = g_speed + (int)(((float)(g_speed - g_right_speed)) /
                                    g_wheel_boost_factor);
     if (g_left_speed > g_speed + g_wheel_boost) {
@@ -15,6 +15,8 @@
  * Adjustable gains g_kp, g_ki and g_kd.
  * You can adjust the speed limit of the wheel that is outside the curve.
  * Press push button 3 (PB3) to enter control configuration menu.
+ * Gains tuned by example _04_5_LineFollowPIDAutoTune are loaded at start.
+ * The control cycle runs every 10 ms, the period of the tuning.
  *
  * <>
  *
@@ -27,20 +29,26 @@
  * Os motores variam com a linha com controlo PID
  * Ajuste dos ganhos g_kp, g_ki, e g_kd.
  * Ajuste do limite de velocidade da roda que está no exterior da curva.
+ * Os ganhos obtidos com o exemplo _04_5_LineFollowPIDAutoTune são lidos no
+ * arranque. O ciclo de controlo corre a cada 10 ms, o período da afinação.
  *
  */
 
 #include <BnrOneAPlus.h>  // Bot'n Roll ONE A library
 #include <EEPROM.h>       // EEPROM reading and writing
 #include <SPI.h>          // SPI communication library required by BnrOne.cpp
-BnrOneAPlus one;          // object to control the Bot'n Roll ONE A
+
+#include "utils/PidController.h"
+
+BnrOneAPlus one;  // object to control the Bot'n Roll ONE A
 
 // constants definitions
 #define SSPIN 2  // Slave Select (SS) pin for SPI communication
 #define M1 1  // Motor1
 #define M2 2  // Motor2
 #define MINIMUM_BATTERY_V 10.5  // safety voltage for discharging the battery
-#define LIMITS 100.0  // line value limit
+#define LIMITS 100  // line value limit
+#define CONTROL_PERIOD_MS 10  // control cycle time, as in the PID auto-tuning
 
 // PID control gains <> Ganhos do controlo PID
 float g_kp = 1.3;
@@ -49,6 +57,8 @@ float g_kd = 0.35;
 int g_speed = 30;       // Max Speed <> Velocidade Máxima dos motores
 int g_extra_speed = 4;  // Curve outside wheel max speed limit <> Limite de
                         // velocidade da roda exterior na curva
+PidController pid;      // Line PID controller <> Controlador PID da linha
+unsigned long tcycle;   // Control cycle time in loop <> Tempo do ciclo
 
 void menu() {
   int temp_var = 0;
@@ -146,7 +156,8 @@ void menu() {
   while (button != 0) {
     button = one.readButton();
   }
-  g_ki = (double)temp_var / 1000.0;
+  // Limited to the range of the controller <> Limitado à gama do controlador
+  g_ki = constrain((double)temp_var / 1000.0, 0.0, PID_MAX_INTEGRAL_GAIN);
 
   //**** Differential gain g_kd <> Ganho diferencial g_kd ****
   temp = g_kd * 1000;
@@ -172,9 +183,12 @@ void menu() {
   //**** Configuration end <> Termina Configuração *****
   writeMenuEEPROM();  // Write control values to EEPROM <> Escrever valores de
                       // controlo na EEPROM
+  pid.setGains(g_kp, g_ki, g_kd);
+  pid.reset();
   one.lcd1("Line  Following!");
   one.lcd2("www.botnroll.com");
   delay(250);
+  tcycle = millis();
 }
 
 byte writeByteToEEPROM(const byte eeprom_address, const int temp_var) {
@@ -254,7 +268,7 @@ void readMenuEEPROM() {
   if (!isWithinLimits<byte>(g_speed, 0, 100)) g_speed = 50;
   if (!isWithinLimits<byte>(g_extra_speed, 0, 100)) g_extra_speed = 3;
   if (!isWithinLimits<float>(g_kp, 0.0, 10.0)) g_kp = 1.3;
-  if (!isWithinLimits<float>(g_ki, 0.0, 20.0)) g_ki = 0.2;
+  if (!isWithinLimits<float>(g_ki, 0.0, PID_MAX_INTEGRAL_GAIN)) g_ki = 0.2;
   if (!isWithinLimits<float>(g_kd, 0.0, 10.0)) g_kd = 0.3;
 }
 
@@ -276,56 +290,49 @@ void setup() {
   // Wait for button release <> Espera que largue o botão
   while (one.readButton() != 0)
     ;
+  pid.setGains(g_kp, g_ki, g_kd);
+  pid.setOutputLimits(-LIMITS, LIMITS);
+  tcycle = millis();  // Set start value for tcycle
 }
 
 void loop() {
-  int line = 0;      // The line sensor value <> Valor da linha no sensor
-  int line_ref = 0;  // Reference line value <> Valor de referência da linha
-  int p_error = 0;   // Proportional error <> Erro proporcional
-  static double i_error = 0.0;  // Integral error <> Erro Integral
-  static int d_error = 0.0;     // Differential error <> Erro diferencial
+  // The integral and derivative gains are per control cycle, so the cycle
+  // has a fixed period <> Os ganhos integral e diferencial são por ciclo de
+  // controlo, por isso o ciclo tem um período fixo
+  if (millis() < tcycle) return;
+  tcycle += CONTROL_PERIOD_MS;
 
-  // Previous proportional eror <> Erro proporcional anterior
-  static int previous_p_error = 0;
-  double output = 0.0;  // PID control output <> Resultado do controlo PID
+  const int line_ref = 0;  // Reference line value <> Valor de referência da
+                           // linha
 
   // Motor speeds <> Velocidade dos motores
   int m1_speed = 0;
   int m2_speed = 0;
 
-  line = one.readLine();  // Read the line sensor value -100 to +100 <> Leitura
-                          // do valor da linha -100 a +100
+  // Previous proportional error <> Erro proporcional anterior
+  static int previous_p_error = 0;
 
-  p_error = line_ref - line;  // Proportional error <> Erro proporcional
+  const int line = one.readLine();  // Read the line sensor value -100 to +100
+                                    // <> Leitura do valor da linha -100 a +100
 
-  // Increment integral error if output is below limits <>
-  // Incrementa erro integral se a saída está dentro dos limites
-  if (output > LIMITS) {
-    output = LIMITS;  // Limit the output value <> Limitar o valor de saída
-  } else if (output < (-LIMITS)) {
-    output = (-LIMITS);
-  } else {
-    // Incrementa erro integral
-    i_error += (double)p_error;
-  }
   // Clean integral error if line value is zero or if line signal has changed
   // Limpar o erro integral se o valor da linha é zero ou se o sinal da linha
   // mudou
+  const int p_error = line_ref - line;
   if ((p_error * previous_p_error) <= 0) {
-    i_error = 0.0;
+    pid.resetIntegral();
   }
-
-  // Differential error <> Erro diferencial
-  d_error = p_error - previous_p_error;
   previous_p_error = p_error;
 
-  output =
-      (g_kp * (double)p_error) + (g_ki * i_error) + (g_kd * (double)d_error);
+  // PID control output, with the integral limited while the output is
+  // saturated <> Resultado do controlo PID, com o integral limitado enquanto
+  // a saída está saturada
+  const int output = pid.compute(line_ref, line);
 
   // Limit motors maximum and minimum speed <> Limitar mínimos e máximos da
   // velocidade dos motores
-  m1_speed = g_speed - (int)output;
-  m2_speed = g_speed + (int)output;
+  m1_speed = g_speed - output;
+  m2_speed = g_speed + output;
   if (m1_speed < -5) {
     m1_speed = -5;
   }
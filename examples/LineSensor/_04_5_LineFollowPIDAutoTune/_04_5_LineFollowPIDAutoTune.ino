@@ -0,0 +1,103 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * IMPORTANT!!!!
+ * Before you use this example you MUST calibrate the line sensor. Use example
+ * CalibrateLineSensor first!!! Line reading provides a linear value between
+ * -100 to 100
+ *
+ * Line follow with PID auto-tuning:
+ * Place the robot on a long straight line and press push button 1 (PB1). The
+ * robot follows the line with bang-bang steering for a few seconds, which
+ * makes it oscillate around the line. The PID gains are computed from the
+ * oscillation with the Ziegler-Nichols rule and stored in EEPROM, where
+ * _04_4_LineFollowPID also loads them from.
+ * Press push button 2 (PB2) to follow the line with the stored gains.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/PidAutoTuner.h"
+#include "utils/PidController.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define CONTROL_PERIOD_MS 10    // Control cycle time of tuning and following
+#define SPEED 30                // Speed of both wheels on a straight line
+#define RELAY_AMPLITUDE 15      // Steering speed of the tuning oscillation
+#define LIMITS 100              // Steering output limit
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A+
+PidAutoTuner tuner(one);
+PidController pid;
+PidGains gains = {1.3, 0.01, 0.35};  // Used if nothing is stored in EEPROM
+unsigned long tcycle;                // Control cycle time in loop
+
+void autoTune() {
+  one.lcd2("Tuning...");
+  delay(1000);  // Time to release the button
+  tuner.setRelay(SPEED, RELAY_AMPLITUDE, 5, CONTROL_PERIOD_MS);
+  tuner.start();
+  tcycle = millis();
+  bool running = true;
+  while (running) {
+    if (millis() < tcycle) continue;
+    tcycle += CONTROL_PERIOD_MS;
+    running = tuner.step(one.readLine());
+  }
+  if (!tuner.isDone()) {
+    one.lcd2("Tuning failed");
+    return;
+  }
+  gains = tuner.computeGains(PidAutoTuner::Rule::ZIEGLER_NICHOLS);
+  tuner.save(gains);
+  Serial.print("Ku: ");
+  Serial.print(tuner.getUltimateGain());
+  Serial.print(" Tu (ms): ");
+  Serial.println(tuner.getUltimatePeriodMs());
+  Serial.print("kp: ");
+  Serial.print(gains.kp, 3);
+  Serial.print(" ki: ");
+  Serial.print(gains.ki, 4);
+  Serial.print(" kd: ");
+  Serial.println(gains.kd, 3);
+  one.lcd2("kp*1000:", (int)(gains.kp * 1000));
+}
+
+void followLine() {
+  one.lcd2("Following line");
+  delay(1000);  // Time to release the button
+  pid.setGains(gains.kp, gains.ki, gains.kd);
+  pid.setOutputLimits(-LIMITS, LIMITS);
+  pid.reset();
+  tcycle = millis();
+  while (one.readButton() == 0) {
+    if (millis() < tcycle) continue;
+    tcycle += CONTROL_PERIOD_MS;
+    const int output = pid.compute(0, one.readLine());
+    one.move(SPEED - output, SPEED + output);
+  }
+  one.stop();
+  one.lcd2("PB1:tune PB2:run");
+  delay(1000);  // Time to release the button
+}
+
+void setup() {
+  Serial.begin(115200);   // Set baud rate to 115200bps for printing values at
+                          // serial monitor.
+  one.spiConnect(SSPIN);  // Start SPI communication module
+  one.stop();             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("PID Auto Tuning");
+  one.lcd2("PB1:tune PB2:run");
+  tuner.load(gains);
+}
+
+void loop() {
+  const byte button = one.readButton();
+  if (button == 1) autoTune();
+  if (button == 2) followLine();
+}
@@ -0,0 +1,95 @@
+/**
+ * This code example is in the public domain.
+ * http://www.botnroll.com
+ *
+ * IMPORTANT!!!!
+ * Before you use this example you MUST calibrate the line sensor. Use example
+ * CalibrateLineSensor first!!! Line reading provides a linear value between
+ * -100 to 100
+ *
+ * Line follow with lap learning:
+ * The robot follows a closed track. The first lap is driven at a low speed
+ * while the LapLearner class maps the curves of the track. On the following
+ * laps the speed is scheduled ahead of time: fast on the straights and
+ * braking before the known curves. The SpeedGovernor class also slows the
+ * robot down as soon as a curve is seen by the line sensor, which keeps the
+ * first lap safe and catches curves that the map places wrongly. The
+ * steering is proportional to the line position and to the speed.
+ * Place the robot on the line and press a push button to start.
+ */
+
+#include <BnrOneAPlus.h>  // Bot'n Roll ONE A+ library
+#include <SPI.h>  // SPI communication library required by BnrOneAPlus.cpp
+
+#include "utils/LapLearner.h"
+#include "utils/SpeedGovernor.h"
+
+// Constants definition
+#define SSPIN 2                 // Slave Select (SS) pin for SPI communication
+#define MINIMUM_BATTERY_V 10.5  // Safety voltage for discharging the battery
+#define CONTROL_PERIOD_MS 10    // Control cycle time in loop
+#define LINE_GAIN 0.008         // Wheel speed difference per line unit
+
+BnrOneAPlus one;  // Object to control the Bot'n Roll ONE A+
+ControlUtils cut;
+LapLearner lap_learner;
+SpeedGovernor speed_governor;
+unsigned long tcycle;  // Control cycle time in loop
+int left_encoder = 0;
+int right_encoder = 0;
+
+void setup() {
+  one.spiConnect(SSPIN);                  // Start SPI communication module
+  one.stop();                             // Stop motors
+  one.setMinBatteryV(MINIMUM_BATTERY_V);  // Battery discharge protection
+  one.lcd1("  Lap Learning  ");
+  one.lcd2("Press a Button!!");
+  // Wait a button to be pressed <> Espera que pressione um botão
+  while (one.readButton() == 0)
+    ;
+  // Wait for button release <> Espera que largue o botão
+  while (one.readButton() != 0)
+    ;
+  one.lcd2("Learning lap");
+
+  // Learn at 300 mm/s, then race up to 1000 mm/s
+  lap_learner.setSpeedLimits(300, 1000, 2000);
+  lap_learner.start();
+  // Slow down on curves to as little as 100 mm/s, with the lateral
+  // acceleration limit of RobotParams
+  speed_governor.setSpeedLimits(1000, 100);
+  speed_governor.reset();
+  one.readAndResetEncoders(left_encoder, right_encoder);
+  tcycle = millis();  // Set start value for tcycle
+}
+
+void loop() {
+  if (millis() < tcycle) return;
+  tcycle += CONTROL_PERIOD_MS;
+
+  const int line = one.readLine();
+  lap_learner.update(left_encoder, right_encoder, line);
+  speed_governor.update(left_encoder, right_encoder, line);
+
+  // The outer wheel speeds up and the inner wheel slows down
+  const float speed =
+      min(lap_learner.getSpeedMmps(), speed_governor.getSpeedMmps());
+  const float steering = constrain(line * LINE_GAIN, -1.0, 1.0);
+  const WheelSpeeds wheel_speeds_rpm = cut.computeSpeedsRpm(
+      WheelSpeeds(speed * (1 + steering), speed * (1 - steering)));
+  one.moveRpmGetEncoders(wheel_speeds_rpm.getLeft(),
+                         wheel_speeds_rpm.getRight(),
+                         left_encoder,
+                         right_encoder);
+
+  // The LCD is only written when a lap is completed to keep the cycle short
+  static int shown_lap_count = 0;
+  static bool shown_error = false;
+  if (lap_learner.hasError() && !shown_error) {
+    shown_error = true;
+    one.lcd2("Track too long");
+  } else if (lap_learner.getLapCount() != shown_lap_count) {
+    shown_lap_count = lap_learner.getLapCount();
+    one.lcd2("Lap:", shown_lap_count);
+  }
+}
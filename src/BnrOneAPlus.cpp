@@ -142,6 +142,15 @@ void BnrOneAPlus::spiSendData(const byte command,
 }
 
 void BnrOneAPlus::move(const int left_speed, const int right_speed) const {
+  if (command_shaper_ != nullptr) {
+    command_shaper_->setTarget(left_speed, right_speed, false);
+    updateMotors();
+    return;
+  }
+  sendMove(left_speed, right_speed);
+}
+
+void BnrOneAPlus::sendMove(const int left_speed, const int right_speed) const {
   byte leftSpeed_H = highByte(left_speed);
   byte leftSpeed_L = lowByte(left_speed);
   byte rightSpeed_H = highByte(right_speed);
@@ -166,6 +175,7 @@ void BnrOneAPlus::sendMoveRpm(const byte command,
 }
 
 void BnrOneAPlus::moveRpm(const int left_rpm, const int right_rpm) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   digitalWrite(sspin_, LOW);  // Start communication
   sendMoveRpm(COMMAND_MOVE_RPM, left_rpm, right_rpm);
   digitalWrite(sspin_, HIGH);  // Close communication
@@ -177,6 +187,7 @@ void BnrOneAPlus::moveRpmGetEncoders(const int left_rpm,
                                      const int right_rpm,
                                      int& left_encoder,
                                      int& right_encoder) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   // Select the SPI Slave device to start communication.
   digitalWrite(sspin_, LOW);  // Start communication
   sendMoveRpm(COMMAND_MOVE_RPM_R_ENC, left_rpm, right_rpm);
@@ -197,10 +208,37 @@ void BnrOneAPlus::moveRpmGetEncoders(const int left_rpm,
 
 void BnrOneAPlus::moveRAW(const int left_duty_cycle,
                           const int right_duty_cycle) const {
-  byte leftPower_H = highByte(left_duty_cycle);
-  byte leftPower_L = lowByte(left_duty_cycle);
-  byte rightPower_H = highByte(right_duty_cycle);
-  byte rightPower_L = lowByte(right_duty_cycle);
+  if (command_shaper_ != nullptr) {
+    command_shaper_->setTarget(left_duty_cycle, right_duty_cycle, true);
+    updateMotors();
+    return;
+  }
+  sendMoveRAW(left_duty_cycle, right_duty_cycle);
+}
+
+void BnrOneAPlus::sendMoveRAW(const int left_duty_cycle,
+                              const int right_duty_cycle) const {
+  int left_power = left_duty_cycle;
+  int right_power = right_duty_cycle;
+  if (pwm_table_ != nullptr) {
+    left_power = pwm_table_->computeLeftDutyCycle(left_duty_cycle);
+    right_power = pwm_table_->computeRightDutyCycle(right_duty_cycle);
+  }
+  sendDutyCycles(left_power, right_power);
+}
+
+void BnrOneAPlus::moveDutyCycles(const int left_duty_cycle,
+                                 const int right_duty_cycle) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
+  sendDutyCycles(left_duty_cycle, right_duty_cycle);
+}
+
+void BnrOneAPlus::sendDutyCycles(const int left_power,
+                                 const int right_power) const {
+  byte leftPower_H = highByte(left_power);
+  byte leftPower_L = lowByte(left_power);
+  byte rightPower_H = highByte(right_power);
+  byte rightPower_L = lowByte(right_power);
 
   byte buffer[] = {
       KEY1, KEY2, leftPower_H, leftPower_L, rightPower_H, rightPower_L};
@@ -209,6 +247,7 @@ void BnrOneAPlus::moveRAW(const int left_duty_cycle,
 }
 
 void BnrOneAPlus::move1m(const byte motor_id, const int speed) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte speed_H = highByte(speed);
   byte speed_L = lowByte(speed);
 
@@ -218,30 +257,35 @@ void BnrOneAPlus::move1m(const byte motor_id, const int speed) const {
 }
 
 void BnrOneAPlus::stop() const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte buffer[] = {KEY1, KEY2};
   spiSendData(COMMAND_STOP, buffer, sizeof(buffer));
   delay(2);  // Wait while command is processed
 }
 
 void BnrOneAPlus::stop1m(const byte motor_id) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte buffer[] = {KEY1, KEY2, motor_id};
   spiSendData(COMMAND_STOP_1M, buffer, sizeof(buffer));
   delay(2);  // Wait while command is processed
 }
 
 void BnrOneAPlus::brake(const byte left_torque, const byte right_torque) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte buffer[] = {KEY1, KEY2, left_torque, right_torque};
   spiSendData(COMMAND_BRAKE_SET_T, buffer, sizeof(buffer));
   delay(2);  // Wait while command is processed
 }
 
 void BnrOneAPlus::brake1m(const byte motor_id, const byte torque) const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte buffer[] = {KEY1, KEY2, motor_id, torque};
   spiSendData(COMMAND_BRAKE_1M, buffer, sizeof(buffer));
   delay(2);  // Wait while command is processed
 }
 
 void BnrOneAPlus::brake() const {
+  if (command_shaper_ != nullptr) command_shaper_->reset();
   byte buffer[] = {KEY1, KEY2};
   spiSendData(COMMAND_BRAKE_MAX_T, buffer, sizeof(buffer));
   delay(2);  // Wait while command is processed
@@ -310,6 +354,26 @@ void BnrOneAPlus::setMotors(const int motor_power,
   delay(25);  // Delay for EEPROM writing
 }
 
+void BnrOneAPlus::setPwmTable(const PwmTable* pwm_table) {
+  pwm_table_ = pwm_table;
+}
+
+void BnrOneAPlus::setCommandShaper(CommandShaper* command_shaper) {
+  command_shaper_ = command_shaper;
+  if (command_shaper_ != nullptr) command_shaper_->reset();
+}
+
+void BnrOneAPlus::updateMotors() const {
+  if (command_shaper_ == nullptr) return;
+  if (!command_shaper_->update(micros())) return;
+  if (command_shaper_->isRaw()) {
+    sendMoveRAW(command_shaper_->getLeftSpeed(),
+                command_shaper_->getRightSpeed());
+  } else {
+    sendMove(command_shaper_->getLeftSpeed(), command_shaper_->getRightSpeed());
+  }
+}
+
 byte BnrOneAPlus::readButton() const {
   int adc;
   byte button;
@@ -10,7 +10,9 @@
 #include <string.h>
 
 #include "Arduino.h"
+#include "utils/CommandShaper.h"
 #include "utils/LineDetector.h"
+#include "utils/PwmTable.h"
 
 class BnrOneAPlus {
  public:
@@ -51,6 +53,37 @@ class BnrOneAPlus {
    */
   void setMotors(const int moving_power, const int max_speed_pulses) const;
 
+  /**
+   * @brief Sets a table that linearises the duty cycles of moveRAW(), e.g.
+   * the one identified by MotorIdentification. moveDutyCycles() bypasses it.
+   * The table is not copied and must remain valid while it is set.
+   *
+   * @param pwm_table table, or nullptr to send the duty cycles unchanged
+   */
+  void setPwmTable(const PwmTable* pwm_table);
+
+  /**
+   * @brief Sets a shaper that limits the acceleration and jerk of move() and
+   * moveRAW(), the only commands that are shaped. Their speeds become targets
+   * that are reached over the next control ticks of the shaper, and a command
+   * is only sent when the shaped speeds change. Calling move() or moveRAW()
+   * every loop keeps the ramp going; otherwise call updateMotors(). stop(),
+   * brake(), moveDutyCycles(), the single motor commands and the RPM commands
+   * (moveRpm() and moveRpmGetEncoders(), used by MotionGenerator) act at once
+   * and reset the shaper, so the next move() or moveRAW() ramps both wheels
+   * from rest. Set it with the motors stopped. The shaper is not copied and
+   * must remain valid while it is set.
+   *
+   * @param command_shaper shaper, or nullptr to send the speeds unchanged
+   */
+  void setCommandShaper(CommandShaper* command_shaper);
+
+  /**
+   * @brief Sends the next shaped speeds if a control tick of the command
+   * shaper elapsed. Does nothing without a command shaper.
+   */
+  void updateMotors() const;
+
   /**
    * @brief Turn on/off the obstacle sensors IR emitters
    *
@@ -236,13 +269,25 @@ class BnrOneAPlus {
                           int& out_right_encoder) const;
 
   /**
-   * @brief sets the speed of the motors by specifying the pwm values
+   * @brief sets the speed of the motors by specifying the pwm values. If a
+   * PWM table is set, the values are speeds in % of the top speed and are
+   * converted to duty cycles by the table.
    *
    * @param left_duty_cycle
    * @param right_duty_cycle
    */
   void moveRAW(const int left_duty_cycle, const int right_duty_cycle) const;
 
+  /**
+   * @brief sets the duty cycles of the motors as given, bypassing the PWM
+   * table and the command shaper, e.g. to identify the motors
+   *
+   * @param left_duty_cycle
+   * @param right_duty_cycle
+   */
+  void moveDutyCycles(const int left_duty_cycle,
+                      const int right_duty_cycle) const;
+
   /**
    * @brief sets the speed of a single motor
    *
@@ -403,6 +448,12 @@ class BnrOneAPlus {
   void spiSendData(const byte command,
                    const byte buffer[],
                    const byte num_bytes) const;
+  void sendMove(const int left_speed, const int right_speed) const;
+  void sendMoveRAW(const int left_duty_cycle,
+                   const int right_duty_cycle) const;
+  void sendDutyCycles(const int left_power, const int right_power) const;
   byte sspin_;
   LineDetector line_detector_;
+  const PwmTable* pwm_table_ = nullptr;
+  CommandShaper* command_shaper_ = nullptr;
 };
@@ -0,0 +1,73 @@
+#include "BatteryCompensator.h"
+
+#define SAMPLE_PERIOD_MS 500     // Time between battery readings
+#define FILTER_ALPHA 0.1         // Low-pass filter weight of a new reading
+#define WARM_UP_SAMPLES 20       // Readings before the discharge reference
+#define RUNTIME_WINDOW_MS 60000  // Shortest time to estimate discharge rate
+#define MAX_SCALE 1.5            // Limit of the compensation scale
+
+BatteryCompensator::BatteryCompensator(const BnrOneAPlus& one,
+                                       const float nominal_voltage,
+                                       const float min_voltage)
+    : one_(one),
+      nominal_voltage_(nominal_voltage),
+      min_voltage_(min_voltage),
+      voltage_(0),
+      first_voltage_(0),
+      first_ms_(0),
+      last_ms_(0),
+      num_samples_(0) {}
+
+void BatteryCompensator::update() {
+  if (num_samples_ > 0 && millis() - last_ms_ < SAMPLE_PERIOD_MS) return;
+  sample();
+}
+
+float BatteryCompensator::getVoltage() const { return voltage_; }
+
+float BatteryCompensator::getScale() const {
+  if (voltage_ <= 0) return 1.0;
+  return constrain(nominal_voltage_ / voltage_, 1.0 / MAX_SCALE, MAX_SCALE);
+}
+
+int BatteryCompensator::compensate(const int duty_cycle) const {
+  return constrain((int)round(duty_cycle * getScale()), -100, 100);
+}
+
+float BatteryCompensator::compensateGain(const float gain) const {
+  return gain * getScale();
+}
+
+void BatteryCompensator::moveRAW(const int left_duty_cycle,
+                                 const int right_duty_cycle) const {
+  one_.moveRAW(compensate(left_duty_cycle), compensate(right_duty_cycle));
+}
+
+long BatteryCompensator::getRemainingRuntimeS() const {
+  if (num_samples_ < WARM_UP_SAMPLES) return -1;
+  const unsigned long elapsed_ms = last_ms_ - first_ms_;
+  const float drop = first_voltage_ - voltage_;
+  if (elapsed_ms < RUNTIME_WINDOW_MS || drop <= 0) return -1;
+
+  const float rate_vps = drop / (elapsed_ms / 1000.0);
+  return max(0L, (long)((voltage_ - min_voltage_) / rate_vps));
+}
+
+void BatteryCompensator::sample() {
+  const float voltage = one_.readBattery();
+  last_ms_ = millis();
+  if (num_samples_ == 0) {
+    voltage_ = voltage;
+  } else {
+    voltage_ += FILTER_ALPHA * (voltage - voltage_);
+  }
+
+  // The discharge is measured from the voltage once the filter settled
+  if (num_samples_ < WARM_UP_SAMPLES) {
+    ++num_samples_;
+    if (num_samples_ == WARM_UP_SAMPLES) {
+      first_voltage_ = voltage_;
+      first_ms_ = last_ms_;
+    }
+  }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+/**
+ * @class BatteryCompensator
+ * @brief Compensates open-loop moveRAW() duty cycles and the gains of
+ * controllers that drive them for the battery voltage, and predicts the
+ * remaining runtime.
+ *
+ * The motor speed given by a duty cycle is proportional to the battery
+ * voltage, so as the battery discharges the same duty cycle gives less speed
+ * and gains tuned on a full battery become sluggish. The battery is sampled
+ * at a low rate and low-pass filtered, and duty cycles and gains are scaled
+ * by the nominal voltage over the filtered voltage. The speeds of move() and
+ * of the RPM commands are held by the speed controller of the co-processor,
+ * which already rejects the voltage, so they must not be compensated. The
+ * runtime is predicted from the mean discharge rate since the first sample.
+ */
+class BatteryCompensator {
+ public:
+  /**
+   * @brief Constructor for BatteryCompensator.
+   * @param one Reference to BnrOneAPlus object.
+   * @param nominal_voltage Voltage at which duty cycles and gains were
+   * tuned.
+   * @param min_voltage Voltage at which the battery is considered empty, as
+   * given to BnrOneAPlus::setMinBatteryV().
+   */
+  BatteryCompensator(const BnrOneAPlus& one,
+                     const float nominal_voltage = 12.0,
+                     const float min_voltage = 10.5);
+
+  /**
+   * @brief Samples the battery when due and updates the filtered voltage.
+   * Call frequently, e.g. every control cycle. The battery is read only
+   * every few hundred milliseconds.
+   */
+  void update();
+
+  /**
+   * @brief Gets the filtered battery voltage.
+   * @return Voltage in volts, 0 before the first sample.
+   */
+  float getVoltage() const;
+
+  /**
+   * @brief Gets the scale of duty cycles and gains, nominal over filtered
+   * voltage.
+   */
+  float getScale() const;
+
+  /**
+   * @brief Scales a moveRAW() duty cycle.
+   * @param duty_cycle Duty cycle in the range [-100, 100].
+   * @return Scaled duty cycle in the range [-100, 100].
+   */
+  int compensate(const int duty_cycle) const;
+
+  /**
+   * @brief Scales a controller gain whose output is a moveRAW() duty cycle.
+   * The output of a compensated controller must not be compensated again.
+   * @param gain Gain tuned at the nominal voltage.
+   * @return Gain for the current voltage.
+   */
+  float compensateGain(const float gain) const;
+
+  /**
+   * @brief Calls BnrOneAPlus::moveRAW() with compensated duty cycles.
+   */
+  void moveRAW(const int left_duty_cycle, const int right_duty_cycle) const;
+
+  /**
+   * @brief Predicts the time left until the battery reaches the minimum
+   * voltage at the mean discharge rate so far.
+   * @return Time in seconds, or -1 while the discharge rate is unknown.
+   */
+  long getRemainingRuntimeS() const;
+
+ private:
+  /**
+   * @brief Reads the battery and filters the voltage.
+   */
+  void sample();
+
+  const BnrOneAPlus& one_;  ///< Reference to BnrOneAPlus object.
+  float nominal_voltage_;   ///< Voltage at which duty cycles were tuned.
+  float min_voltage_;       ///< Voltage of an empty battery.
+  float voltage_;           ///< Filtered voltage.
+  float first_voltage_;     ///< Filtered voltage at the first estimate.
+  unsigned long first_ms_;  ///< Time of the first estimate.
+  unsigned long last_ms_;   ///< Time of the last sample.
+  int num_samples_;         ///< Samples taken, up to the filter warm-up.
+};
@@ -0,0 +1,92 @@
+#include "CommandShaper.h"
+
+#define MAX_TICK_S 0.05  // Longest time step, after the loop was busy
+
+CommandShaper::CommandShaper(const float max_accel,
+                             const float max_jerk,
+                             const unsigned int period_ms)
+    : max_accel_(max_accel),
+      max_jerk_(max_jerk),
+      period_us_(period_ms * 1000UL),
+      raw_(false),
+      started_(false),
+      last_tick_us_(0) {
+  reset();
+}
+
+void CommandShaper::setLimits(const float max_accel, const float max_jerk) {
+  max_accel_ = max_accel;
+  max_jerk_ = max_jerk;
+}
+
+void CommandShaper::reset() {
+  left_ = {0, 0, 0, 0};
+  right_ = {0, 0, 0, 0};
+  started_ = false;
+}
+
+void CommandShaper::setTarget(const int left_speed,
+                              const int right_speed,
+                              const bool raw) {
+  // The shaped speeds are meaningless in the other units
+  if (raw != raw_) reset();
+  left_.target = left_speed;
+  right_.target = right_speed;
+  raw_ = raw;
+}
+
+bool CommandShaper::update(const unsigned long now_us) {
+  if (!started_) {
+    // First tick after a reset: no time has elapsed yet
+    started_ = true;
+    last_tick_us_ = now_us - period_us_;
+  }
+  const unsigned long elapsed_us = now_us - last_tick_us_;
+  if (elapsed_us < period_us_) return false;
+  last_tick_us_ = now_us;
+
+  const float dt_s = min(elapsed_us / 1000000.0, MAX_TICK_S);
+  updateWheel(left_, dt_s);
+  updateWheel(right_, dt_s);
+
+  const int left_speed = getLeftSpeed();
+  const int right_speed = getRightSpeed();
+  if (left_speed == left_.sent && right_speed == right_.sent) return false;
+  left_.sent = left_speed;
+  right_.sent = right_speed;
+  return true;
+}
+
+int CommandShaper::getLeftSpeed() const { return (int)round(left_.speed); }
+
+int CommandShaper::getRightSpeed() const { return (int)round(right_.speed); }
+
+bool CommandShaper::isRaw() const { return raw_; }
+
+bool CommandShaper::isSettled() const {
+  return left_.speed == left_.target && right_.speed == right_.target;
+}
+
+void CommandShaper::updateWheel(Wheel& wheel, const float dt_s) const {
+  const float error = wheel.target - wheel.speed;
+  if (error == 0 && wheel.accel == 0) return;
+
+  // Largest acceleration from which the jerk limit can still bring the
+  // acceleration to zero when the speed reaches the target
+  const float braking_accel = sqrt(2 * max_jerk_ * fabs(error));
+  float desired_accel = min(max_accel_, braking_accel);
+  if (error < 0) desired_accel = -desired_accel;
+
+  const float max_change = max_jerk_ * dt_s;
+  wheel.accel +=
+      constrain(desired_accel - wheel.accel, -max_change, max_change);
+  const float step = wheel.accel * dt_s;
+
+  // Settle on the target instead of overshooting it
+  if ((error >= 0 && step >= error) || (error <= 0 && step <= error)) {
+    wheel.speed = wheel.target;
+    wheel.accel = 0;
+  } else {
+    wheel.speed += step;
+  }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class CommandShaper
+ * @brief Limits the acceleration and the jerk of the speed commands of each
+ * wheel.
+ *
+ * A step in the commanded speed, e.g. from move(80, 80) to move(-80, -80),
+ * spins the wheels, and the robot loses time until they grip again. The
+ * shaper turns the step into an S-shaped ramp: every control tick the
+ * acceleration of a wheel changes by at most the jerk limit, never exceeds
+ * the acceleration limit, and is reduced in time for the speed to settle on
+ * the target without overshoot. The fastest ramp is given by the largest
+ * acceleration at which the wheels do not slip yet, which depends on the
+ * tyres and the floor.
+ *
+ * Speeds are in the units of BnrOneAPlus::move() and moveRAW(), i.e. % of
+ * the top speed, so the limits are in %/s and %/s^2.
+ */
+class CommandShaper {
+ public:
+  /**
+   * @brief Constructor for CommandShaper.
+   * @param max_accel Maximum acceleration in %/s.
+   * @param max_jerk Maximum jerk in %/s^2.
+   * @param period_ms Control tick in ms.
+   */
+  CommandShaper(const float max_accel = 400,
+                const float max_jerk = 4000,
+                const unsigned int period_ms = 10);
+
+  /**
+   * @brief Sets the limits.
+   * @param max_accel Maximum acceleration in %/s.
+   * @param max_jerk Maximum jerk in %/s^2.
+   */
+  void setLimits(const float max_accel, const float max_jerk);
+
+  /**
+   * @brief Sets the speeds to zero, e.g. after the motors were stopped.
+   */
+  void reset();
+
+  /**
+   * @brief Sets the target speeds. When the speeds change between move() and
+   * moveRAW() units, the shaper is reset and the wheels ramp from rest.
+   * @param left_speed Left wheel target speed.
+   * @param right_speed Right wheel target speed.
+   * @param raw true for moveRAW() speeds, false for move() speeds.
+   */
+  void setTarget(const int left_speed, const int right_speed, const bool raw);
+
+  /**
+   * @brief Moves the speeds towards the targets if a control tick elapsed.
+   * @param now_us Current time in microseconds.
+   * @return true if the shaped speeds changed and must be sent.
+   */
+  bool update(const unsigned long now_us);
+
+  /**
+   * @brief Gets the shaped speed of the left wheel.
+   */
+  int getLeftSpeed() const;
+
+  /**
+   * @brief Gets the shaped speed of the right wheel.
+   */
+  int getRightSpeed() const;
+
+  /**
+   * @brief Gets whether the shaped speeds are for moveRAW().
+   */
+  bool isRaw() const;
+
+  /**
+   * @brief Gets whether both wheels reached their target speeds.
+   */
+  bool isSettled() const;
+
+ private:
+  /**
+   * @brief Speed profile of a wheel.
+   */
+  struct Wheel {
+    float target;  ///< Target speed.
+    float speed;   ///< Shaped speed.
+    float accel;   ///< Shaped acceleration.
+    int sent;      ///< Speed sent last.
+  };
+
+  /**
+   * @brief Moves the speed of a wheel towards its target.
+   * @param wheel Wheel to update.
+   * @param dt_s Time step in seconds.
+   */
+  void updateWheel(Wheel& wheel, const float dt_s) const;
+
+  float max_accel_;             ///< Maximum acceleration.
+  float max_jerk_;              ///< Maximum jerk.
+  unsigned long period_us_;     ///< Control tick.
+  Wheel left_;                  ///< Left wheel profile.
+  Wheel right_;                 ///< Right wheel profile.
+  bool raw_;                    ///< Speeds are for moveRAW().
+  bool started_;                ///< A tick was taken since the reset.
+  unsigned long last_tick_us_;  ///< Time of the last control tick.
+};
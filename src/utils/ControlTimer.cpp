@@ -0,0 +1,124 @@
+#include "ControlTimer.h"
+
+#ifdef __AVR__
+#include <util/atomic.h>  // Blocks that restore the interrupt state
+#else
+#define ATOMIC_BLOCK(type)  // No Timer1 interrupt to guard against
+#endif
+
+#define TIMER1_MAX_COUNT 65536UL  // Counts of the 16-bit Timer1
+
+namespace {
+const ControlTimerStats NO_STATS = {0, 0, 0, 0, 0, 0};
+}
+
+ControlTimer::ControlTimer()
+    : callback_(nullptr),
+      period_us_(0),
+      ticks_(0),
+      tick_us_(0),
+      pending_(false),
+      missed_(0),
+      last_run_us_(0),
+      stats_(NO_STATS) {}
+
+bool ControlTimer::begin(const unsigned long period_us,
+                         ControlCallback callback) {
+#if defined(TCCR1A) && defined(OCIE1A)
+  // Smallest prescaler for the finest resolution
+  const unsigned int prescalers[] = {1, 8, 64, 256, 1024};
+  const byte clock_selects[] = {(1 << CS10),
+                                (1 << CS11),
+                                (1 << CS11) | (1 << CS10),
+                                (1 << CS12),
+                                (1 << CS12) | (1 << CS10)};
+  const unsigned long cycles = (F_CPU / 1000000UL) * period_us;
+  for (byte i = 0; i < sizeof(prescalers) / sizeof(prescalers[0]); ++i) {
+    const unsigned long counts = cycles / prescalers[i];
+    if (counts == 0 || counts > TIMER1_MAX_COUNT) continue;
+
+    end();
+    callback_ = callback;
+    period_us_ = period_us;
+    ticks_ = 0;
+    pending_ = false;
+    resetStats();
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      TCCR1A = 0;
+      TCCR1B = (1 << WGM12) | clock_selects[i];  // CTC mode
+      TCNT1 = 0;
+      OCR1A = counts - 1;
+      TIFR1 = (1 << OCF1A);  // Clear a stale compare match
+      TIMSK1 |= (1 << OCIE1A);
+    }
+    return true;
+  }
+#else
+  (void)period_us;
+  (void)callback;
+#endif
+  return false;
+}
+
+void ControlTimer::end() {
+#if defined(TCCR1A) && defined(OCIE1A)
+  TIMSK1 &= ~(1 << OCIE1A);
+  TCCR1B = 0;
+#endif
+  pending_ = false;
+}
+
+bool ControlTimer::run() {
+  if (!pending_) return false;
+  unsigned long tick_us = 0;
+  unsigned long missed = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    tick_us = tick_us_;
+    missed = missed_;
+    pending_ = false;
+  }
+
+  const unsigned long start_us = micros();
+  const unsigned long latency_us = start_us - tick_us;
+  stats_.max_latency_us = max(stats_.max_latency_us, latency_us);
+  stats_.sum_latency_us += latency_us;
+  stats_.missed_ticks = missed;
+  if (stats_.runs > 0) {
+    const long error_us = (long)(start_us - last_run_us_) - (long)period_us_;
+    const unsigned long jitter_us = abs(error_us);
+    stats_.max_jitter_us = max(stats_.max_jitter_us, jitter_us);
+  }
+  last_run_us_ = start_us;
+
+  if (callback_ != nullptr) callback_();
+  stats_.max_run_us = max(stats_.max_run_us, micros() - start_us);
+  ++stats_.runs;
+  return true;
+}
+
+void ControlTimer::onTick() {
+  ++ticks_;
+  if (pending_) ++missed_;
+  tick_us_ = micros();
+  pending_ = true;
+}
+
+unsigned long ControlTimer::getTicks() const {
+  unsigned long ticks = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { ticks = ticks_; }
+  return ticks;
+}
+
+unsigned long ControlTimer::getPeriodUs() const { return period_us_; }
+
+const ControlTimerStats& ControlTimer::getStats() const { return stats_; }
+
+unsigned long ControlTimer::getMeanLatencyUs() const {
+  if (stats_.runs == 0) return 0;
+  return stats_.sum_latency_us / stats_.runs;
+}
+
+void ControlTimer::resetStats() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { missed_ = 0; }
+  stats_ = NO_STATS;
+}
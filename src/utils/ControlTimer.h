@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Defines the Timer1 compare interrupt of a ControlTimer. Use once in
+ * the sketch, at file scope, e.g. CONTROL_TIMER_ISR(control_timer). The
+ * interrupt is not defined by the library, so sketches that do not use a
+ * ControlTimer can still use Timer1 (e.g. the Servo library).
+ */
+#define CONTROL_TIMER_ISR(control_timer) \
+  ISR(TIMER1_COMPA_vect) { control_timer.onTick(); }
+
+/**
+ * @brief Function run every tick of a ControlTimer.
+ */
+typedef void (*ControlCallback)();
+
+/**
+ * @brief Timing statistics of a ControlTimer.
+ */
+struct ControlTimerStats {
+  unsigned long runs;            ///< Number of callback runs.
+  unsigned long missed_ticks;    ///< Ticks without a callback run.
+  unsigned long max_latency_us;  ///< Longest delay from tick to run.
+  unsigned long sum_latency_us;  ///< Sum of the delays from tick to run.
+  unsigned long max_jitter_us;   ///< Largest error of a period between runs.
+  unsigned long max_run_us;      ///< Longest run time of the callback.
+};
+
+/**
+ * @class ControlTimer
+ * @brief Exact-period control tick generated by Timer1 in CTC mode.
+ *
+ * The timer interrupt only flags the tick and stamps it with micros(). The
+ * callback is run from loop() by run(), outside the interrupt, so it can use
+ * the SPI commands of BnrOneAPlus, which wait with delay() and must not run
+ * in an interrupt. The period of the callback is then exact on average and
+ * its jitter is the time loop() takes to call run(), which the statistics
+ * measure. loop() must call run() at least once per period: a tick still
+ * pending when the next one occurs is counted as missed.
+ */
+class ControlTimer {
+ public:
+  /**
+   * @brief Constructor for ControlTimer.
+   */
+  ControlTimer();
+
+  /**
+   * @brief Configures Timer1 and starts the ticks.
+   * @param period_us Tick period, e.g. 2000 to 5000 for a control loop.
+   * @param callback Function run every tick, or nullptr to only count the
+   * ticks.
+   * @return false if the period is not supported by Timer1.
+   */
+  bool begin(const unsigned long period_us,
+             ControlCallback callback = nullptr);
+
+  /**
+   * @brief Stops the ticks.
+   */
+  void end();
+
+  /**
+   * @brief Runs the callback if a tick is pending. Call from loop() as often
+   * as possible.
+   * @return true if the callback was run.
+   */
+  bool run();
+
+  /**
+   * @brief Flags a tick. Called by the interrupt defined with
+   * CONTROL_TIMER_ISR.
+   */
+  void onTick();
+
+  /**
+   * @brief Gets the number of ticks since begin().
+   */
+  unsigned long getTicks() const;
+
+  /**
+   * @brief Gets the tick period.
+   * @return Period in microseconds, 0 before begin().
+   */
+  unsigned long getPeriodUs() const;
+
+  /**
+   * @brief Gets the timing statistics.
+   */
+  const ControlTimerStats& getStats() const;
+
+  /**
+   * @brief Gets the mean delay from a tick to the run of the callback.
+   * @return Delay in microseconds.
+   */
+  unsigned long getMeanLatencyUs() const;
+
+  /**
+   * @brief Clears the timing statistics.
+   */
+  void resetStats();
+
+ private:
+  ControlCallback callback_;        ///< Function run every tick.
+  unsigned long period_us_;         ///< Tick period.
+  volatile unsigned long ticks_;    ///< Ticks since begin().
+  volatile unsigned long tick_us_;  ///< Time of the pending tick.
+  volatile bool pending_;           ///< A tick waits for run().
+  volatile unsigned long missed_;   ///< Ticks flagged while pending.
+  unsigned long last_run_us_;       ///< Start of the last run.
+  ControlTimerStats stats_;         ///< Timing statistics.
+};
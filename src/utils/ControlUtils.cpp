@@ -2,14 +2,20 @@
 
 #include <Arduino.h>  // Include Arduino library for math functions
 
+#include "FastTrig.h"
+
+#define LINE_OFFSET_MM 35        // Line offset when readLine() returns 100
+#define LINE_SENSOR_AHEAD_MM 75  // Distance of the line sensor ahead of axle
+
 // Pose class implementation
 Pose::Pose(const float x_mm_in, const float y_mm_in, const float theta_rad_in)
     : x_mm(x_mm_in), y_mm(y_mm_in), theta_rad(theta_rad_in) {}
 
 void Pose::updatePose(const float delta_distance_mm,
                       const float delta_theta_rad) {
-  x_mm += delta_distance_mm * cos(theta_rad + delta_theta_rad / 2.0);
-  y_mm += delta_distance_mm * sin(theta_rad + delta_theta_rad / 2.0);
+  const uint16_t heading_brad = radToBrad(theta_rad + delta_theta_rad / 2.0);
+  x_mm += delta_distance_mm * cosQ15(heading_brad) / Q15_ONE;
+  y_mm += delta_distance_mm * sinQ15(heading_brad) / Q15_ONE;
   theta_rad += delta_theta_rad;
 }
 
@@ -34,8 +40,12 @@ float WheelSpeeds::getRight() const { return right; }
 // ControlUtils class implementation
 ControlUtils::ControlUtils(const RobotParams& params,
                            const float min_speed_mmps)
-    : axis_length_mm_(params.axis_length_mm),
-      wheel_diameter_mm_(params.wheel_diameter_mm),
+    : axis_length_mm_(params.track_width_mm),
+      wheel_diameter_mm_(
+          (params.left_wheel_diameter_mm + params.right_wheel_diameter_mm) /
+          2.0),
+      left_wheel_diameter_mm_(params.left_wheel_diameter_mm),
+      right_wheel_diameter_mm_(params.right_wheel_diameter_mm),
       pulses_per_rev_(params.pulses_per_rev),
       max_speed_mmps_(params.max_speed_rpm * PI * wheel_diameter_mm_ / 60),
       min_speed_mmps_(min_speed_mmps),
@@ -43,6 +53,14 @@ ControlUtils::ControlUtils(const RobotParams& params,
 
 float ControlUtils::getAxisLengthMm() const { return axis_length_mm_; }
 
+float ControlUtils::getLeftWheelDiameterMm() const {
+  return left_wheel_diameter_mm_;
+}
+
+float ControlUtils::getRightWheelDiameterMm() const {
+  return right_wheel_diameter_mm_;
+}
+
 float ControlUtils::convertRange(const float x_value,
                                  const float x_min,
                                  const float x_max,
@@ -74,6 +92,14 @@ float ControlUtils::computeDistanceFromPulses(const int pulses) const {
   return computeDistanceFromRev(rev);
 }
 
+float ControlUtils::computeLeftDistanceFromPulses(const long pulses) const {
+  return (PI * left_wheel_diameter_mm_ * pulses) / pulses_per_rev_;
+}
+
+float ControlUtils::computeRightDistanceFromPulses(const long pulses) const {
+  return (PI * right_wheel_diameter_mm_ * pulses) / pulses_per_rev_;
+}
+
 float ControlUtils::computeSpeedFromDistance(const float distance_mm,
                                              const int time_ms) const {
   return (distance_mm * 1000) / time_ms;
@@ -161,8 +187,10 @@ float ControlUtils::mmpsToRpm(const float mmps) const {
 
 WheelSpeeds ControlUtils::computeSpeedsRpm(
     const WheelSpeeds& wheel_speeds_mmps) const {
-  const auto left_rpm = mmpsToRpm(wheel_speeds_mmps.getLeft());
-  const auto right_rpm = mmpsToRpm(wheel_speeds_mmps.getRight());
+  const auto left_rpm =
+      (wheel_speeds_mmps.getLeft() * 60) / (left_wheel_diameter_mm_ * PI);
+  const auto right_rpm =
+      (wheel_speeds_mmps.getRight() * 60) / (right_wheel_diameter_mm_ * PI);
   return WheelSpeeds(left_rpm, right_rpm);
 }
 
@@ -172,7 +200,63 @@ float ControlUtils::rpmToMmps(const float speed_rpm) const {
 
 WheelSpeeds ControlUtils::computeSpeedsMmps(
     const WheelSpeeds& wheel_speeds_rpm) const {
-  float left_mmps = rpmToMmps(wheel_speeds_rpm.getLeft());
-  float right_mmps = rpmToMmps(wheel_speeds_rpm.getRight());
+  float left_mmps =
+      (wheel_speeds_rpm.getLeft() / 60.0) * (left_wheel_diameter_mm_ * PI);
+  float right_mmps =
+      (wheel_speeds_rpm.getRight() / 60.0) * (right_wheel_diameter_mm_ * PI);
   return WheelSpeeds(left_mmps, right_mmps);
-}
\ No newline at end of file
+}
+
+void ControlUtils::computeWheelSpeedsRpm(const float* __restrict__ linear_mmps,
+                                         const float* __restrict__ angular_rad,
+                                         float* __restrict__ out_left_rpm,
+                                         float* __restrict__ out_right_rpm,
+                                         const size_t count) const {
+  // Factors are hoisted out of the loop so it is a plain multiply-add
+  const float left_rpm_per_mmps = 60 / (left_wheel_diameter_mm_ * PI);
+  const float right_rpm_per_mmps = 60 / (right_wheel_diameter_mm_ * PI);
+  const float half_axis_mm = axis_length_mm_ / 2.0;
+  for (size_t i = 0; i < count; ++i) {
+    const float delta_mmps = angular_rad[i] * half_axis_mm;
+    out_left_rpm[i] = (linear_mmps[i] - delta_mmps) * left_rpm_per_mmps;
+    out_right_rpm[i] = (linear_mmps[i] + delta_mmps) * right_rpm_per_mmps;
+  }
+}
+
+void ControlUtils::computeWheelSpeedsRpm(const float* __restrict__ linear_mmps,
+                                         const float* __restrict__ angular_rad,
+                                         int16_t* __restrict__ out_left_rpm,
+                                         int16_t* __restrict__ out_right_rpm,
+                                         const size_t count) const {
+  const float left_rpm_per_mmps = 60 / (left_wheel_diameter_mm_ * PI);
+  const float right_rpm_per_mmps = 60 / (right_wheel_diameter_mm_ * PI);
+  const float half_axis_mm = axis_length_mm_ / 2.0;
+  for (size_t i = 0; i < count; ++i) {
+    const float delta_mmps = angular_rad[i] * half_axis_mm;
+    out_left_rpm[i] =
+        (int16_t)round((linear_mmps[i] - delta_mmps) * left_rpm_per_mmps);
+    out_right_rpm[i] =
+        (int16_t)round((linear_mmps[i] + delta_mmps) * right_rpm_per_mmps);
+  }
+}
+
+void ControlUtils::computePoseSpeedsFromRpm(
+    const float* __restrict__ left_rpm,
+    const float* __restrict__ right_rpm,
+    float* __restrict__ out_linear_mmps,
+    float* __restrict__ out_angular_rad,
+    const size_t count) const {
+  const float left_mmps_per_rpm = (left_wheel_diameter_mm_ * PI) / 60;
+  const float right_mmps_per_rpm = (right_wheel_diameter_mm_ * PI) / 60;
+  for (size_t i = 0; i < count; ++i) {
+    const float left_mmps = left_rpm[i] * left_mmps_per_rpm;
+    const float right_mmps = right_rpm[i] * right_mmps_per_rpm;
+    out_linear_mmps[i] = (left_mmps + right_mmps) / 2;
+    out_angular_rad[i] = (right_mmps - left_mmps) / axis_length_mm_;
+  }
+}
+
+float ControlUtils::computeLineBearingRad(const int line_position) const {
+  const float line_offset_mm = -line_position * (LINE_OFFSET_MM / 100.0);
+  return fastAtan2(line_offset_mm, LINE_SENSOR_AHEAD_MM);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Arduino.h>
+
 #include "RobotParams.h"
 
 /**
@@ -125,11 +127,24 @@ class ControlUtils {
                const float min_speed_mmps = 0);
 
   /**
-   * @brief Gets the axis length in millimeters.
+   * @brief Gets the axis length in millimeters. This is the effective track
+   * width when the robot params are calibrated.
    * @return Axis length in millimeters.
    */
   float getAxisLengthMm() const;
 
+  /**
+   * @brief Gets the diameter of the left wheel in millimeters.
+   * @return Left wheel diameter in millimeters.
+   */
+  float getLeftWheelDiameterMm() const;
+
+  /**
+   * @brief Gets the diameter of the right wheel in millimeters.
+   * @return Right wheel diameter in millimeters.
+   */
+  float getRightWheelDiameterMm() const;
+
   /**
    * @brief Converts a value from one range to another.
    * @param x_value Value to convert.
@@ -166,6 +181,22 @@ class ControlUtils {
    */
   float computeDistanceFromPulses(const int pulses) const;
 
+  /**
+   * @brief Computes the distance travelled by the left wheel from its number
+   * of pulses using its calibrated diameter.
+   * @param pulses Number of pulses of the left encoder.
+   * @return Distance in millimeters.
+   */
+  float computeLeftDistanceFromPulses(const long pulses) const;
+
+  /**
+   * @brief Computes the distance travelled by the right wheel from its
+   * number of pulses using its calibrated diameter.
+   * @param pulses Number of pulses of the right encoder.
+   * @return Distance in millimeters.
+   */
+  float computeRightDistanceFromPulses(const long pulses) const;
+
   /**
    * @brief Computes the speed from the distance and time.
    * @param distance_mm Distance in millimeters.
@@ -283,7 +314,7 @@ class ControlUtils {
 
   /**
    * @brief Computes the speeds in RPM from the speeds in millimeters per
-   * second.
+   * second, using the calibrated diameter of each wheel.
    * @param wheel_speeds_mmps WheelSpeeds object containing the speeds in
    * millimeters per second.
    * @return WheelSpeeds object containing the speeds in RPM.
@@ -299,17 +330,78 @@ class ControlUtils {
   float rpmToMmps(const float speed_rpm) const;
 
   /**
-   * @brief Computes the speeds in mm/s from the speeds in RPM.
+   * @brief Computes the speeds in mm/s from the speeds in RPM, using the
+   * calibrated diameter of each wheel.
    * @param wheel_speeds_rpm WheelSpeeds object containing the speeds in RPM.
    * @return WheelSpeeds object containing the speeds in mm/s.
    */
   WheelSpeeds computeSpeedsMmps(const WheelSpeeds& wheel_speeds_rpm) const;
 
+  /**
+   * @brief Batch version of computeWheelSpeeds followed by computeSpeedsRpm.
+   * Samples are passed as separate arrays (struct of arrays) so the loop can
+   * be vectorised by the compiler. Input and output arrays must not overlap.
+   * @param linear_mmps Array of linear speeds in millimeters per second.
+   * @param angular_rad Array of angular speeds in radians per second.
+   * @param out_left_rpm Array to store the left wheel speeds in RPM.
+   * @param out_right_rpm Array to store the right wheel speeds in RPM.
+   * @param count Number of samples in each array.
+   */
+  void computeWheelSpeedsRpm(const float* linear_mmps,
+                             const float* angular_rad,
+                             float* out_left_rpm,
+                             float* out_right_rpm,
+                             const size_t count) const;
+
+  /**
+   * @brief Same as above but stores the wheel speeds rounded to integer RPM,
+   * ready to be sent with moveRpm. Halves the memory used by a precomputed
+   * motion profile on the robot.
+   * @param linear_mmps Array of linear speeds in millimeters per second.
+   * @param angular_rad Array of angular speeds in radians per second.
+   * @param out_left_rpm Array to store the left wheel speeds in RPM.
+   * @param out_right_rpm Array to store the right wheel speeds in RPM.
+   * @param count Number of samples in each array.
+   */
+  void computeWheelSpeedsRpm(const float* linear_mmps,
+                             const float* angular_rad,
+                             int16_t* out_left_rpm,
+                             int16_t* out_right_rpm,
+                             const size_t count) const;
+
+  /**
+   * @brief Batch version of computeSpeedsMmps followed by computePoseSpeeds.
+   * Input and output arrays must not overlap.
+   * @param left_rpm Array of left wheel speeds in RPM.
+   * @param right_rpm Array of right wheel speeds in RPM.
+   * @param out_linear_mmps Array to store the linear speeds in millimeters
+   * per second.
+   * @param out_angular_rad Array to store the angular speeds in radians per
+   * second.
+   * @param count Number of samples in each array.
+   */
+  void computePoseSpeedsFromRpm(const float* left_rpm,
+                                const float* right_rpm,
+                                float* out_linear_mmps,
+                                float* out_angular_rad,
+                                const size_t count) const;
+
+  /**
+   * @brief Computes the bearing of the line seen by the line sensor, from the
+   * middle of the wheel axle.
+   * @param line_position Line position in the range [-100, 100], as returned
+   * by BnrOneAPlus::readLine(), positive when the line is on the right.
+   * @return Bearing in radians, positive when the line is on the left.
+   */
+  float computeLineBearingRad(const int line_position) const;
+
  private:
-  float axis_length_mm_;      ///< Axis length in millimeters.
-  float wheel_diameter_mm_;   ///< Wheel diameter in millimeters.
-  int pulses_per_rev_;        ///< Number of pulses per revolution.
-  float max_speed_mmps_;      ///< Maximum speed in millimeters per second.
-  float min_speed_mmps_;      ///< Minimum speed in millimeters per second.
-  float spot_rotation_delta;  ///< Correction for spot rotations.
+  float axis_length_mm_;           ///< Axis length in millimeters.
+  float wheel_diameter_mm_;        ///< Mean wheel diameter in millimeters.
+  float left_wheel_diameter_mm_;   ///< Left wheel diameter in millimeters.
+  float right_wheel_diameter_mm_;  ///< Right wheel diameter in millimeters.
+  int pulses_per_rev_;             ///< Number of pulses per revolution.
+  float max_speed_mmps_;           ///< Maximum speed in millimeters per second.
+  float min_speed_mmps_;           ///< Minimum speed in millimeters per second.
+  float spot_rotation_delta;       ///< Correction for spot rotations.
 };
@@ -0,0 +1,15 @@
+#include "EepromUtils.h"
+
+#include <EEPROM.h>  // EEPROM reading and writing
+
+void saveEepromWord(const int eeprom_address, const int value) {
+  EEPROM.update(eeprom_address, highByte(value));
+  EEPROM.update(eeprom_address + 1, lowByte(value));
+}
+
+int loadEepromWord(const int eeprom_address) {
+  int value = (int)EEPROM.read(eeprom_address);
+  value = (value << 8);
+  value += (int)EEPROM.read(eeprom_address + 1);
+  return value;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Helpers to store 16 bit values in EEPROM, high byte first as in
+ * Config. Bytes are only written when they change, to spare EEPROM wear.
+ */
+
+/**
+ * @brief Saves a word in EEPROM.
+ * @param eeprom_address Address of the high byte.
+ * @param value Value to save.
+ */
+void saveEepromWord(const int eeprom_address, const int value);
+
+/**
+ * @brief Loads a word from EEPROM.
+ * @param eeprom_address Address of the high byte.
+ * @return Value loaded.
+ */
+int loadEepromWord(const int eeprom_address);
@@ -0,0 +1,40 @@
+#include "EncoderAccumulator.h"
+
+EncoderAccumulator::EncoderAccumulator(const BnrOneAPlus& one)
+    : one_(one), left_raw_(0), right_raw_(0), left_count_(0), right_count_(0) {}
+
+void EncoderAccumulator::reset() {
+  left_raw_ = one_.readIncrementalLeftEncoder();
+  right_raw_ = one_.readIncrementalRightEncoder();
+  clear();
+}
+
+void EncoderAccumulator::clear() {
+  left_count_ = 0;
+  right_count_ = 0;
+}
+
+void EncoderAccumulator::update() {
+  const int left_raw = one_.readIncrementalLeftEncoder();
+  const int right_raw = one_.readIncrementalRightEncoder();
+  addDeltas(wrapSafeDelta(left_raw, left_raw_),
+            wrapSafeDelta(right_raw, right_raw_));
+  left_raw_ = left_raw;
+  right_raw_ = right_raw;
+}
+
+void EncoderAccumulator::addDeltas(const int left_pulses,
+                                   const int right_pulses) {
+  left_count_ += left_pulses;
+  right_count_ += right_pulses;
+}
+
+long EncoderAccumulator::getLeft() const { return left_count_; }
+
+long EncoderAccumulator::getRight() const { return right_count_; }
+
+int16_t EncoderAccumulator::wrapSafeDelta(const int raw,
+                                          const int previous_raw) const {
+  // Counters are 16 bit on the co-processor regardless of the size of int
+  return (int16_t)((uint16_t)raw - (uint16_t)previous_raw);
+}
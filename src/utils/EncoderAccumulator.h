@@ -0,0 +1,76 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+/**
+ * @class EncoderAccumulator
+ * @brief Extends the 16 bit incremental encoder counters of the co-processor
+ * to 32 bits.
+ *
+ * Every update reads both incremental counters and adds the difference to the
+ * previous reading to a 32 bit total. The difference is computed in 16 bit
+ * arithmetic so it stays correct when a counter wraps around. The encoders are
+ * never reset, so distances are obtained by diffing accumulated counts.
+ *
+ * update() must be called before a wheel travels 32767 pulses, i.e. at least
+ * every ~2.9 s at 300 rpm.
+ */
+class EncoderAccumulator {
+ public:
+  /**
+   * @brief Constructor for EncoderAccumulator.
+   * @param one Reference to BnrOneAPlus object.
+   */
+  EncoderAccumulator(const BnrOneAPlus& one);
+
+  /**
+   * @brief Synchronises with the current value of the counters and sets the
+   * accumulated counts to zero. No reset command is sent to the robot.
+   */
+  void reset();
+
+  /**
+   * @brief Sets the accumulated counts to zero without reading the counters.
+   * Use when the counts are fed with addDeltas only.
+   */
+  void clear();
+
+  /**
+   * @brief Reads both incremental counters and accumulates the pulses counted
+   * since the previous update.
+   */
+  void update();
+
+  /**
+   * @brief Accumulates pulses obtained from another source, e.g. the readings
+   * returned by moveRpmGetEncoders or readAndResetEncoders.
+   * @param left_pulses Left encoder pulses.
+   * @param right_pulses Right encoder pulses.
+   */
+  void addDeltas(const int left_pulses, const int right_pulses);
+
+  /**
+   * @brief Gets the accumulated count of the left encoder.
+   * @return Pulses since the last reset.
+   */
+  long getLeft() const;
+
+  /**
+   * @brief Gets the accumulated count of the right encoder.
+   * @return Pulses since the last reset.
+   */
+  long getRight() const;
+
+ private:
+  /**
+   * @brief Computes the signed difference between two 16 bit counter
+   * readings, taking wrap-around into account.
+   */
+  int16_t wrapSafeDelta(const int raw, const int previous_raw) const;
+
+  const BnrOneAPlus& one_;  ///< Reference to BnrOneAPlus object.
+  int left_raw_;            ///< Last reading of the left counter.
+  int right_raw_;           ///< Last reading of the right counter.
+  long left_count_;         ///< Accumulated left pulses.
+  long right_count_;        ///< Accumulated right pulses.
+};
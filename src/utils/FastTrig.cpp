@@ -0,0 +1,122 @@
+#include "FastTrig.h"
+
+#define RAD_TO_BRAD 10430.378350470453f   // 32768 / PI
+#define BRAD_TO_RAD 9.587379924285257e-5f  // PI / 32768
+#define QUARTER_TURN 0x4000
+#define HALF_TURN 0x8000L
+#define RATIO_BITS 14  // atan table index (6 bits) + interpolation (8 bits)
+
+namespace {
+// sin(i * pi / 128) in Q15 for i in [0, 64] (first quarter of the wave)
+const int16_t kSineTable[65] PROGMEM = {
+    0,     804,   1608,  2410,  3212,  4011,  4808,  5602,  6393,  7179,
+    7962,  8739,  9512,  10278, 11039, 11793, 12539, 13279, 14010, 14732,
+    15446, 16151, 16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403,
+    22005, 22594, 23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+    27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956, 30273, 30571,
+    30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+    32609, 32678, 32728, 32757, 32767};
+
+// atan(i / 64) in brads for i in [0, 64] (first octant)
+const int16_t kAtanTable[65] PROGMEM = {
+    0,    163,  326,  489,  651,  813,  975,  1136, 1297, 1457, 1617, 1775,
+    1933, 2090, 2246, 2401, 2555, 2708, 2860, 3010, 3159, 3307, 3453, 3599,
+    3742, 3884, 4025, 4164, 4302, 4438, 4572, 4705, 4836, 4966, 5094, 5220,
+    5344, 5467, 5589, 5708, 5826, 5943, 6058, 6171, 6282, 6392, 6500, 6607,
+    6712, 6815, 6917, 7018, 7117, 7214, 7310, 7405, 7498, 7589, 7679, 7768,
+    7856, 7942, 8026, 8110, 8192};
+
+/**
+ * @brief Reads a table entry and interpolates towards the next one.
+ * @param table PROGMEM table with 65 entries.
+ * @param position index in the upper 6 bits, fraction in the lower 8 bits.
+ */
+int16_t interpolate(const int16_t* table, const uint16_t position) {
+  const uint8_t index = position >> 8;
+  const uint8_t fraction = position & 0xFF;
+  const int16_t y0 = (int16_t)pgm_read_word(&table[index]);
+  if (fraction == 0) {
+    return y0;
+  }
+  const int16_t y1 = (int16_t)pgm_read_word(&table[index + 1]);
+  return y0 + (int16_t)(((long)(y1 - y0) * fraction + 128) >> 8);
+}
+
+/**
+ * @brief Maps the first octant angle back to the quadrant given by the signs
+ * of the original vector.
+ * @return Angle in brads in the range [-32768, 32768].
+ */
+long unfoldOctant(const int16_t octant_angle,
+                  const bool swapped,
+                  const bool x_negative,
+                  const bool y_negative) {
+  long angle = swapped ? (QUARTER_TURN - octant_angle) : octant_angle;
+  if (x_negative) {
+    angle = HALF_TURN - angle;
+  }
+  return y_negative ? -angle : angle;
+}
+}  // namespace
+
+int16_t sinQ15(const uint16_t angle_brad) {
+  uint16_t position = angle_brad & (QUARTER_TURN - 1);
+  if (angle_brad & QUARTER_TURN) {
+    position = QUARTER_TURN - position;  // mirror on the second quarter
+  }
+  const int16_t value = interpolate(kSineTable, position);
+  return (angle_brad & HALF_TURN) ? -value : value;
+}
+
+int16_t cosQ15(const uint16_t angle_brad) {
+  return sinQ15(angle_brad + QUARTER_TURN);
+}
+
+int16_t atan2Brad(const long y, const long x) {
+  unsigned long abs_x = (x < 0) ? -x : x;
+  unsigned long abs_y = (y < 0) ? -y : y;
+  const bool swapped = abs_y > abs_x;
+  unsigned long numerator = swapped ? abs_x : abs_y;
+  unsigned long denominator = swapped ? abs_y : abs_x;
+  if (denominator == 0) {
+    return 0;
+  }
+  // Keep the shifted numerator within 32 bits
+  while (denominator >= (1UL << (32 - RATIO_BITS))) {
+    numerator >>= 1;
+    denominator >>= 1;
+  }
+  const uint16_t ratio = (numerator << RATIO_BITS) / denominator;
+  const int16_t octant_angle = interpolate(kAtanTable, ratio);
+  return (int16_t)unfoldOctant(octant_angle, swapped, x < 0, y < 0);
+}
+
+uint16_t radToBrad(const float angle_rad) {
+  const float brads = angle_rad * RAD_TO_BRAD;
+  return (uint16_t)(long)(brads + ((brads >= 0) ? 0.5f : -0.5f));
+}
+
+float bradToRad(const int16_t angle_brad) { return angle_brad * BRAD_TO_RAD; }
+
+float fastSin(const float angle_rad) {
+  return sinQ15(radToBrad(angle_rad)) / (float)Q15_ONE;
+}
+
+float fastCos(const float angle_rad) {
+  return cosQ15(radToBrad(angle_rad)) / (float)Q15_ONE;
+}
+
+float fastAtan2(const float y, const float x) {
+  const float abs_x = fabs(x);
+  const float abs_y = fabs(y);
+  const bool swapped = abs_y > abs_x;
+  const float numerator = swapped ? abs_x : abs_y;
+  const float denominator = swapped ? abs_y : abs_x;
+  if (denominator == 0) {
+    return 0;
+  }
+  const uint16_t ratio =
+      (uint16_t)((numerator / denominator) * (1 << RATIO_BITS) + 0.5f);
+  const int16_t octant_angle = interpolate(kAtanTable, ratio);
+  return unfoldOctant(octant_angle, swapped, x < 0, y < 0) * BRAD_TO_RAD;
+}
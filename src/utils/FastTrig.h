@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @brief Fixed-point trigonometry for the control loops.
+ *
+ * Angles are expressed as binary angles (brads) where a full turn is 65536,
+ * so wrapping around is free and a signed 16 bit brad spans [-pi, pi[.
+ * Sine and cosine values are returned in Q15 (32767 represents 1.0).
+ *
+ * The sine and arctangent are read from 65 entry tables stored in PROGMEM and
+ * interpolated linearly between entries, which costs a couple of integer
+ * multiplications instead of a soft-float series expansion.
+ *
+ * Error bounds (measured against libm over a full turn):
+ *  - sinQ15 / cosQ15:     |error| <= 4 LSB (1.2e-4)
+ *  - fastSin / fastCos:   |error| <= 1.2e-4 (includes the rad -> brad
+ *                         rounding)
+ *  - atan2Brad:           |error| <= 2 brads (1.9e-4 rad)
+ *  - fastAtan2:           |error| <= 1.3e-4 rad
+ */
+
+#define BRADS_PER_TURN 65536L
+#define Q15_ONE 32767
+
+/**
+ * @brief Computes the sine of a binary angle.
+ * @param angle_brad Angle in brads (65536 brads per turn).
+ * @return Sine of the angle in Q15.
+ */
+int16_t sinQ15(const uint16_t angle_brad);
+
+/**
+ * @brief Computes the cosine of a binary angle.
+ * @param angle_brad Angle in brads (65536 brads per turn).
+ * @return Cosine of the angle in Q15.
+ */
+int16_t cosQ15(const uint16_t angle_brad);
+
+/**
+ * @brief Computes the angle of the vector (x, y).
+ * @param y y component (any integer scale, same as x).
+ * @param x x component (any integer scale, same as y).
+ * @return Angle in brads in the range [-32768, 32767], i.e. [-pi, pi[.
+ */
+int16_t atan2Brad(const long y, const long x);
+
+/**
+ * @brief Converts an angle in radians to brads.
+ * @param angle_rad Angle in radians.
+ * @return Angle in brads, wrapped to one turn.
+ */
+uint16_t radToBrad(const float angle_rad);
+
+/**
+ * @brief Converts an angle in brads to radians.
+ * @param angle_brad Angle in signed brads.
+ * @return Angle in radians in the range [-pi, pi[.
+ */
+float bradToRad(const int16_t angle_brad);
+
+/**
+ * @brief Table based replacement for sin().
+ * @param angle_rad Angle in radians.
+ * @return Sine of the angle.
+ */
+float fastSin(const float angle_rad);
+
+/**
+ * @brief Table based replacement for cos().
+ * @param angle_rad Angle in radians.
+ * @return Cosine of the angle.
+ */
+float fastCos(const float angle_rad);
+
+/**
+ * @brief Table based replacement for atan2().
+ * @param y y component.
+ * @param x x component.
+ * @return Angle of the vector (x, y) in radians in the range [-pi, pi].
+ */
+float fastAtan2(const float y, const float x);
@@ -0,0 +1,188 @@
+#include "LapLearner.h"
+
+#define MIN_LAP_LENGTH_MM 1000   // Shortest lap accepted
+#define LAP_CLOSURE_MM 200       // Distance to the start to close a lap
+#define LAP_CLOSURE_COS 0.7      // Cosine of the heading error to close a lap
+#define HEADING_UNITS_PER_DEG 2  // Heading changes are stored in 0.5 deg
+#define SPEED_UNIT_MMPS 10       // Bin speeds are stored in 10 mm/s
+
+LapLearner::LapLearner(const RobotParams& robot_params)
+    : cut_(ControlUtils(robot_params)),
+      track_width_mm_(robot_params.track_width_mm),
+      max_accel_mmps2_(robot_params.max_accel_mmps2),
+      learning_speed_mmps_(300),
+      max_speed_mmps_(1000),
+      max_lateral_accel_mmps2_(robot_params.max_lateral_accel_mmps2),
+      min_speed_mmps_(100),
+      num_bins_(0),
+      learning_(true),
+      error_(false),
+      lap_count_(0),
+      pose_(Pose()),
+      lap_distance_mm_(0),
+      bin_distance_mm_(0),
+      bin_heading_rad_(0),
+      bin_start_bearing_rad_(0),
+      line_bearing_rad_(0) {}
+
+void LapLearner::setSpeedLimits(const float learning_speed_mmps,
+                                const float max_speed_mmps,
+                                const float max_lateral_accel_mmps2,
+                                const float min_speed_mmps) {
+  learning_speed_mmps_ = abs(learning_speed_mmps);
+  max_speed_mmps_ = abs(max_speed_mmps);
+  max_lateral_accel_mmps2_ = abs(max_lateral_accel_mmps2);
+  min_speed_mmps_ = min(abs(min_speed_mmps), max_speed_mmps_);
+}
+
+void LapLearner::start() {
+  num_bins_ = 0;
+  learning_ = true;
+  error_ = false;
+  lap_count_ = 0;
+  pose_ = Pose();
+  lap_distance_mm_ = 0;
+  bin_distance_mm_ = 0;
+  bin_heading_rad_ = 0;
+  bin_start_bearing_rad_ = line_bearing_rad_;
+}
+
+void LapLearner::update(const int left_pulses,
+                        const int right_pulses,
+                        const int line_position) {
+  const float left_mm = cut_.computeLeftDistanceFromPulses(left_pulses);
+  const float right_mm = cut_.computeRightDistanceFromPulses(right_pulses);
+  const float distance_mm = (left_mm + right_mm) / 2.0;
+  const float delta_theta_rad = (right_mm - left_mm) / track_width_mm_;
+  pose_.updatePose(distance_mm, delta_theta_rad);
+  lap_distance_mm_ += distance_mm;
+  line_bearing_rad_ = cut_.computeLineBearingRad(line_position);
+
+  if (learning_) {
+    bin_distance_mm_ += distance_mm;
+    bin_heading_rad_ += delta_theta_rad;
+    if (bin_distance_mm_ >= LAP_BIN_LENGTH_MM) {
+      closeBin();
+    }
+  }
+
+  if (error_) return;
+  if (lap_distance_mm_ >= MIN_LAP_LENGTH_MM && isBackAtStart()) {
+    closeLap();
+  } else if (!learning_ &&
+             lap_distance_mm_ > getLapLengthMm() + LAP_CLOSURE_MM) {
+    // The start was missed, so the lap is closed where it should have been
+    lap_distance_mm_ -= getLapLengthMm();
+    ++lap_count_;
+    pose_ = Pose();
+  }
+}
+
+void LapLearner::markLap() {
+  if (!error_ && lap_distance_mm_ >= MIN_LAP_LENGTH_MM) {
+    closeLap();
+  }
+}
+
+float LapLearner::getSpeedMmps() const {
+  if (learning_ || error_) return learning_speed_mmps_;
+
+  const int bin = (int)(lap_distance_mm_ / LAP_BIN_LENGTH_MM);
+  if (bin < 0 || bin >= num_bins_) return min_speed_mmps_;
+  // The position from odometry is uncertain, so the speed of the next bin
+  // is also respected
+  const byte speed = min(speed_[bin], speed_[getNextBin(bin)]);
+  return max(min_speed_mmps_, (float)speed * SPEED_UNIT_MMPS);
+}
+
+bool LapLearner::isLearning() const { return learning_; }
+
+bool LapLearner::hasError() const { return error_; }
+
+int LapLearner::getLapCount() const { return lap_count_; }
+
+float LapLearner::getLapLengthMm() const {
+  if (learning_ || error_) return 0;
+  return num_bins_ * (float)LAP_BIN_LENGTH_MM;
+}
+
+void LapLearner::closeBin() {
+  // The track turns as much as the robot plus the change of the bearing of
+  // the line seen by the sensor
+  const float track_turn_rad =
+      bin_heading_rad_ + (line_bearing_rad_ - bin_start_bearing_rad_);
+  bin_start_bearing_rad_ = line_bearing_rad_;
+  bin_distance_mm_ -= LAP_BIN_LENGTH_MM;
+  bin_heading_rad_ = 0;
+
+  // A partial map would schedule the speeds of the wrong bins
+  if (num_bins_ >= MAX_LAP_BINS) {
+    learning_ = false;
+    error_ = true;
+    num_bins_ = 0;
+    return;
+  }
+  const int heading_change =
+      (int)round(degrees(track_turn_rad) * HEADING_UNITS_PER_DEG);
+  heading_change_[num_bins_] = (int8_t)constrain(heading_change, -127, 127);
+  ++num_bins_;
+}
+
+bool LapLearner::isBackAtStart() const {
+  // The start is crossed when the robot passes the line through the start
+  // position perpendicular to the start heading
+  return pose_.getXMm() >= 0 && pose_.getXMm() < LAP_CLOSURE_MM &&
+         abs(pose_.getYMm()) < LAP_CLOSURE_MM &&
+         cos(pose_.getThetaRad()) > LAP_CLOSURE_COS;
+}
+
+void LapLearner::closeLap() {
+  if (learning_) {
+    if (bin_distance_mm_ >= LAP_BIN_LENGTH_MM / 2) {
+      closeBin();
+    }
+    if (error_ || num_bins_ == 0) return;
+    learning_ = false;
+    buildSpeedMap();
+  }
+  ++lap_count_;
+  pose_ = Pose();
+  lap_distance_mm_ = 0;
+}
+
+void LapLearner::buildSpeedMap() {
+  // Speed allowed by the lateral acceleration on the curvature of each bin
+  for (int i = 0; i < num_bins_; ++i) {
+    const float turn_rad =
+        radians(abs(heading_change_[i]) / (float)HEADING_UNITS_PER_DEG);
+    const float curvature = turn_rad / LAP_BIN_LENGTH_MM;
+    float speed = max_speed_mmps_;
+    if (curvature > 0) {
+      speed = min(speed, (float)sqrt(max_lateral_accel_mmps2_ / curvature));
+    }
+    speed_[i] = (byte)constrain(speed / SPEED_UNIT_MMPS, 0, 255);
+  }
+
+  // Braking before slower bins and accelerating after them. The lap is
+  // closed, so the passes go around it twice to cross the start.
+  const float speed_change_sq = 2.0 * max_accel_mmps2_ * LAP_BIN_LENGTH_MM;
+  for (int pass = 0; pass < 2 * num_bins_; ++pass) {
+    const int bin = num_bins_ - 1 - (pass % num_bins_);
+    const float next_speed = speed_[getNextBin(bin)] * SPEED_UNIT_MMPS;
+    const float braking_speed =
+        sqrt(next_speed * next_speed + speed_change_sq) / SPEED_UNIT_MMPS;
+    speed_[bin] = (byte)min((float)speed_[bin], braking_speed);
+  }
+  for (int pass = 0; pass < 2 * num_bins_; ++pass) {
+    const int bin = pass % num_bins_;
+    const float speed = speed_[bin] * SPEED_UNIT_MMPS;
+    const float accel_speed =
+        sqrt(speed * speed + speed_change_sq) / SPEED_UNIT_MMPS;
+    const int next_bin = getNextBin(bin);
+    speed_[next_bin] = (byte)min((float)speed_[next_bin], accel_speed);
+  }
+}
+
+int LapLearner::getNextBin(const int bin) const {
+  return (bin + 1 < num_bins_) ? bin + 1 : 0;
+}
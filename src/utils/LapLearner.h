@@ -0,0 +1,153 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "ControlUtils.h"
+#include "RobotParams.h"
+
+#define LAP_BIN_LENGTH_MM 100  // Length of track of each curvature map entry
+#define MAX_LAP_BINS 120       // Longest track mapped, in bins (12 m)
+
+/**
+ * @class LapLearner
+ * @brief Learns the curvature of a closed line following track during the
+ * first lap and schedules the speed of the following laps.
+ *
+ * During the first lap the robot follows the line at a cautious learning
+ * speed. The heading change of the track along every LAP_BIN_LENGTH_MM is
+ * estimated from odometry, corrected with the change of the bearing of the
+ * line seen by the sensor, as in SpeedGovernor. The lap is closed when the
+ * robot returns to the start position and heading, or when markLap() is
+ * called, e.g. on a start line.
+ * Tracks longer than the map are not learned: learning stops with an error
+ * and the robot keeps the learning speed.
+ *
+ * On the following laps the speed of each bin is limited by the lateral
+ * acceleration on its curvature, and by the acceleration and braking
+ * distances to the neighbouring bins, so the robot is fast on straights and
+ * brakes before the known curves. The steering is still done by the caller
+ * from the line position.
+ */
+class LapLearner {
+ public:
+  /**
+   * @brief Constructor for LapLearner.
+   * @param robot_params Robot params, including the lateral acceleration
+   * limit.
+   */
+  LapLearner(const RobotParams& robot_params = RobotParams());
+
+  /**
+   * @brief Sets the speed limits.
+   * @param learning_speed_mmps Speed of the first lap.
+   * @param max_speed_mmps Speed on straights.
+   * @param max_lateral_accel_mmps2 Maximum lateral acceleration, which limits
+   * the speed on curves.
+   * @param min_speed_mmps Lowest speed.
+   */
+  void setSpeedLimits(const float learning_speed_mmps,
+                      const float max_speed_mmps,
+                      const float max_lateral_accel_mmps2,
+                      const float min_speed_mmps = 100);
+
+  /**
+   * @brief Forgets the learned track and starts learning a new lap from the
+   * current position.
+   */
+  void start();
+
+  /**
+   * @brief Updates the odometry, the curvature map and the lap count. Call
+   * every control cycle.
+   * @param left_pulses Left encoder pulses since the previous update.
+   * @param right_pulses Right encoder pulses since the previous update.
+   * @param line_position Line position in the range [-100, 100], as returned
+   * by BnrOneAPlus::readLine(), positive when the line is on the right.
+   */
+  void update(const int left_pulses,
+              const int right_pulses,
+              const int line_position);
+
+  /**
+   * @brief Closes the lap at the current position, e.g. when a start line is
+   * detected. Laps are also closed automatically from odometry.
+   */
+  void markLap();
+
+  /**
+   * @brief Gets the speed to drive at the current position.
+   * @return Speed in millimeters per second.
+   */
+  float getSpeedMmps() const;
+
+  /**
+   * @brief Checks if the first lap is still being learned.
+   */
+  bool isLearning() const;
+
+  /**
+   * @brief Checks if learning stopped because the track is longer than
+   * MAX_LAP_BINS bins.
+   */
+  bool hasError() const;
+
+  /**
+   * @brief Gets the number of laps completed since start().
+   */
+  int getLapCount() const;
+
+  /**
+   * @brief Gets the length of the learned lap.
+   * @return Length in millimeters, 0 while learning.
+   */
+  float getLapLengthMm() const;
+
+ private:
+  /**
+   * @brief Closes the bin in progress and stores its heading change. Stops
+   * learning with an error if the map is full.
+   */
+  void closeBin();
+
+  /**
+   * @brief Checks if the robot is back at the start position and heading.
+   */
+  bool isBackAtStart() const;
+
+  /**
+   * @brief Closes the lap in progress, building the speed map at the end of
+   * the first lap.
+   */
+  void closeLap();
+
+  /**
+   * @brief Computes the speed of every bin from the curvature map.
+   */
+  void buildSpeedMap();
+
+  /**
+   * @brief Gets the index of the bin after the given one, wrapping around
+   * the end of the lap.
+   */
+  int getNextBin(const int bin) const;
+
+  ControlUtils cut_;                     ///< Control utils object
+  float track_width_mm_;                 ///< Effective track width.
+  float max_accel_mmps2_;                ///< Maximum acceleration.
+  float learning_speed_mmps_;            ///< Speed of the first lap.
+  float max_speed_mmps_;                 ///< Speed on straights.
+  float max_lateral_accel_mmps2_;        ///< Maximum lateral acceleration.
+  float min_speed_mmps_;                 ///< Lowest speed.
+  int8_t heading_change_[MAX_LAP_BINS];  ///< Track turn per bin, 0.5 deg.
+  byte speed_[MAX_LAP_BINS];             ///< Speed per bin, 10 mm/s units.
+  int num_bins_;                         ///< Bins of the lap.
+  bool learning_;                        ///< Whether learning the first lap.
+  bool error_;                           ///< Whether the map overflowed.
+  int lap_count_;                        ///< Laps completed.
+  Pose pose_;                            ///< Pose relative to the lap start.
+  float lap_distance_mm_;                ///< Distance since the lap start.
+  float bin_distance_mm_;                ///< Distance since the bin start.
+  float bin_heading_rad_;                ///< Robot turn since the bin start.
+  float bin_start_bearing_rad_;          ///< Line bearing at the bin start.
+  float line_bearing_rad_;               ///< Line bearing of the last update.
+};
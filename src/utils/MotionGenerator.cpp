@@ -1,5 +1,6 @@
 #include "MotionGenerator.h"
 
+#include <BnrCompass.h>
 #include <BnrOneAPlus.h>
 
 #include "ControlUtils.h"
@@ -7,16 +8,76 @@
 #define STRAIGHT_MOTION 32767
 #define TICKS_LEFT_LOW_SPEED 4000
 #define MIN_SPEED_MMPS 80
+#define CONTROL_PERIOD_US 5000
+#define PROFILE_MIN_SPEED_MMPS 30
+#define JUNCTION_SPEED_STEP_MMPS 60  // Highest wheel speed step at junctions
+#define MIN_SPIRAL_RADIUS_MM 0.1
+#define MAX_HEADING_CORRECTION 0.2  // Fraction of the speed used to steer
+
+namespace {
+MotionSegment segmentFromArray(const int index, const void* segments) {
+  return static_cast<const MotionSegment*>(segments)[index];
+}
+}  // namespace
+
+MotionSegment::MotionSegment(const float distance_mm_in,
+                             const float angle_deg_in,
+                             const float radius_of_curvature_mm_in,
+                             const float speed_in)
+    : distance_mm(distance_mm_in),
+      angle_deg(angle_deg_in),
+      radius_of_curvature_mm(radius_of_curvature_mm_in),
+      speed(speed_in) {}
+
+MotionSegment MotionSegment::straight(const float distance_mm,
+                                      const float speed) {
+  return MotionSegment(distance_mm, 0, 0, speed);
+}
+
+MotionSegment MotionSegment::arc(const float angle_deg,
+                                 const float radius_of_curvature_mm,
+                                 const float speed) {
+  return MotionSegment(0, angle_deg, radius_of_curvature_mm, speed);
+}
+
+MotionSegment MotionSegment::rotation(const float angle_deg,
+                                      const float speed) {
+  return MotionSegment(0, angle_deg, 0, speed);
+}
+
+bool MotionSegment::isStraight() const { return angle_deg == 0; }
+
+float MotionSegment::getLengthMm() const {
+  if (isStraight()) return abs(distance_mm);
+  return abs(radius_of_curvature_mm * radians(angle_deg));
+}
+
+float MotionSegment::getCurvature() const {
+  if (isStraight() || radius_of_curvature_mm == 0) return 0;
+  const float curvature = 1.0 / abs(radius_of_curvature_mm);
+  return (angle_deg > 0) ? curvature : -curvature;
+}
 
 MotionGenerator::MotionGenerator(const BnrOneAPlus& one,
                                  const float slip_factor,
                                  const RobotParams& robot_params)
     : one_(one),
       slip_factor_(slip_factor),
-      axis_length_mm_(robot_params.axis_length_mm),
-      cut_(ControlUtils(robot_params)) {}
-
-void MotionGenerator::resetEncoders() const { one_.resetEncoders(); }
+      axis_length_mm_(robot_params.track_width_mm),
+      max_accel_mmps2_(robot_params.max_accel_mmps2),
+      max_jerk_mmps3_(robot_params.max_jerk_mmps3),
+      profile_type_(VelocityProfile::Type::NONE),
+      cut_(ControlUtils(robot_params)),
+      motion_(createMotion(0, 0, 1, STRAIGHT_MOTION, 0)),
+      encoders_(one),
+      queue_(nullptr),
+      queue_size_(0),
+      num_queued_(0),
+      heading_gain_(0),
+      compass_(nullptr),
+      compass_weight_(0),
+      slip_monitor_(nullptr),
+      abort_when_blocked_(true) {}
 
 PoseSpeeds MotionGenerator::computePoseSpeeds(
     const float speed,
@@ -56,39 +117,429 @@ PoseSpeeds MotionGenerator::maybeSlowDown(const PoseSpeeds& pose_speeds,
   return pose_speeds;
 }
 
-void MotionGenerator::moveAndSlowDown(const long int total_pulses,
-                                      const float speed,
-                                      const int direction,
-                                      const float radius_of_curvature_mm,
-                                      const long int slow_down_thresh) const {
-  auto pose_speeds =
+MotionGenerator::Motion MotionGenerator::createMotion(
+    const long int total_pulses,
+    const float speed,
+    const int direction,
+    const float radius_of_curvature_mm,
+    const long int slow_down_thresh) const {
+  Motion motion;
+  motion.total_pulses = total_pulses;
+  motion.speed = speed;
+  motion.direction = direction;
+  motion.radius_of_curvature_mm = radius_of_curvature_mm;
+  motion.slow_down_thresh = slow_down_thresh;
+  motion.pose_speeds =
       computePoseSpeeds(speed, radius_of_curvature_mm, direction);
+  motion.encoder_count = 0;
+  motion.running = false;
+  motion.last_step_us = 0;
+  motion.exit_speed = 0;
+  motion.carried_pulses = 0;
+  motion.curve = Curve::NONE;
+  motion.curve_start = 0;
+  motion.curve_end = 0;
+  motion.curve_target = 0;
+  motion.curve_length_mm = 0;
+  motion.heading_rad = 0;
+  motion.encoder_heading_rad = 0;
+  motion.heading_integral = 0;
+  motion.start_bearing_deg = -1;
+  // Distance travelled by the wheels, in the same units as the encoder
+  // counts so the slip factor cancels out
+  motion.profile = VelocityProfile(profile_type_,
+                                   pulsesToMm(total_pulses),
+                                   speed,
+                                   max_accel_mmps2_,
+                                   max_jerk_mmps3_,
+                                   PROFILE_MIN_SPEED_MMPS);
+  return motion;
+}
 
-  long int encoder_count = 0;
+MotionGenerator::Motion MotionGenerator::planSpiral(
+    const float angle_deg,
+    const float speed,
+    const float start_radius_mm,
+    const float end_radius_mm,
+    const bool geometric) const {
+  const float start_mm = abs(start_radius_mm);
+  const float end_mm = abs(end_radius_mm);
+  const float angle_rad = abs(radians(angle_deg));
+  Motion motion =
+      createMotion(0, abs(speed), getSign(angle_deg), start_mm, 0);
+  motion.curve_start = start_mm;
+  motion.curve_end = end_mm;
+  motion.curve_target = angle_rad / slip_factor_;
+  if (geometric && start_mm > 0 && end_mm > 0 && start_mm != end_mm) {
+    motion.curve = Curve::GEOMETRIC_SPIRAL;
+    motion.curve_length_mm =
+        angle_rad * (end_mm - start_mm) / log(end_mm / start_mm);
+  } else {
+    motion.curve = Curve::LINEAR_SPIRAL;
+    motion.curve_length_mm = angle_rad * (start_mm + end_mm) / 2.0;
+  }
+  motion.profile = VelocityProfile(profile_type_,
+                                   motion.curve_length_mm,
+                                   motion.speed,
+                                   max_accel_mmps2_,
+                                   max_jerk_mmps3_,
+                                   PROFILE_MIN_SPEED_MMPS);
+  return motion;
+}
+
+MotionGenerator::Motion MotionGenerator::planClothoid(
+    const float distance,
+    const float speed,
+    const float start_curvature,
+    const float end_curvature) const {
+  Motion motion = createMotion(0, abs(speed), 1, STRAIGHT_MOTION, 0);
+  motion.curve = Curve::CLOTHOID;
+  motion.curve_start = start_curvature;
+  motion.curve_end = end_curvature;
+  motion.curve_target = abs(distance) / slip_factor_;
+  motion.curve_length_mm = abs(distance);
+  motion.profile = VelocityProfile(profile_type_,
+                                   motion.curve_length_mm,
+                                   motion.speed,
+                                   max_accel_mmps2_,
+                                   max_jerk_mmps3_,
+                                   PROFILE_MIN_SPEED_MMPS);
+  return motion;
+}
 
-  while (encoder_count < total_pulses) {
-    int left_encoder = one_.readAndResetLeftEncoder();
-    int right_encoder = one_.readAndResetRightEncoder();
-    encoder_count += (long int)((abs(left_encoder) + abs(right_encoder)) / 2);
-    long int pulses_remaining = round(total_pulses - encoder_count);
+MotionGenerator::Motion MotionGenerator::planSegment(
+    const MotionSegment& segment,
+    const float entry_speed,
+    const float exit_speed) const {
+  // Straight segments of negative length move backwards
+  const float straight_speed =
+      (segment.distance_mm < 0) ? -abs(segment.speed) : segment.speed;
+  Motion motion = segment.isStraight()
+                      ? planStraight(segment.distance_mm, straight_speed, 0)
+                      : planRotation(segment.angle_deg,
+                                     segment.speed,
+                                     segment.radius_of_curvature_mm,
+                                     0);
+  // Speeds can only be carried through junctions with a velocity profile
+  if (profile_type_ == VelocityProfile::Type::NONE) return motion;
+  motion.profile = VelocityProfile(profile_type_,
+                                   pulsesToMm(motion.total_pulses),
+                                   motion.speed,
+                                   max_accel_mmps2_,
+                                   max_jerk_mmps3_,
+                                   PROFILE_MIN_SPEED_MMPS,
+                                   entry_speed,
+                                   exit_speed);
+  motion.exit_speed = exit_speed;
+  return motion;
+}
 
-    if (pulses_remaining < 0) break;
-    auto linear_mmps = pose_speeds.getLinearMmps();
+float MotionGenerator::planExitSpeed(SegmentFunction segment_at,
+                                     const void* shape,
+                                     const int index,
+                                     const int num_segments,
+                                     const float entry_speed) const {
+  // Backward pass from a stop at the end of the look-ahead window, limiting
+  // each junction speed to what the following segment can brake from
+  const int last = min(num_segments, index + MAX_QUEUED_SEGMENTS) - 1;
+  MotionSegment next = segment_at(last, shape);
+  float exit_speed = 0;
+  for (int i = last; i > index; --i) {
+    const MotionSegment segment = segment_at(i - 1, shape);
+    const float braking_speed = sqrt(exit_speed * exit_speed +
+                                     2.0 * max_accel_mmps2_ *
+                                         next.getLengthMm());
+    exit_speed = min(braking_speed, computeJunctionSpeed(segment, next));
+    next = segment;
+  }
+  // The segment may be too short to reach it
+  const float reachable_speed = sqrt(entry_speed * entry_speed +
+                                     2.0 * max_accel_mmps2_ *
+                                         next.getLengthMm());
+  return min(exit_speed, reachable_speed);
+}
+
+float MotionGenerator::computeJunctionSpeed(const MotionSegment& from,
+                                            const MotionSegment& to) const {
+  if (from.getLengthMm() == 0 || to.getLengthMm() == 0) return 0;
+  // The robot stops to reverse
+  if ((from.distance_mm * from.speed < 0) != (to.distance_mm * to.speed < 0)) {
+    return 0;
+  }
+
+  float speed = min(abs(from.speed), abs(to.speed));
+  // A change of curvature makes the wheel speeds jump at the junction
+  const float curvature_change = abs(from.getCurvature() - to.getCurvature());
+  const float wheel_speed_step = curvature_change * axis_length_mm_ / 2.0;
+  if (wheel_speed_step * speed > JUNCTION_SPEED_STEP_MMPS) {
+    speed = JUNCTION_SPEED_STEP_MMPS / wheel_speed_step;
+  }
+  return speed;
+}
+
+void MotionGenerator::beginMotion(Motion& motion,
+                                  EncoderAccumulator& encoders) const {
+  // Counts are accumulated from the readings returned with every speed
+  // command, so stale pulses are discarded once at the start
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.readAndResetEncoders(left_encoder, right_encoder);
+  encoders.clear();
+  motion.encoder_count = 0;
+  motion.running = true;
+  motion.last_step_us = micros() - CONTROL_PERIOD_US;
+  if (slip_monitor_ != nullptr) slip_monitor_->reset();
+  beginHeadingHold(motion);
+}
+
+void MotionGenerator::continueMotion(Motion& motion,
+                                     EncoderAccumulator& encoders,
+                                     const long int carried_pulses,
+                                     const unsigned long last_step_us) const {
+  encoders.clear();
+  motion.carried_pulses = carried_pulses;
+  motion.encoder_count = carried_pulses;
+  motion.running = true;
+  motion.last_step_us = last_step_us;
+  beginHeadingHold(motion);
+}
+
+void MotionGenerator::startSegment(Motion& motion,
+                                   EncoderAccumulator& encoders,
+                                   SegmentFunction segment_at,
+                                   const void* shape,
+                                   const int index,
+                                   const int num_segments) const {
+  // Speed is carried over if the previous segment did not brake
+  const float entry_speed = motion.exit_speed;
+  const long int carried_pulses = motion.encoder_count - motion.total_pulses;
+  const unsigned long last_step_us = motion.last_step_us;
+  float exit_speed = 0;
+  if (profile_type_ != VelocityProfile::Type::NONE) {
+    exit_speed =
+        planExitSpeed(segment_at, shape, index, num_segments, entry_speed);
+  }
+  motion = planSegment(segment_at(index, shape), entry_speed, exit_speed);
+  if (entry_speed > 0) {
+    continueMotion(motion, encoders, carried_pulses, last_step_us);
+  } else {
+    beginMotion(motion, encoders);
+  }
+}
+
+void MotionGenerator::startNextSegment() {
+  startSegment(
+      motion_, encoders_, segmentFromArray, queue_, 0, num_queued_);
+  --num_queued_;
+  for (byte i = 0; i < num_queued_; ++i) {
+    queue_[i] = queue_[i + 1];
+  }
+}
+
+bool MotionGenerator::stepMotion(Motion& motion,
+                                 EncoderAccumulator& encoders) const {
+  if (!motion.running) return false;
+  if (isMotionComplete(motion, encoders)) {
+    finishMotion(motion);
+    return false;
+  }
+
+  const unsigned long now_us = micros();
+  const unsigned long period_us = now_us - motion.last_step_us;
+  if (period_us < CONTROL_PERIOD_US) return true;
+  motion.last_step_us = now_us;
+
+  if (motion.curve != Curve::NONE) {
+    motion.pose_speeds =
+        computeCurveSpeeds(motion, computeCurveProgress(motion, encoders));
+  } else if (motion.profile.getType() == VelocityProfile::Type::NONE) {
+    long int pulses_remaining = motion.total_pulses - motion.encoder_count;
+    auto linear_mmps = motion.pose_speeds.getLinearMmps();
     if (abs(linear_mmps) < 0.01) {
-      linear_mmps = speed;
+      linear_mmps = motion.speed;
+    }
+    motion.pose_speeds = maybeSlowDown(motion.pose_speeds,
+                                       linear_mmps,
+                                       pulses_remaining,
+                                       motion.slow_down_thresh,
+                                       motion.radius_of_curvature_mm,
+                                       motion.direction);
+  } else {
+    // Profile speeds are unsigned, straight motions at negative speeds move
+    // backwards
+    float speed =
+        motion.profile.getSpeedAtDistance(pulsesToMm(motion.encoder_count));
+    if (motion.speed < 0) {
+      speed = -speed;
+    }
+    motion.pose_speeds = computePoseSpeeds(
+        speed, motion.radius_of_curvature_mm, motion.direction);
+  }
+  PoseSpeeds pose_speeds = motion.pose_speeds;
+  if (isHeadingHeld(motion)) {
+    pose_speeds = holdHeading(motion, encoders, pose_speeds);
+  }
+  const auto wheel_speeds_mmps = cut_.computeWheelSpeeds(
+      pose_speeds.getLinearMmps(), pose_speeds.getAngularRad());
+  const auto wheel_speeds_rpm = cut_.computeSpeedsRpm(wheel_speeds_mmps);
+  int left_rpm = wheel_speeds_rpm.getLeft();
+  int right_rpm = wheel_speeds_rpm.getRight();
+  if (slip_monitor_ != nullptr) {
+    const float scale = slip_monitor_->getTractionScale();
+    left_rpm = round(left_rpm * scale);
+    right_rpm = round(right_rpm * scale);
+  }
+
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.moveRpmGetEncoders(left_rpm, right_rpm, left_encoder, right_encoder);
+  encoders.addDeltas(left_encoder, right_encoder);
+  if (slip_monitor_ != nullptr) {
+    slip_monitor_->update(
+        left_rpm, right_rpm, left_encoder, right_encoder, period_us);
+    if (isAbortedByMonitor()) {
+      motion.exit_speed = 0;
+      finishMotion(motion);
+      return false;
+    }
+  }
+  motion.encoder_count =
+      motion.carried_pulses +
+      (abs(encoders.getLeft()) + abs(encoders.getRight())) / 2;
+
+  if (isMotionComplete(motion, encoders)) {
+    finishMotion(motion);
+    return false;
+  }
+  return true;
+}
+
+bool MotionGenerator::isMotionComplete(
+    const Motion& motion,
+    const EncoderAccumulator& encoders) const {
+  if (motion.curve != Curve::NONE) {
+    return computeCurveProgress(motion, encoders) >= 1.0;
+  }
+  return motion.encoder_count >= motion.total_pulses;
+}
+
+float MotionGenerator::computeCurveProgress(
+    const Motion& motion,
+    const EncoderAccumulator& encoders) const {
+  if (motion.curve_target <= 0) return 1.0;
+
+  const float left_mm = cut_.computeLeftDistanceFromPulses(encoders.getLeft());
+  const float right_mm =
+      cut_.computeRightDistanceFromPulses(encoders.getRight());
+  if (motion.curve == Curve::CLOTHOID) {
+    return ((left_mm + right_mm) / 2.0) / motion.curve_target;
+  }
+  const float angle_rad = (right_mm - left_mm) / axis_length_mm_;
+  return (motion.direction * angle_rad) / motion.curve_target;
+}
+
+PoseSpeeds MotionGenerator::computeCurveSpeeds(const Motion& motion,
+                                               const float progress) const {
+  const float ratio = constrain(progress, 0.0, 1.0);
+  float curvature = 0;
+  if (motion.curve == Curve::CLOTHOID) {
+    curvature = motion.curve_start +
+                ratio * (motion.curve_end - motion.curve_start);
+  } else {
+    float radius_mm = 0;
+    if (motion.curve == Curve::GEOMETRIC_SPIRAL) {
+      radius_mm = motion.curve_start *
+                  pow(motion.curve_end / motion.curve_start, ratio);
+    } else {
+      radius_mm = motion.curve_start +
+                  ratio * (motion.curve_end - motion.curve_start);
+    }
+    // A radius of 0 turns in place
+    curvature = motion.direction / max(MIN_SPIRAL_RADIUS_MM, radius_mm);
+  }
+  // The speed is that of the outer wheel so tight turns stay within it
+  const float speed =
+      motion.profile.getSpeedAtDistance(ratio * motion.curve_length_mm);
+  const float linear_speed =
+      speed / (1.0 + abs(curvature) * axis_length_mm_ / 2.0);
+  return PoseSpeeds(linear_speed, linear_speed * curvature);
+}
+
+void MotionGenerator::finishMotion(Motion& motion) const {
+  if (motion.exit_speed <= 0) {
+    one_.brake(100, 100);
+  }
+  motion.running = false;
+}
+
+bool MotionGenerator::isHeadingHeld(const Motion& motion) const {
+  return heading_gain_ > 0 && motion.curve == Curve::NONE &&
+         motion.radius_of_curvature_mm == STRAIGHT_MOTION;
+}
+
+void MotionGenerator::beginHeadingHold(Motion& motion) const {
+  motion.heading_rad = 0;
+  motion.encoder_heading_rad = 0;
+  motion.heading_integral = 0;
+  motion.start_bearing_deg = -1;
+  if (compass_ != nullptr && isHeadingHeld(motion)) {
+    motion.start_bearing_deg = compass_->readBearing();
+  }
+}
+
+PoseSpeeds MotionGenerator::holdHeading(
+    Motion& motion,
+    const EncoderAccumulator& encoders,
+    const PoseSpeeds& pose_speeds) const {
+  const float left_mm = cut_.computeLeftDistanceFromPulses(encoders.getLeft());
+  const float right_mm =
+      cut_.computeRightDistanceFromPulses(encoders.getRight());
+  const float encoder_heading_rad = (right_mm - left_mm) / axis_length_mm_;
+  motion.heading_rad += encoder_heading_rad - motion.encoder_heading_rad;
+  motion.encoder_heading_rad = encoder_heading_rad;
+
+  // The compass does not drift but is noisy and slow, so it only pulls the
+  // heading from the encoders towards it (complementary filter). Bearings
+  // grow clockwise and a negative bearing is a read error.
+  if (motion.start_bearing_deg >= 0) {
+    const float bearing_deg = compass_->readBearing();
+    if (bearing_deg >= 0) {
+      float compass_heading_deg = motion.start_bearing_deg - bearing_deg;
+      if (compass_heading_deg > 180) compass_heading_deg -= 360;
+      if (compass_heading_deg < -180) compass_heading_deg += 360;
+      motion.heading_rad += compass_weight_ * (radians(compass_heading_deg) -
+                                               motion.heading_rad);
     }
-    pose_speeds = maybeSlowDown(pose_speeds,
-                                linear_mmps,
-                                pulses_remaining,
-                                slow_down_thresh,
-                                radius_of_curvature_mm,
-                                direction);
-    const auto wheel_speeds_mmps = cut_.computeWheelSpeeds(
-        pose_speeds.getLinearMmps(), pose_speeds.getAngularRad());
-    const auto wheel_speeds_rpm = cut_.computeSpeedsRpm(wheel_speeds_mmps);
-    one_.moveRpm(wheel_speeds_rpm.getLeft(), wheel_speeds_rpm.getRight());
   }
-  one_.brake(100, 100);
+
+  const float max_correction_rad = MAX_HEADING_CORRECTION *
+                                   abs(pose_speeds.getLinearMmps()) /
+                                   (axis_length_mm_ / 2.0);
+  const float period_s = CONTROL_PERIOD_US / 1000000.0;
+  const float integral_gain = heading_gain_ * heading_gain_ / 4.0;
+  const float correction_rad =
+      -heading_gain_ * motion.heading_rad -
+      integral_gain * (motion.heading_integral + motion.heading_rad * period_s);
+  // The integral is frozen while the correction is saturated (anti-windup)
+  if (abs(correction_rad) < max_correction_rad) {
+    motion.heading_integral += motion.heading_rad * period_s;
+  }
+  return PoseSpeeds(
+      pose_speeds.getLinearMmps(),
+      pose_speeds.getAngularRad() +
+          constrain(correction_rad, -max_correction_rad, max_correction_rad));
+}
+
+bool MotionGenerator::isAbortedByMonitor() const {
+  return slip_monitor_ != nullptr && abort_when_blocked_ &&
+         slip_monitor_->isBlocked();
+}
+
+void MotionGenerator::moveAndSlowDown(Motion& motion) const {
+  EncoderAccumulator encoders(one_);
+  beginMotion(motion, encoders);
+  while (stepMotion(motion, encoders)) {
+  }
 }
 
 int MotionGenerator::getSign(const float value) const {
@@ -99,7 +550,11 @@ float MotionGenerator::applySlip(const float value) const {
   return round(value / slip_factor_);
 }
 
-void MotionGenerator::moveStraightAtSpeed(
+float MotionGenerator::pulsesToMm(const long int pulses) const {
+  return pulses * cut_.computeDistanceFromPulses(1);
+}
+
+MotionGenerator::Motion MotionGenerator::planStraight(
     const float distance,
     const float speed,
     const float slow_down_distance) const {
@@ -110,11 +565,11 @@ void MotionGenerator::moveStraightAtSpeed(
   auto slow_down_pulses =
       cut_.computePulsesFromDistance(abs_slow_down_distance);
   slow_down_pulses = applySlip(slow_down_pulses);
-  resetEncoders();
-  moveAndSlowDown(total_pulses, speed, 1, STRAIGHT_MOTION, slow_down_pulses);
+  return createMotion(
+      total_pulses, speed, 1, STRAIGHT_MOTION, slow_down_pulses);
 }
 
-void MotionGenerator::rotateAngleDegAtSpeed(
+MotionGenerator::Motion MotionGenerator::planRotation(
     const float angle_deg,
     const float speed,
     const float radius_of_curvature_mm,
@@ -125,10 +580,174 @@ void MotionGenerator::rotateAngleDegAtSpeed(
   auto slow_down_pulses_thresh = cut_.computePulsesFromAngleAndCurvature(
       radians(slow_down_thresh_deg), radius_of_curvature_mm);
   slow_down_pulses_thresh = applySlip(slow_down_pulses_thresh);
-  resetEncoders();
-  moveAndSlowDown(total_pulses,
-                  abs(speed),
-                  getSign(angle_deg),
-                  abs(radius_of_curvature_mm),
-                  slow_down_pulses_thresh);
+  return createMotion(total_pulses,
+                      abs(speed),
+                      getSign(angle_deg),
+                      abs(radius_of_curvature_mm),
+                      slow_down_pulses_thresh);
+}
+
+void MotionGenerator::setVelocityProfile(const VelocityProfile::Type type) {
+  profile_type_ = type;
+}
+
+VelocityProfile::Type MotionGenerator::getVelocityProfile() const {
+  return profile_type_;
+}
+
+void MotionGenerator::setHeadingHold(const float gain,
+                                     const BnrCompass* compass,
+                                     const float compass_weight) {
+  heading_gain_ = abs(gain);
+  compass_ = compass;
+  compass_weight_ = constrain(compass_weight, 0.0, 1.0);
+}
+
+void MotionGenerator::setSlipMonitor(SlipMonitor* slip_monitor,
+                                     const bool abort_when_blocked) {
+  slip_monitor_ = slip_monitor;
+  abort_when_blocked_ = abort_when_blocked;
+}
+
+void MotionGenerator::moveStraightAtSpeed(
+    const float distance,
+    const float speed,
+    const float slow_down_distance) const {
+  Motion motion = planStraight(distance, speed, slow_down_distance);
+  moveAndSlowDown(motion);
+}
+
+void MotionGenerator::rotateAngleDegAtSpeed(
+    const float angle_deg,
+    const float speed,
+    const float radius_of_curvature_mm,
+    const float slow_down_thresh_deg) const {
+  Motion motion = planRotation(
+      angle_deg, speed, radius_of_curvature_mm, slow_down_thresh_deg);
+  moveAndSlowDown(motion);
+}
+
+void MotionGenerator::spiralAngleDegAtSpeed(const float angle_deg,
+                                            const float speed,
+                                            const float start_radius_mm,
+                                            const float end_radius_mm,
+                                            const bool geometric) const {
+  Motion motion = planSpiral(
+      angle_deg, speed, start_radius_mm, end_radius_mm, geometric);
+  moveAndSlowDown(motion);
+}
+
+void MotionGenerator::moveClothoidAtSpeed(const float distance,
+                                          const float speed,
+                                          const float start_curvature,
+                                          const float end_curvature) const {
+  Motion motion =
+      planClothoid(distance, speed, start_curvature, end_curvature);
+  moveAndSlowDown(motion);
+}
+
+void MotionGenerator::startStraight(const float distance,
+                                    const float speed,
+                                    const float slow_down_distance) {
+  num_queued_ = 0;
+  motion_ = planStraight(distance, speed, slow_down_distance);
+  beginMotion(motion_, encoders_);
+}
+
+void MotionGenerator::startRotation(const float angle_deg,
+                                    const float speed,
+                                    const float radius_of_curvature_mm,
+                                    const float slow_down_thresh_deg) {
+  num_queued_ = 0;
+  motion_ = planRotation(
+      angle_deg, speed, radius_of_curvature_mm, slow_down_thresh_deg);
+  beginMotion(motion_, encoders_);
+}
+
+void MotionGenerator::followSegments(const MotionSegment segments[],
+                                     const int num_segments) const {
+  followSegments(segmentFromArray, segments, num_segments);
+}
+
+void MotionGenerator::followSegments(SegmentFunction segment_at,
+                                     const void* shape,
+                                     const int num_segments) const {
+  EncoderAccumulator encoders(one_);
+  Motion motion = createMotion(0, 0, 1, STRAIGHT_MOTION, 0);
+  for (int i = 0; i < num_segments; ++i) {
+    startSegment(motion, encoders, segment_at, shape, i, num_segments);
+    while (stepMotion(motion, encoders)) {
+    }
+    if (isAbortedByMonitor()) return;
+  }
+}
+
+void MotionGenerator::startSpiral(const float angle_deg,
+                                  const float speed,
+                                  const float start_radius_mm,
+                                  const float end_radius_mm,
+                                  const bool geometric) {
+  num_queued_ = 0;
+  motion_ = planSpiral(
+      angle_deg, speed, start_radius_mm, end_radius_mm, geometric);
+  beginMotion(motion_, encoders_);
+}
+
+void MotionGenerator::startClothoid(const float distance,
+                                    const float speed,
+                                    const float start_curvature,
+                                    const float end_curvature) {
+  num_queued_ = 0;
+  motion_ = planClothoid(distance, speed, start_curvature, end_curvature);
+  beginMotion(motion_, encoders_);
+}
+
+void MotionGenerator::setSegmentQueue(MotionSegment queue[],
+                                      const byte size) {
+  queue_ = queue;
+  queue_size_ = (queue != nullptr) ? size : 0;
+  num_queued_ = 0;
+}
+
+bool MotionGenerator::queueSegment(const MotionSegment& segment) {
+  if (num_queued_ >= queue_size_) return false;
+  queue_[num_queued_] = segment;
+  ++num_queued_;
+  return true;
+}
+
+byte MotionGenerator::getNumQueuedSegments() const { return num_queued_; }
+
+bool MotionGenerator::step() {
+  if (!motion_.running && num_queued_ > 0) {
+    startNextSegment();
+  }
+  if (stepMotion(motion_, encoders_)) return true;
+  if (isAbortedByMonitor()) num_queued_ = 0;
+  if (num_queued_ > 0) {
+    startNextSegment();
+    return true;
+  }
+  return false;
+}
+
+bool MotionGenerator::isDone() const {
+  return !motion_.running && num_queued_ == 0;
+}
+
+float MotionGenerator::progress() const {
+  if (motion_.curve != Curve::NONE) {
+    return constrain(computeCurveProgress(motion_, encoders_), 0.0, 1.0);
+  }
+  if (motion_.total_pulses <= 0) return isDone() ? 1.0 : 0.0;
+  return constrain(
+      motion_.encoder_count / (float)motion_.total_pulses, 0.0, 1.0);
+}
+
+void MotionGenerator::abort() {
+  num_queued_ = 0;
+  motion_.exit_speed = 0;
+  if (motion_.running) {
+    finishMotion(motion_);
+  }
 }
@@ -3,12 +3,126 @@
 #include <BnrOneAPlus.h>
 
 #include "ControlUtils.h"
+#include "EncoderAccumulator.h"
 #include "RobotParams.h"
+#include "SlipMonitor.h"
+#include "VelocityProfile.h"
+
+#define MAX_QUEUED_SEGMENTS 8  // Segments planned ahead
+
+class BnrCompass;
+
+/**
+ * @class MotionSegment
+ * @brief Straight line, arc or rotation in place that is part of a motion
+ * made of several segments.
+ */
+class MotionSegment {
+ public:
+  /**
+   * @brief Constructor for MotionSegment.
+   * @param distance_mm Length of a straight line, 0 for arcs and rotations.
+   * @param angle_deg Angle of an arc or rotation in degrees, positive
+   * counterclockwise.
+   * @param radius_of_curvature_mm Radius of an arc, 0 for rotations.
+   * @param speed Speed in millimeters per second.
+   */
+  MotionSegment(const float distance_mm = 0,
+                const float angle_deg = 0,
+                const float radius_of_curvature_mm = 0,
+                const float speed = 200);
+
+  /**
+   * @brief Creates a straight line segment.
+   * @param distance_mm Length of the line in millimeters.
+   * @param speed Speed in millimeters per second.
+   */
+  static MotionSegment straight(const float distance_mm,
+                                const float speed = 200);
+
+  /**
+   * @brief Creates an arc segment.
+   * @param angle_deg Angle of the arc in degrees, positive counterclockwise.
+   * @param radius_of_curvature_mm Radius of the arc in millimeters.
+   * @param speed Speed in millimeters per second.
+   */
+  static MotionSegment arc(const float angle_deg,
+                           const float radius_of_curvature_mm,
+                           const float speed = 200);
+
+  /**
+   * @brief Creates a rotation in place.
+   * @param angle_deg Angle to rotate in degrees, positive counterclockwise.
+   * @param speed Speed of the wheels in millimeters per second.
+   */
+  static MotionSegment rotation(const float angle_deg,
+                                const float speed = 200);
+
+  /**
+   * @brief Checks if the segment is a straight line.
+   */
+  bool isStraight() const;
+
+  /**
+   * @brief Gets the length of the path of the centre of the robot.
+   * @return Length in millimeters, 0 for rotations in place.
+   */
+  float getLengthMm() const;
+
+  /**
+   * @brief Gets the signed curvature of the path.
+   * @return Curvature in 1/mm, positive counterclockwise, 0 for straight
+   * lines.
+   */
+  float getCurvature() const;
+
+  float distance_mm;             ///< Length of a straight line.
+  float angle_deg;               ///< Angle of an arc or rotation.
+  float radius_of_curvature_mm;  ///< Radius of an arc, 0 for rotations.
+  float speed;                   ///< Speed in millimeters per second.
+};
+
+/**
+ * @brief Function that returns the segment at the given index of a motion, so
+ * that long motions can be generated while they are executed.
+ * @param index Index of the segment.
+ * @param shape Parameters of the motion.
+ */
+typedef MotionSegment (*SegmentFunction)(const int index, const void* shape);
 
 /**
  * @class MotionGenerator
  * @brief Class that enables moving in curved or straight lines by specifying
  * the distance and/or angle and speed of the desired motion.
+ *
+ * Motions can be executed in a blocking way (moveStraightAtSpeed,
+ * rotateAngleDegAtSpeed) or started with startStraight/startRotation and
+ * advanced by calling step() repeatedly, e.g. from loop(), so that sensors can
+ * be read and the motion aborted while the robot is moving.
+ *
+ * By default the robot starts at the requested speed and slows down near the
+ * end. Trapezoidal or S-curve profiles, limited by the acceleration and jerk
+ * of RobotParams, can be selected with setVelocityProfile.
+ *
+ * With a velocity profile, sequences of segments are planned ahead so that
+ * the speed is carried through junctions where the curvature changes little
+ * (e.g. line into a gentle arc, arc into arc in the same direction) and the
+ * robot only stops where required, e.g. before rotations in place. Without
+ * one, the robot stops at the end of every segment. Segments queued for step()
+ * are kept in a buffer given with setSegmentQueue, so motions that do not
+ * queue segments take no memory for them.
+ *
+ * Spirals and clothoids vary the curvature continuously with the travelled
+ * angle or distance, updating the wheel speeds every control cycle, so they
+ * run as a single uninterrupted motion.
+ *
+ * Straight motions can hold their heading with setHeadingHold: the split of
+ * the wheel speeds is corrected every control cycle from the heading change
+ * measured by the encoders, optionally fused with a compass.
+ *
+ * A SlipMonitor set with setSlipMonitor checks the wheels every control
+ * cycle: the speeds are scaled down while a wheel slips, and the motion can
+ * be aborted as soon as a wheel is blocked or stalled.
  */
 class MotionGenerator {
  public:
@@ -22,6 +136,46 @@ class MotionGenerator {
                   const float slip_factor = 1.0,
                   const RobotParams& robot_params = RobotParams());
 
+  /**
+   * @brief Sets the velocity profile of the motions started afterwards.
+   * With a profile other than NONE the slow down distance and angle
+   * arguments are ignored.
+   * @param type Shape of the profile.
+   */
+  void setVelocityProfile(const VelocityProfile::Type type);
+
+  /**
+   * @brief Gets the velocity profile of the motions started afterwards.
+   */
+  VelocityProfile::Type getVelocityProfile() const;
+
+  /**
+   * @brief Enables holding the heading on straight motions.
+   * @param gain Angular speed correction per radian of heading error, in
+   * 1/s. 0 disables the heading hold. The integral gain is set to gain^2 / 4
+   * for a critically damped response that cancels constant motor mismatches.
+   * @param compass Compass fused with the heading from the encoders, or
+   * nullptr to use the encoders only.
+   * @param compass_weight Fraction of the difference to the compass heading
+   * corrected every control cycle.
+   */
+  void setHeadingHold(const float gain,
+                      const BnrCompass* compass = nullptr,
+                      const float compass_weight = 0.05);
+
+  /**
+   * @brief Sets a monitor that checks the wheels every control cycle of the
+   * motions started afterwards. The commanded speeds are scaled by its
+   * traction scale, so they are backed off while a wheel slips.
+   * @param slip_monitor Monitor, or nullptr to disable the checks. It is not
+   * copied and must remain valid while it is set.
+   * @param abort_when_blocked Brake, end the motion and clear the queue when
+   * a wheel is blocked or stalled. The monitor keeps the state until the
+   * next motion starts.
+   */
+  void setSlipMonitor(SlipMonitor* slip_monitor,
+                      const bool abort_when_blocked = true);
+
   /**
    * @brief Moves the robot for the given distance at the given speed.
    * @param distance Distance to move.
@@ -44,11 +198,407 @@ class MotionGenerator {
                              const float radius_of_curvature_mm = 0,
                              const float slow_down_thresh_deg = 0) const;
 
+  /**
+   * @brief Describes a spiral whose radius varies continuously from the start
+   * to the end radius while turning the given angle.
+   * @param angle_deg Angle to turn in degrees, positive counterclockwise.
+   * @param speed Speed of the outer wheel in millimeters per second.
+   * @param start_radius_mm Radius at the start of the spiral (0 starts
+   * rotating in place).
+   * @param end_radius_mm Radius at the end of the spiral.
+   * @param geometric false for a radius proportional to the turned angle
+   * (Archimedean spiral), true for a radius growing by the same ratio every
+   * degree (logarithmic spiral). Geometric spirals need radii above 0.
+   */
+  void spiralAngleDegAtSpeed(const float angle_deg,
+                             const float speed,
+                             const float start_radius_mm,
+                             const float end_radius_mm,
+                             const bool geometric = false) const;
+
+  /**
+   * @brief Describes a clothoid, i.e. a curve whose curvature varies linearly
+   * with the travelled distance.
+   * @param distance Length of the curve in millimeters.
+   * @param speed Speed of the outer wheel in millimeters per second.
+   * @param start_curvature Curvature at the start in 1/mm, positive
+   * counterclockwise, 0 for a straight line.
+   * @param end_curvature Curvature at the end in 1/mm.
+   */
+  void moveClothoidAtSpeed(const float distance,
+                           const float speed,
+                           const float start_curvature,
+                           const float end_curvature) const;
+
+  /**
+   * @brief Starts moving the robot for the given distance at the given speed
+   * without blocking. Call step() until it returns false.
+   * @param distance Distance to move.
+   * @param speed Speed to move at.
+   * @param slow_down_distance Distance at which to start slowing down.
+   */
+  void startStraight(const float distance,
+                     const float speed = 200,
+                     const float slow_down_distance = 0);
+
+  /**
+   * @brief Starts rotating the robot the specified angle at the given speed
+   * without blocking. Call step() until it returns false.
+   * @param angle_deg Angle to rotate in degrees.
+   * @param speed Speed to rotate at.
+   * @param radius_of_curvature_mm Radius of curvature for the rotation.
+   * @param slow_down_thresh_deg Angle at which to start slowing down.
+   */
+  void startRotation(const float angle_deg,
+                     const float speed = 200,
+                     const float radius_of_curvature_mm = 0,
+                     const float slow_down_thresh_deg = 0);
+
+  /**
+   * @brief Starts describing a spiral without blocking. Call step() until it
+   * returns false. See spiralAngleDegAtSpeed.
+   */
+  void startSpiral(const float angle_deg,
+                   const float speed,
+                   const float start_radius_mm,
+                   const float end_radius_mm,
+                   const bool geometric = false);
+
+  /**
+   * @brief Starts describing a clothoid without blocking. Call step() until
+   * it returns false. See moveClothoidAtSpeed.
+   */
+  void startClothoid(const float distance,
+                     const float speed,
+                     const float start_curvature,
+                     const float end_curvature);
+
+  /**
+   * @brief Executes a sequence of segments without stopping at junctions
+   * where the speed can be carried over. Blocks until the last segment is
+   * complete. Without a velocity profile the robot stops at the end of every
+   * segment.
+   * @param segments Segments to execute.
+   * @param num_segments Number of segments.
+   */
+  void followSegments(const MotionSegment segments[],
+                      const int num_segments) const;
+
+  /**
+   * @brief Executes a sequence of segments generated while the robot moves,
+   * so that no array of segments is kept in memory. The look-ahead segments
+   * are generated again when each segment starts. See followSegments.
+   * @param segment_at Function that returns each segment.
+   * @param shape Parameters passed to the function.
+   * @param num_segments Number of segments.
+   */
+  void followSegments(SegmentFunction segment_at,
+                      const void* shape,
+                      const int num_segments) const;
+
+  /**
+   * @brief Sets the buffer of the segment queue executed by step(), so the
+   * generator only takes this memory when segments are queued. Clears the
+   * queue.
+   * @param queue Buffer for the queued segments, e.g. of MAX_QUEUED_SEGMENTS
+   * elements. It is not copied and must remain valid while it is set.
+   * @param size Number of elements of the buffer, 0 to remove it.
+   */
+  void setSegmentQueue(MotionSegment queue[], const byte size);
+
+  /**
+   * @brief Adds a segment to the queue executed by step(). Segments already
+   * queued when a segment starts are used to plan its exit speed, up to
+   * MAX_QUEUED_SEGMENTS of them, so the queue should be kept filled ahead of
+   * the robot.
+   * @param segment Segment to add.
+   * @return false if the queue is full or no buffer was set with
+   * setSegmentQueue.
+   */
+  bool queueSegment(const MotionSegment& segment);
+
+  /**
+   * @brief Gets the number of segments waiting in the queue.
+   */
+  byte getNumQueuedSegments() const;
+
+  /**
+   * @brief Updates the wheel speeds of the motion in progress and reads the
+   * encoders. Brakes when the motion is complete. Returns without any SPI
+   * communication if called again before the control period has elapsed.
+   * Starts the next queued segment when the current one is complete.
+   * @return true while the motion is in progress or segments are queued,
+   * false when it is done.
+   */
+  bool step();
+
+  /**
+   * @brief Checks if the last started motion is complete or was aborted.
+   * @return true if no motion is in progress and the queue is empty.
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Gets the fraction of the motion in progress already travelled.
+   * @return Value from 0 (just started) to 1 (complete).
+   */
+  float progress() const;
+
+  /**
+   * @brief Brakes the robot, ends the motion in progress and clears the
+   * queue.
+   */
+  void abort();
+
  private:
   /**
-   * @brief Resets both encoders.
+   * @brief Law of variation of the curvature along a motion.
+   */
+  enum class Curve {
+    NONE,              ///< Constant curvature (lines, arcs, rotations).
+    LINEAR_SPIRAL,     ///< Radius proportional to the turned angle.
+    GEOMETRIC_SPIRAL,  ///< Radius growing geometrically with the angle.
+    CLOTHOID           ///< Curvature proportional to the distance.
+  };
+
+  /**
+   * @brief State of a motion expressed in encoder pulses.
+   */
+  struct Motion {
+    long int total_pulses;         ///< Total pulses required for the motion.
+    float speed;                   ///< Speed to move at.
+    int direction;                 ///< Direction of motion.
+    float radius_of_curvature_mm;  ///< Radius of curvature.
+    long int slow_down_thresh;     ///< Threshold for slowing down.
+    PoseSpeeds pose_speeds;        ///< Current linear and angular speeds.
+    long int encoder_count;        ///< Pulses travelled so far.
+    bool running;                  ///< Whether the motion is in progress.
+    unsigned long last_step_us;    ///< Time of the last control cycle.
+    VelocityProfile profile;       ///< Speed along the motion.
+    float exit_speed;              ///< Speed at the end, 0 to brake.
+    long int carried_pulses;       ///< Pulses carried from previous segment.
+    Curve curve;                   ///< Law of variation of the curvature.
+    float curve_start;             ///< Start radius or curvature.
+    float curve_end;               ///< End radius or curvature.
+    float curve_target;            ///< Angle or distance to travel.
+    float curve_length_mm;         ///< Length of the path of the curve.
+    float heading_rad;             ///< Heading change since the start.
+    float encoder_heading_rad;     ///< Heading change from the encoders.
+    float heading_integral;        ///< Integral of the heading change.
+    float start_bearing_deg;       ///< Compass bearing at the start.
+  };
+
+  /**
+   * @brief Creates a motion for the given distance at the given speed.
+   * @param distance Distance to move.
+   * @param speed Speed to move at.
+   * @param slow_down_distance Distance at which to start slowing down.
+   * @return Motion ready to be executed.
+   */
+  Motion planStraight(const float distance,
+                      const float speed,
+                      const float slow_down_distance) const;
+
+  /**
+   * @brief Creates a motion for the given angle at the given speed.
+   * @param angle_deg Angle to rotate in degrees.
+   * @param speed Speed to rotate at.
+   * @param radius_of_curvature_mm Radius of curvature for the rotation.
+   * @param slow_down_thresh_deg Angle at which to start slowing down.
+   * @return Motion ready to be executed.
+   */
+  Motion planRotation(const float angle_deg,
+                      const float speed,
+                      const float radius_of_curvature_mm,
+                      const float slow_down_thresh_deg) const;
+
+  /**
+   * @brief Creates a spiral motion. See spiralAngleDegAtSpeed.
+   * @return Motion ready to be executed.
+   */
+  Motion planSpiral(const float angle_deg,
+                    const float speed,
+                    const float start_radius_mm,
+                    const float end_radius_mm,
+                    const bool geometric) const;
+
+  /**
+   * @brief Creates a clothoid motion. See moveClothoidAtSpeed.
+   * @return Motion ready to be executed.
+   */
+  Motion planClothoid(const float distance,
+                      const float speed,
+                      const float start_curvature,
+                      const float end_curvature) const;
+
+  /**
+   * @brief Creates a motion from its parameters in pulses.
+   * @param total_pulses Total pulses required for the motion.
+   * @param speed Speed to move at.
+   * @param direction Direction of motion.
+   * @param radius_of_curvature_mm Radius of curvature.
+   * @param slow_down_thresh Threshold for slowing down.
+   * @return Motion ready to be executed.
    */
-  void resetEncoders() const;
+  Motion createMotion(const long int total_pulses,
+                      const float speed,
+                      const int direction,
+                      const float radius_of_curvature_mm,
+                      const long int slow_down_thresh) const;
+
+  /**
+   * @brief Creates a motion for a segment.
+   * @param segment Segment to execute.
+   * @param entry_speed Speed at the start of the segment.
+   * @param exit_speed Speed at the end of the segment, 0 to brake.
+   * @return Motion ready to be executed.
+   */
+  Motion planSegment(const MotionSegment& segment,
+                     const float entry_speed,
+                     const float exit_speed) const;
+
+  /**
+   * @brief Computes the highest speed at the end of a segment that still
+   * allows stopping at the end of the last look-ahead segment. Segments are
+   * requested one at a time instead of being copied into a window.
+   * @param segment_at Function that returns each segment.
+   * @param shape Parameters passed to the function.
+   * @param index Index of the segment.
+   * @param num_segments Number of segments.
+   * @param entry_speed Speed at the start of the segment.
+   * @return Speed at the end of the segment.
+   */
+  float planExitSpeed(SegmentFunction segment_at,
+                      const void* shape,
+                      const int index,
+                      const int num_segments,
+                      const float entry_speed) const;
+
+  /**
+   * @brief Computes the highest speed at the junction of two segments.
+   * @param from Segment before the junction.
+   * @param to Segment after the junction.
+   * @return Speed in millimeters per second, 0 if the robot must stop.
+   */
+  float computeJunctionSpeed(const MotionSegment& from,
+                             const MotionSegment& to) const;
+
+  /**
+   * @brief Discards the pulses counted before the motion and marks it as
+   * running.
+   * @param motion Motion to begin.
+   * @param encoders Encoder counts since the start of the motion.
+   */
+  void beginMotion(Motion& motion, EncoderAccumulator& encoders) const;
+
+  /**
+   * @brief Starts a motion right after the previous one without stopping,
+   * carrying over the pulses travelled beyond the end of the previous one.
+   * @param motion Motion to begin.
+   * @param encoders Encoder counts since the start of the motion.
+   * @param carried_pulses Pulses travelled beyond the end of the previous
+   * motion.
+   * @param last_step_us Time of the last control cycle of the previous
+   * motion.
+   */
+  void continueMotion(Motion& motion,
+                      EncoderAccumulator& encoders,
+                      const long int carried_pulses,
+                      const unsigned long last_step_us) const;
+
+  /**
+   * @brief Replaces the motion that just finished with the given segment,
+   * carrying over its exit speed.
+   * @param motion Motion that just finished, replaced in place.
+   * @param encoders Encoder counts since the start of the motion.
+   * @param segment_at Function that returns each segment.
+   * @param shape Parameters passed to the function.
+   * @param index Index of the segment, followed by the look-ahead segments.
+   * @param num_segments Number of segments.
+   */
+  void startSegment(Motion& motion,
+                    EncoderAccumulator& encoders,
+                    SegmentFunction segment_at,
+                    const void* shape,
+                    const int index,
+                    const int num_segments) const;
+
+  /**
+   * @brief Starts the first segment of the queue.
+   */
+  void startNextSegment();
+
+  /**
+   * @brief Advances a motion by one control cycle. Sets the wheel speeds and
+   * reads the encoders in a single SPI transaction, at most once every
+   * control period.
+   * @param motion Motion to advance.
+   * @param encoders Encoder counts since the start of the motion.
+   * @return true while the motion is in progress, false when it is done.
+   */
+  bool stepMotion(Motion& motion, EncoderAccumulator& encoders) const;
+
+  /**
+   * @brief Checks if a motion reached its target.
+   * @param motion Motion to check.
+   * @param encoders Encoder counts since the start of the motion.
+   */
+  bool isMotionComplete(const Motion& motion,
+                        const EncoderAccumulator& encoders) const;
+
+  /**
+   * @brief Computes the fraction of a curve already travelled from the signed
+   * distances travelled by the wheels.
+   * @param motion Curve motion.
+   * @param encoders Encoder counts since the start of the motion.
+   * @return Fraction travelled, 1 or more when complete.
+   */
+  float computeCurveProgress(const Motion& motion,
+                             const EncoderAccumulator& encoders) const;
+
+  /**
+   * @brief Computes the pose speeds at a point of a curve.
+   * @param motion Curve motion.
+   * @param progress Fraction of the curve already travelled.
+   * @return Pose speeds, with the outer wheel at the profile speed.
+   */
+  PoseSpeeds computeCurveSpeeds(const Motion& motion,
+                                const float progress) const;
+
+  /**
+   * @brief Brakes the robot unless the motion has an exit speed and marks it
+   * as done.
+   * @param motion Motion to finish.
+   */
+  void finishMotion(Motion& motion) const;
+
+  /**
+   * @brief Checks if the heading of a motion is held.
+   */
+  bool isHeadingHeld(const Motion& motion) const;
+
+  /**
+   * @brief Sets the current heading as the heading to hold.
+   * @param motion Motion starting.
+   */
+  void beginHeadingHold(Motion& motion) const;
+
+  /**
+   * @brief Updates the heading of a straight motion and corrects the angular
+   * speed to cancel the heading change.
+   * @param motion Motion in progress.
+   * @param encoders Encoders of the motion.
+   * @param pose_speeds Speeds of the motion without correction.
+   * @return Corrected speeds.
+   */
+  PoseSpeeds holdHeading(Motion& motion,
+                         const EncoderAccumulator& encoders,
+                         const PoseSpeeds& pose_speeds) const;
+
+  /**
+   * @brief Checks if the slip monitor aborted the last motion.
+   */
+  bool isAbortedByMonitor() const;
 
   /**
    * @brief Computes the pose speeds (linear and angular in radians)
@@ -82,18 +632,10 @@ class MotionGenerator {
 
   /**
    * @brief Moves the robot and slows down when pulses remaining are less than
-   * the threshold.
-   * @param total_pulses Total pulses required for the motion.
-   * @param speed Speed to move at.
-   * @param direction Direction of motion.
-   * @param radius_of_curvature_mm Radius of curvature.
-   * @param slow_down_thresh Threshold for slowing down.
+   * the threshold. Blocks until the motion is complete.
+   * @param motion Motion to execute, advanced in place.
    */
-  void moveAndSlowDown(const long int total_pulses,
-                       const float speed = 50,
-                       const int direction = 1,
-                       const float radius_of_curvature_mm = 0,
-                       const long int slow_down_thresh = 4000) const;
+  void moveAndSlowDown(Motion& motion) const;
 
   /**
    * @brief Gets the sign of a value.
@@ -109,8 +651,28 @@ class MotionGenerator {
    */
   float applySlip(const float value) const;
 
-  const BnrOneAPlus& one_;  ///< Reference to BnrOneAPlus object.
-  float slip_factor_;       ///< Slip factor for the robot.
-  float axis_length_mm_;    ///< Axis length of the robot in millimeters.
-  ControlUtils cut_;        ///< Control utils object
+  /**
+   * @brief Converts encoder pulses to the distance travelled by the wheels.
+   * @param pulses Encoder pulses.
+   * @return Distance in millimeters.
+   */
+  float pulsesToMm(const long int pulses) const;
+
+  const BnrOneAPlus& one_;              ///< Reference to BnrOneAPlus object.
+  float slip_factor_;                   ///< Slip factor for the robot.
+  float axis_length_mm_;                ///< Axis length in millimeters.
+  float max_accel_mmps2_;               ///< Maximum wheel acceleration.
+  float max_jerk_mmps3_;                ///< Maximum wheel jerk.
+  VelocityProfile::Type profile_type_;  ///< Profile of new motions.
+  ControlUtils cut_;                    ///< Control utils object
+  Motion motion_;                       ///< Motion started without blocking.
+  EncoderAccumulator encoders_;         ///< Encoders of the started motion.
+  MotionSegment* queue_;                ///< Segments to execute, if any.
+  byte queue_size_;                     ///< Size of the queue buffer.
+  byte num_queued_;                     ///< Number of queued segments.
+  float heading_gain_;                  ///< Heading correction gain.
+  const BnrCompass* compass_;           ///< Compass fused, if any.
+  float compass_weight_;                ///< Weight of the compass heading.
+  SlipMonitor* slip_monitor_;           ///< Wheel monitor, if any.
+  bool abort_when_blocked_;             ///< Abort when a wheel is blocked.
 };
@@ -0,0 +1,323 @@
+#include "MotionScript.h"
+
+#include <EEPROM.h>  // EEPROM reading and writing
+
+#define DEFAULT_SPEED_MMPS 200
+#define MAX_INSTRUCTIONS_PER_STEP 16  // Keeps step() short in idle loops
+#define SCRIPT_HEADER_SIZE 2  // Size saved before a script in EEPROM
+#define MAX_EEPROM_SCRIPT_SIZE (MOTION_SCRIPT_EEPROM_SIZE - SCRIPT_HEADER_SIZE)
+
+namespace {
+bool fitsInEeprom(const int size, const int eeprom_address) {
+  return size > 0 && size <= MAX_EEPROM_SCRIPT_SIZE &&
+         eeprom_address + SCRIPT_HEADER_SIZE + size <= (int)EEPROM.length();
+}
+}  // namespace
+
+MotionScript::MotionScript(const BnrOneAPlus& one, MotionGenerator& mg)
+    : one_(one),
+      mg_(mg),
+      script_(nullptr),
+      storage_(Storage::RAM),
+      eeprom_address_(0),
+      size_(0),
+      address_(0),
+      speed_mmps_(DEFAULT_SPEED_MMPS),
+      num_loops_(0),
+      activity_(Activity::NONE),
+      wait_start_ms_(0),
+      wait_ms_(0),
+      running_(false),
+      error_(false) {}
+
+void MotionScript::setScript(const byte script[],
+                             const int size,
+                             const bool in_progmem) {
+  script_ = script;
+  size_ = size;
+  storage_ = in_progmem ? Storage::FLASH : Storage::RAM;
+}
+
+bool MotionScript::setScriptFromEeprom(const int eeprom_address) {
+  const int size =
+      word(EEPROM.read(eeprom_address), EEPROM.read(eeprom_address + 1));
+  // Erased EEPROM reads 0xFFFF
+  if (!fitsInEeprom(size, eeprom_address)) return false;
+  script_ = nullptr;
+  size_ = size;
+  eeprom_address_ = eeprom_address + SCRIPT_HEADER_SIZE;
+  storage_ = Storage::EEPROM;
+  return true;
+}
+
+bool MotionScript::isValid() const {
+  if (storage_ != Storage::EEPROM && script_ == nullptr) return false;
+
+  // Opening opcode of each block in progress, so that a block can only be
+  // closed by the instruction that matches the innermost one
+  byte blocks[MAX_SCRIPT_BLOCK_DEPTH];
+  int num_blocks = 0;
+  int loop_depth = 0;
+  int address = 0;
+  while (address < size_) {
+    const byte opcode = readByte(address);
+    const int num_arg_bytes = getNumArgBytes(opcode);
+    if (num_arg_bytes < 0) return false;
+    const byte block = (num_blocks > 0) ? blocks[num_blocks - 1] : MS_OP_END;
+    switch (opcode) {
+      case MS_OP_LOOP:
+      case MS_OP_IF_OBSTACLE:
+      case MS_OP_IF_BUTTON:
+        if (num_blocks >= MAX_SCRIPT_BLOCK_DEPTH) return false;
+        if (opcode == MS_OP_LOOP && ++loop_depth > MAX_SCRIPT_LOOP_DEPTH) {
+          return false;
+        }
+        blocks[num_blocks++] = opcode;
+        break;
+      case MS_OP_END_LOOP:
+        if (block != MS_OP_LOOP) return false;
+        --num_blocks;
+        --loop_depth;
+        break;
+      case MS_OP_ELSE:
+        // A condition has a single else block
+        if (block != MS_OP_IF_OBSTACLE && block != MS_OP_IF_BUTTON) {
+          return false;
+        }
+        blocks[num_blocks - 1] = MS_OP_ELSE;
+        break;
+      case MS_OP_END_IF:
+        if (block != MS_OP_IF_OBSTACLE && block != MS_OP_IF_BUTTON &&
+            block != MS_OP_ELSE) {
+          return false;
+        }
+        --num_blocks;
+        break;
+    }
+    address += 1 + num_arg_bytes;
+  }
+  return address <= size_ && num_blocks == 0;
+}
+
+bool MotionScript::start() {
+  mg_.abort();
+  address_ = 0;
+  speed_mmps_ = DEFAULT_SPEED_MMPS;
+  num_loops_ = 0;
+  activity_ = Activity::NONE;
+  error_ = !isValid();
+  running_ = !error_;
+  return running_;
+}
+
+bool MotionScript::step() {
+  if (!running_) return false;
+
+  if (activity_ == Activity::MOTION) {
+    if (mg_.step()) return true;
+  } else if (activity_ == Activity::WAIT) {
+    if (millis() - wait_start_ms_ < wait_ms_) return true;
+  }
+  activity_ = Activity::NONE;
+  runInstructions();
+  return running_;
+}
+
+void MotionScript::run() {
+  if (!start()) return;
+  while (step()) {
+  }
+}
+
+bool MotionScript::isDone() const { return !running_; }
+
+bool MotionScript::hasError() const { return error_; }
+
+void MotionScript::abort() {
+  if (running_) {
+    stop(false);
+  }
+}
+
+int MotionScript::receiveScript(Stream& stream,
+                                byte buffer[],
+                                const int max_size,
+                                const unsigned long timeout_ms) {
+  stream.setTimeout(timeout_ms);
+  byte header[SCRIPT_HEADER_SIZE];
+  if (stream.readBytes(header, SCRIPT_HEADER_SIZE) != SCRIPT_HEADER_SIZE) {
+    return -1;
+  }
+  const int size = word(header[0], header[1]);
+  if (size <= 0 || size > max_size) return -1;
+  if (stream.readBytes(buffer, size) != (size_t)size) return -1;
+
+  byte checksum = 0;
+  for (int i = 0; i < size; ++i) {
+    checksum += buffer[i];
+  }
+  byte received_checksum = 0;
+  if (stream.readBytes(&received_checksum, 1) != 1 ||
+      received_checksum != checksum) {
+    return -1;
+  }
+  return size;
+}
+
+bool MotionScript::saveToEeprom(const byte script[],
+                                const int size,
+                                const int eeprom_address) {
+  if (!fitsInEeprom(size, eeprom_address)) return false;
+  // Update only writes the bytes that changed, saving EEPROM wear
+  EEPROM.update(eeprom_address, highByte(size));
+  EEPROM.update(eeprom_address + 1, lowByte(size));
+  for (int i = 0; i < size; ++i) {
+    EEPROM.update(eeprom_address + SCRIPT_HEADER_SIZE + i, script[i]);
+  }
+  return true;
+}
+
+void MotionScript::runInstructions() {
+  for (int i = 0; i < MAX_INSTRUCTIONS_PER_STEP; ++i) {
+    if (!running_ || activity_ != Activity::NONE) return;
+    if (address_ >= size_) {
+      stop(false);
+    } else if (!runInstruction()) {
+      stop(true);
+    }
+  }
+}
+
+bool MotionScript::runInstruction() {
+  const byte opcode = readByte(address_);
+  const int num_arg_bytes = getNumArgBytes(opcode);
+  if (num_arg_bytes < 0 || address_ + 1 + num_arg_bytes > size_) return false;
+  const int args = address_ + 1;
+  address_ = args + num_arg_bytes;
+
+  switch (opcode) {
+    case MS_OP_END:
+      stop(false);
+      break;
+    case MS_OP_SPEED:
+      speed_mmps_ = abs(readWord(args));
+      break;
+    case MS_OP_LINE: {
+      // The direction of straight motions is given by the sign of the speed
+      const int distance_mm = readWord(args);
+      mg_.startStraight(abs(distance_mm),
+                        (distance_mm < 0) ? -speed_mmps_ : speed_mmps_);
+      activity_ = Activity::MOTION;
+      break;
+    }
+    case MS_OP_ARC:
+      mg_.startRotation(readWord(args), speed_mmps_, readWord(args + 2));
+      activity_ = Activity::MOTION;
+      break;
+    case MS_OP_ROTATE:
+      mg_.startRotation(readWord(args), speed_mmps_);
+      activity_ = Activity::MOTION;
+      break;
+    case MS_OP_WAIT:
+      wait_ms_ = (unsigned int)word(readByte(args), readByte(args + 1));
+      wait_start_ms_ = millis();
+      activity_ = Activity::WAIT;
+      break;
+    case MS_OP_LOOP:
+      if (num_loops_ >= MAX_SCRIPT_LOOP_DEPTH) return false;
+      loops_[num_loops_].start = address_;
+      loops_[num_loops_].count = readByte(args);
+      ++num_loops_;
+      break;
+    case MS_OP_END_LOOP: {
+      if (num_loops_ == 0) return false;
+      Loop& loop = loops_[num_loops_ - 1];
+      if (loop.count == 0 || --loop.count > 0) {
+        address_ = loop.start;
+      } else {
+        --num_loops_;
+      }
+      break;
+    }
+    case MS_OP_IF_OBSTACLE:
+      if ((one_.readObstacleSensors() & readByte(args)) == 0) {
+        skipBlock(true);
+      }
+      break;
+    case MS_OP_IF_BUTTON:
+      if (one_.readButton() != readByte(args)) {
+        skipBlock(true);
+      }
+      break;
+    case MS_OP_ELSE:
+      // Reached at the end of the block of a true condition
+      skipBlock(false);
+      break;
+    case MS_OP_END_IF:
+      break;
+  }
+  return true;
+}
+
+void MotionScript::skipBlock(const bool stop_at_else) {
+  int depth = 0;
+  while (address_ < size_) {
+    const byte opcode = readByte(address_);
+    const int num_arg_bytes = getNumArgBytes(opcode);
+    if (num_arg_bytes < 0) return;
+    address_ += 1 + num_arg_bytes;
+    if (opcode == MS_OP_IF_OBSTACLE || opcode == MS_OP_IF_BUTTON) {
+      ++depth;
+    } else if (opcode == MS_OP_END_IF) {
+      if (depth == 0) return;
+      --depth;
+    } else if (opcode == MS_OP_ELSE && stop_at_else && depth == 0) {
+      return;
+    }
+  }
+}
+
+int MotionScript::getNumArgBytes(const byte opcode) {
+  switch (opcode) {
+    case MS_OP_END:
+    case MS_OP_END_LOOP:
+    case MS_OP_ELSE:
+    case MS_OP_END_IF:
+      return 0;
+    case MS_OP_LOOP:
+    case MS_OP_IF_OBSTACLE:
+    case MS_OP_IF_BUTTON:
+      return 1;
+    case MS_OP_SPEED:
+    case MS_OP_LINE:
+    case MS_OP_ROTATE:
+    case MS_OP_WAIT:
+      return 2;
+    case MS_OP_ARC:
+      return 4;
+    default:
+      return -1;
+  }
+}
+
+byte MotionScript::readByte(const int address) const {
+  switch (storage_) {
+    case Storage::FLASH:
+      return pgm_read_byte(&script_[address]);
+    case Storage::EEPROM:
+      return EEPROM.read(eeprom_address_ + address);
+    default:
+      return script_[address];
+  }
+}
+
+int MotionScript::readWord(const int address) const {
+  return (int16_t)word(readByte(address), readByte(address + 1));
+}
+
+void MotionScript::stop(const bool error) {
+  mg_.abort();
+  activity_ = Activity::NONE;
+  running_ = false;
+  error_ = error;
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "MotionGenerator.h"
+
+#define MAX_SCRIPT_LOOP_DEPTH 4    // Nested loops allowed in a script
+#define MAX_SCRIPT_BLOCK_DEPTH 8   // Nested loops and conditions in a script
+#define MOTION_SCRIPT_EEPROM_ADDRESS 256  // Default EEPROM address of scripts
+#define MOTION_SCRIPT_EEPROM_SIZE 256  // EEPROM bytes of a script and its size
+
+// Opcodes of the motion script bytecode
+#define MS_OP_END 0x00
+#define MS_OP_SPEED 0x01
+#define MS_OP_LINE 0x02
+#define MS_OP_ARC 0x03
+#define MS_OP_ROTATE 0x04
+#define MS_OP_WAIT 0x05
+#define MS_OP_LOOP 0x06
+#define MS_OP_END_LOOP 0x07
+#define MS_OP_IF_OBSTACLE 0x08
+#define MS_OP_IF_BUTTON 0x09
+#define MS_OP_ELSE 0x0A
+#define MS_OP_END_IF 0x0B
+
+// Helpers to write scripts as byte array initializers. Arguments are 16 bit
+// values stored with the most significant byte first.
+#define MS_WORD(value) (byte)(((int)(value) >> 8) & 0xFF), (byte)((value)&0xFF)
+#define MS_END MS_OP_END
+#define MS_SPEED(speed_mmps) MS_OP_SPEED, MS_WORD(speed_mmps)
+#define MS_LINE(distance_mm) MS_OP_LINE, MS_WORD(distance_mm)
+#define MS_ARC(angle_deg, radius_mm) \
+  MS_OP_ARC, MS_WORD(angle_deg), MS_WORD(radius_mm)
+#define MS_ROTATE(angle_deg) MS_OP_ROTATE, MS_WORD(angle_deg)
+#define MS_WAIT(time_ms) MS_OP_WAIT, MS_WORD(time_ms)
+#define MS_LOOP(count) MS_OP_LOOP, (byte)(count)
+#define MS_END_LOOP MS_OP_END_LOOP
+#define MS_IF_OBSTACLE(mask) MS_OP_IF_OBSTACLE, (byte)(mask)
+#define MS_IF_BUTTON(button) MS_OP_IF_BUTTON, (byte)(button)
+#define MS_ELSE MS_OP_ELSE
+#define MS_END_IF MS_OP_END_IF
+
+/**
+ * @class MotionScript
+ * @brief Runs motion scripts written in a compact bytecode, without blocking.
+ *
+ * A script is a sequence of instructions, each made of an opcode byte
+ * followed by its arguments:
+ * - MS_SPEED(speed_mmps): speed of the following motions (200 by default).
+ * - MS_LINE(distance_mm): moves straight, backwards if negative.
+ * - MS_ARC(angle_deg, radius_mm): describes an arc, counterclockwise if the
+ *   angle is positive.
+ * - MS_ROTATE(angle_deg): rotates in place.
+ * - MS_WAIT(time_ms): stays still for the given time.
+ * - MS_LOOP(count) ... MS_END_LOOP: repeats the instructions count times, or
+ *   forever if count is 0.
+ * - MS_IF_OBSTACLE(mask) ... [MS_ELSE ...] MS_END_IF: runs the first block if
+ *   any of the obstacle sensors in mask (1 left, 2 right) detects an obstacle.
+ * - MS_IF_BUTTON(button) ... [MS_ELSE ...] MS_END_IF: runs the first block if
+ *   the given push button is pressed.
+ * - MS_END: ends the script.
+ *
+ * Scripts can be stored in RAM, PROGMEM or EEPROM. They can be received over
+ * a serial port as the script size (2 bytes, most significant first), the
+ * script bytes and the 8 bit sum of the script bytes.
+ */
+class MotionScript {
+ public:
+  /**
+   * @brief Storage of the script.
+   */
+  enum class Storage {
+    RAM,    ///< Array in RAM.
+    FLASH,  ///< Array in PROGMEM.
+    EEPROM  ///< Saved with saveToEeprom.
+  };
+
+  /**
+   * @brief Constructor for MotionScript.
+   * @param one Reference to BnrOneAPlus object.
+   * @param mg Motion generator that executes the motions.
+   */
+  MotionScript(const BnrOneAPlus& one, MotionGenerator& mg);
+
+  /**
+   * @brief Sets the script to run. The array is not copied and must remain
+   * valid while the script runs.
+   * @param script Bytecode of the script.
+   * @param size Size of the script in bytes.
+   * @param in_progmem true if the script is stored in PROGMEM.
+   */
+  void setScript(const byte script[],
+                 const int size,
+                 const bool in_progmem = false);
+
+  /**
+   * @brief Sets the script to run from the one saved in EEPROM.
+   * @param eeprom_address EEPROM address the script was saved at.
+   * @return false if no script is saved at that address.
+   */
+  bool setScriptFromEeprom(
+      const int eeprom_address = MOTION_SCRIPT_EEPROM_ADDRESS);
+
+  /**
+   * @brief Checks that the instructions of the script are complete, the
+   * opcodes known and the loops and conditions properly nested.
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Starts running the script from the beginning. Call step() until
+   * it returns false.
+   * @return false if the script is not valid.
+   */
+  bool start();
+
+  /**
+   * @brief Steps the motion in progress and runs the next instructions once
+   * it is complete.
+   * @return true while the script is running, false when it is done.
+   */
+  bool step();
+
+  /**
+   * @brief Runs the whole script. Blocks until the script ends.
+   */
+  void run();
+
+  /**
+   * @brief Checks if the script ended or was aborted.
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Checks if the script was stopped by an invalid instruction.
+   */
+  bool hasError() const;
+
+  /**
+   * @brief Brakes the robot and stops the script.
+   */
+  void abort();
+
+  /**
+   * @brief Receives a script sent over a serial port.
+   * @param stream Serial port to read from.
+   * @param buffer Buffer where the script is stored.
+   * @param max_size Size of the buffer.
+   * @param timeout_ms Time to wait for each part of the script.
+   * @return Size of the script, or -1 on timeout, overflow or bad checksum.
+   */
+  static int receiveScript(Stream& stream,
+                           byte buffer[],
+                           const int max_size,
+                           const unsigned long timeout_ms = 5000);
+
+  /**
+   * @brief Saves a script in EEPROM, preceded by its size. The script and
+   * its size must fit in MOTION_SCRIPT_EEPROM_SIZE bytes, so that they do
+   * not overwrite the trajectory recordings saved after them.
+   * @param script Bytecode of the script.
+   * @param size Size of the script in bytes.
+   * @param eeprom_address First EEPROM address of the script.
+   * @return false if the script does not fit.
+   */
+  static bool saveToEeprom(
+      const byte script[],
+      const int size,
+      const int eeprom_address = MOTION_SCRIPT_EEPROM_ADDRESS);
+
+ private:
+  /**
+   * @brief What the script is waiting for before the next instruction.
+   */
+  enum class Activity {
+    NONE,    ///< Ready for the next instruction.
+    MOTION,  ///< A motion in progress.
+    WAIT     ///< A wait instruction.
+  };
+
+  /**
+   * @brief State of a loop in progress.
+   */
+  struct Loop {
+    int start;   ///< Address of the first instruction of the loop.
+    byte count;  ///< Iterations left, 0 to repeat forever.
+  };
+
+  /**
+   * @brief Runs instructions until one starts a motion or a wait, the
+   * script ends or MAX_INSTRUCTIONS_PER_STEP instructions have run.
+   */
+  void runInstructions();
+
+  /**
+   * @brief Runs the instruction at the current address.
+   * @return false if the instruction is invalid.
+   */
+  bool runInstruction();
+
+  /**
+   * @brief Moves the current address past the matching MS_ELSE or MS_END_IF.
+   * @param stop_at_else true to stop after MS_ELSE, false to stop only after
+   * MS_END_IF.
+   */
+  void skipBlock(const bool stop_at_else);
+
+  /**
+   * @brief Gets the number of argument bytes of an opcode.
+   * @return Number of bytes, or -1 if the opcode is unknown.
+   */
+  static int getNumArgBytes(const byte opcode);
+
+  /**
+   * @brief Reads a byte of the script.
+   */
+  byte readByte(const int address) const;
+
+  /**
+   * @brief Reads a 16 bit argument of the script.
+   */
+  int readWord(const int address) const;
+
+  /**
+   * @brief Stops the script and brakes the robot.
+   * @param error true if stopped by an invalid instruction.
+   */
+  void stop(const bool error);
+
+  const BnrOneAPlus& one_;             ///< Reference to BnrOneAPlus object.
+  MotionGenerator& mg_;                ///< Executes the motions.
+  const byte* script_;                 ///< Script in RAM or PROGMEM.
+  Storage storage_;                    ///< Storage of the script.
+  int eeprom_address_;                 ///< Address of the script in EEPROM.
+  int size_;                           ///< Size of the script in bytes.
+  int address_;                        ///< Address of the next instruction.
+  float speed_mmps_;                   ///< Speed of the motions.
+  Loop loops_[MAX_SCRIPT_LOOP_DEPTH];  ///< Loops in progress.
+  byte num_loops_;                     ///< Number of loops in progress.
+  Activity activity_;                  ///< What the script is waiting for.
+  unsigned long wait_start_ms_;        ///< Start time of the wait.
+  unsigned int wait_ms_;               ///< Duration of the wait.
+  bool running_;                       ///< Whether the script is running.
+  bool error_;                         ///< Whether stopped by an error.
+};
@@ -0,0 +1,242 @@
+#include "MotorIdentification.h"
+
+#define SAMPLE_PERIOD_US 5000      // Encoder sampling period
+#define RAMP_SAMPLES_PER_STEP 4    // Dead band ramp rises 1 % every 20 ms
+#define MAX_DEAD_BAND 60           // Duty cycle at which a still wheel fails
+#define MOVING_PULSES 2            // Pulses per sample of a moving wheel
+#define STEP_SAMPLES 50            // Samples per staircase level (250 ms)
+#define STEADY_SAMPLES 20          // Samples averaged at the end of a level
+#define CHIRP_SAMPLES 400          // Samples of the chirp (2 s)
+#define CHIRP_START_HZ 0.5         // Chirp start frequency
+#define CHIRP_END_HZ 8.0           // Chirp end frequency
+#define CO_PROCESSOR_PERIOD_MS 25  // Control period used by setMotors
+
+MotorIdentification::MotorIdentification(const BnrOneAPlus& one)
+    : one_(one),
+      left_model_({0, 0, 0}),
+      right_model_({0, 0, 0}),
+      moving_power_(0),
+      max_speed_pulses_(0),
+      pwm_table_(PwmTable()),
+      last_sample_us_(0) {
+  for (byte i = 0; i < NUM_STAIRCASE_LEVELS; ++i) {
+    left_speeds_[i] = 0;
+    right_speeds_[i] = 0;
+  }
+}
+
+bool MotorIdentification::identify() {
+  last_sample_us_ = micros();
+  sample(0, 0);  // Discard the pulses counted before the start
+  if (!findStartPowers()) {
+    one_.stop();
+    return false;
+  }
+  measureStaticCurves();
+  left_model_.dead_band =
+      computeDeadBand(left_model_.dead_band, left_speeds_);
+  right_model_.dead_band =
+      computeDeadBand(right_model_.dead_band, right_speeds_);
+  fitTimeConstants();
+  one_.stop();
+
+  left_model_.gain_pps = computeGain(left_model_.dead_band, left_speeds_);
+  right_model_.gain_pps = computeGain(right_model_.dead_band, right_speeds_);
+  buildPwmTable();
+  return true;
+}
+
+const MotorModel& MotorIdentification::getLeftModel() const {
+  return left_model_;
+}
+
+const MotorModel& MotorIdentification::getRightModel() const {
+  return right_model_;
+}
+
+int MotorIdentification::getMovingPower() const { return moving_power_; }
+
+int MotorIdentification::getMaxSpeedPulses() const {
+  return max_speed_pulses_;
+}
+
+const PwmTable& MotorIdentification::getPwmTable() const {
+  return pwm_table_;
+}
+
+MotorIdentification::Speeds MotorIdentification::sample(
+    const int left_duty_cycle,
+    const int right_duty_cycle) {
+  while (micros() - last_sample_us_ < SAMPLE_PERIOD_US) {
+  }
+  last_sample_us_ += SAMPLE_PERIOD_US;
+
+  int left_pulses = 0;
+  int right_pulses = 0;
+  one_.readAndResetEncoders(left_pulses, right_pulses);
+  one_.moveDutyCycles(left_duty_cycle, right_duty_cycle);
+  return {(float)left_pulses, (float)right_pulses};
+}
+
+bool MotorIdentification::findStartPowers() {
+  bool left_moving = false;
+  bool right_moving = false;
+  for (int i = 0; i <= MAX_DEAD_BAND * RAMP_SAMPLES_PER_STEP; ++i) {
+    const int duty_cycle = i / RAMP_SAMPLES_PER_STEP;
+    const Speeds speeds = sample(duty_cycle, duty_cycle);
+    // Encoders counting in reverse
+    if (speeds.left <= -MOVING_PULSES || speeds.right <= -MOVING_PULSES) {
+      return false;
+    }
+    if (!left_moving && speeds.left >= MOVING_PULSES) {
+      left_moving = true;
+      left_model_.dead_band = duty_cycle;
+    }
+    if (!right_moving && speeds.right >= MOVING_PULSES) {
+      right_moving = true;
+      right_model_.dead_band = duty_cycle;
+    }
+    if (left_moving && right_moving) {
+      moving_power_ = duty_cycle;
+      return true;
+    }
+  }
+  return false;
+}
+
+void MotorIdentification::measureStaticCurves() {
+  for (byte level = 0; level < NUM_STAIRCASE_LEVELS; ++level) {
+    const int duty_cycle = (level + 1) * 100 / NUM_STAIRCASE_LEVELS;
+    float left_sum = 0;
+    float right_sum = 0;
+    for (int i = 0; i < STEP_SAMPLES; ++i) {
+      const Speeds speeds = sample(duty_cycle, duty_cycle);
+      if (i >= STEP_SAMPLES - STEADY_SAMPLES) {
+        left_sum += speeds.left;
+        right_sum += speeds.right;
+      }
+    }
+    left_speeds_[level] = left_sum / STEADY_SAMPLES;
+    right_speeds_[level] = right_sum / STEADY_SAMPLES;
+  }
+}
+
+void MotorIdentification::fitTimeConstants() {
+  // The chirp swings between the larger dead band and full power
+  const float dead_band = max(left_model_.dead_band, right_model_.dead_band);
+  const float offset = (dead_band + 100) / 2.0;
+  const float amplitude = 0.8 * (100 - dead_band) / 2.0;
+  const float period_s = SAMPLE_PERIOD_US / 1000000.0;
+  const float sweep_hzps =
+      (CHIRP_END_HZ - CHIRP_START_HZ) / (CHIRP_SAMPLES * period_s);
+
+  FitSums left_sums = {0, 0, 0, 0, 0};
+  FitSums right_sums = {0, 0, 0, 0, 0};
+  float phase_rad = 0;
+  int duty_cycle = (int)offset;
+  Speeds speeds = sample(duty_cycle, duty_cycle);
+  for (int i = 0; i < CHIRP_SAMPLES; ++i) {
+    const float frequency_hz = CHIRP_START_HZ + sweep_hzps * i * period_s;
+    phase_rad += TWO_PI * frequency_hz * period_s;
+    const int next_duty_cycle = (int)(offset + amplitude * sin(phase_rad));
+    const Speeds next_speeds = sample(next_duty_cycle, next_duty_cycle);
+    // The speed of a period depends on the duty cycle applied at its start
+    addToFit(left_sums,
+             duty_cycle - left_model_.dead_band,
+             speeds.left,
+             next_speeds.left);
+    addToFit(right_sums,
+             duty_cycle - right_model_.dead_band,
+             speeds.right,
+             next_speeds.right);
+    duty_cycle = next_duty_cycle;
+    speeds = next_speeds;
+  }
+  left_model_.time_constant_ms = computeTimeConstantMs(left_sums);
+  right_model_.time_constant_ms = computeTimeConstantMs(right_sums);
+}
+
+float MotorIdentification::computeDeadBand(const float start_power,
+                                           const float speeds[]) const {
+  // Extrapolate the two lowest levels at which the wheel turns to zero speed
+  for (byte level = 0; level < NUM_STAIRCASE_LEVELS - 1; ++level) {
+    const float speed = speeds[level];
+    const float next_speed = speeds[level + 1];
+    if (speed <= 0 || next_speed <= speed) continue;
+    const float duty_cycle = (level + 1) * 100 / NUM_STAIRCASE_LEVELS;
+    const float slope = (next_speed - speed) / (100 / NUM_STAIRCASE_LEVELS);
+    return constrain(duty_cycle - speed / slope, 0, start_power);
+  }
+  return start_power;
+}
+
+float MotorIdentification::computeGain(const float dead_band,
+                                       const float speeds[]) const {
+  // Least squares slope through the dead band
+  float xx = 0;
+  float xv = 0;
+  for (byte level = 0; level < NUM_STAIRCASE_LEVELS; ++level) {
+    const float x = (level + 1) * 100 / NUM_STAIRCASE_LEVELS - dead_band;
+    if (x <= 0) continue;
+    xx += x * x;
+    xv += x * speeds[level];
+  }
+  const float samples_per_sec = 1000000.0 / SAMPLE_PERIOD_US;
+  return xx > 0 ? samples_per_sec * xv / xx : 0;
+}
+
+void MotorIdentification::addToFit(FitSums& sums,
+                                   const float input,
+                                   const float speed,
+                                   const float next_speed) const {
+  sums.uu += input * input;
+  sums.uv += input * speed;
+  sums.vv += speed * speed;
+  sums.un += input * next_speed;
+  sums.vn += speed * next_speed;
+}
+
+float MotorIdentification::computeTimeConstantMs(const FitSums& sums) const {
+  // next_speed = a * speed + b * input, with a = exp(-period / tau)
+  const float determinant = sums.vv * sums.uu - sums.uv * sums.uv;
+  if (determinant <= 0) return 0;
+  const float a = (sums.vn * sums.uu - sums.un * sums.uv) / determinant;
+  if (a <= 0 || a >= 1) return 0;
+  return -(SAMPLE_PERIOD_US / 1000.0) / log(a);
+}
+
+byte MotorIdentification::findDutyCycle(const float dead_band,
+                                        const float speeds[],
+                                        const float speed) const {
+  // Walk the static curve from the dead band, ignoring drops due to noise
+  float previous_duty_cycle = dead_band;
+  float previous_speed = 0;
+  for (byte level = 0; level < NUM_STAIRCASE_LEVELS; ++level) {
+    const float duty_cycle = (level + 1) * 100 / NUM_STAIRCASE_LEVELS;
+    if (duty_cycle <= dead_band || speeds[level] <= previous_speed) continue;
+    if (speeds[level] >= speed) {
+      const float fraction =
+          (speed - previous_speed) / (speeds[level] - previous_speed);
+      return (byte)round(previous_duty_cycle +
+                         fraction * (duty_cycle - previous_duty_cycle));
+    }
+    previous_duty_cycle = duty_cycle;
+    previous_speed = speeds[level];
+  }
+  return 100;
+}
+
+void MotorIdentification::buildPwmTable() {
+  const byte top = NUM_STAIRCASE_LEVELS - 1;
+  const float top_speed = min(left_speeds_[top], right_speeds_[top]);
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    const float speed = top_speed * i / (PWM_TABLE_SIZE - 1);
+    pwm_table_.setEntry(
+        i,
+        findDutyCycle(left_model_.dead_band, left_speeds_, speed),
+        findDutyCycle(right_model_.dead_band, right_speeds_, speed));
+  }
+
+  max_speed_pulses_ =
+      (int)(top_speed * CO_PROCESSOR_PERIOD_MS * 1000.0 / SAMPLE_PERIOD_US);
+}
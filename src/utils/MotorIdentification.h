@@ -0,0 +1,169 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "PwmTable.h"
+
+#define NUM_STAIRCASE_LEVELS 10  // Duty cycles 10, 20, ..., 100
+
+/**
+ * @brief First-order model of a motor driven by raw duty cycles, identified
+ * with the wheel turning freely.
+ */
+struct MotorModel {
+  float dead_band;         ///< Duty cycle at which the wheel starts to move.
+  float gain_pps;          ///< Speed per duty cycle above the dead band.
+  float time_constant_ms;  ///< Time to reach 63 % of a speed step.
+};
+
+/**
+ * @class MotorIdentification
+ * @brief Identifies a model of each motor in a few seconds and computes the
+ * motor settings of the co-processor and a linearising PWM table.
+ *
+ * The wheels must turn freely, without touching the floor. The duty cycles
+ * are sent with BnrOneAPlus::moveDutyCycles(), so any PwmTable or
+ * CommandShaper set on the robot is bypassed. The encoders are sampled every
+ * 5 ms while three duty cycle signals are applied:
+ *  - a slow ramp, until each wheel starts to move,
+ *  - a staircase of NUM_STAIRCASE_LEVELS steps, whose steady speeds give the
+ *    static curve of each motor, its dead band and its gain,
+ *  - a chirp sweeping from 0.5 to 8 Hz, to which a discrete first-order
+ *    model is fitted by least squares, giving the time constant.
+ *
+ * The static curves are inverted into a PwmTable whose speeds are
+ * percentages of the top speed of the slower motor. Only forward motion is
+ * identified, so the table assumes symmetric motors.
+ */
+class MotorIdentification {
+ public:
+  /**
+   * @brief Constructor for MotorIdentification.
+   * @param one Reference to BnrOneAPlus object.
+   */
+  MotorIdentification(const BnrOneAPlus& one);
+
+  /**
+   * @brief Runs the identification, which takes about 6 seconds.
+   * @return true if both motors were identified, false if a wheel did not
+   * move or its encoder counts in reverse.
+   */
+  bool identify();
+
+  /**
+   * @brief Gets the model of the left motor.
+   */
+  const MotorModel& getLeftModel() const;
+
+  /**
+   * @brief Gets the model of the right motor.
+   */
+  const MotorModel& getRightModel() const;
+
+  /**
+   * @brief Gets the moving power setting for BnrOneAPlus::setMotors(), the
+   * duty cycle at which both wheels move.
+   */
+  int getMovingPower() const;
+
+  /**
+   * @brief Gets the max speed pulses setting for BnrOneAPlus::setMotors(),
+   * the pulses of the slower wheel at full power per 25 ms control period of
+   * the co-processor.
+   */
+  int getMaxSpeedPulses() const;
+
+  /**
+   * @brief Gets the linearising PWM table.
+   */
+  const PwmTable& getPwmTable() const;
+
+ private:
+  /**
+   * @brief Sampled speeds of both wheels.
+   */
+  struct Speeds {
+    float left;   ///< Left wheel pulses per sample.
+    float right;  ///< Right wheel pulses per sample.
+  };
+
+  /**
+   * @brief Least squares sums of the first-order model fit of a wheel.
+   */
+  struct FitSums {
+    float uu;  ///< Sum of input squared.
+    float uv;  ///< Sum of input times speed.
+    float vv;  ///< Sum of speed squared.
+    float un;  ///< Sum of input times next speed.
+    float vn;  ///< Sum of speed times next speed.
+  };
+
+  /**
+   * @brief Applies duty cycles and waits for the next sample.
+   * @return Speeds of the sample period.
+   */
+  Speeds sample(const int left_duty_cycle, const int right_duty_cycle);
+
+  /**
+   * @brief Ramps the duty cycles up until both wheels move, storing the
+   * duty cycle at which each wheel started as its dead band.
+   */
+  bool findStartPowers();
+
+  /**
+   * @brief Measures the steady speed at every staircase level.
+   */
+  void measureStaticCurves();
+
+  /**
+   * @brief Fits the time constants to the response to a chirp.
+   */
+  void fitTimeConstants();
+
+  /**
+   * @brief Computes the dead band of a motor from its static curve. It is
+   * lower than the duty cycle at which the wheel starts, because of the
+   * static friction and the lag of the ramp.
+   */
+  float computeDeadBand(const float start_power, const float speeds[]) const;
+
+  /**
+   * @brief Computes the gain of a motor from its static curve.
+   */
+  float computeGain(const float dead_band, const float speeds[]) const;
+
+  /**
+   * @brief Adds a sample to the least squares sums of a wheel.
+   */
+  void addToFit(FitSums& sums,
+                const float input,
+                const float speed,
+                const float next_speed) const;
+
+  /**
+   * @brief Computes the time constant from the least squares sums.
+   */
+  float computeTimeConstantMs(const FitSums& sums) const;
+
+  /**
+   * @brief Finds the duty cycle of a speed by inverting a static curve.
+   */
+  byte findDutyCycle(const float dead_band,
+                     const float speeds[],
+                     const float speed) const;
+
+  /**
+   * @brief Builds the PWM table and the motor settings from the models.
+   */
+  void buildPwmTable();
+
+  const BnrOneAPlus& one_;                    ///< Reference to BnrOneAPlus.
+  MotorModel left_model_;                     ///< Left motor model.
+  MotorModel right_model_;                    ///< Right motor model.
+  float left_speeds_[NUM_STAIRCASE_LEVELS];   ///< Left static curve.
+  float right_speeds_[NUM_STAIRCASE_LEVELS];  ///< Right static curve.
+  int moving_power_;                          ///< setMotors moving power.
+  int max_speed_pulses_;                      ///< setMotors max pulses.
+  PwmTable pwm_table_;                        ///< Linearising PWM table.
+  unsigned long last_sample_us_;              ///< Time of the last sample.
+};
@@ -0,0 +1,92 @@
+#include "OdometryCalibration.h"
+
+#include "EepromUtils.h"
+#include "MotionGenerator.h"
+
+#define EEPROM_SCALE 100.0          // Values are stored in hundredths of mm
+#define DIAMETER_TOLERANCE 0.1      // Accepted deviation from nominal diameter
+#define TRACK_WIDTH_TOLERANCE 0.15  // Accepted deviation from nominal axis
+
+OdometryCalibration::OdometryCalibration(const BnrOneAPlus& one,
+                                         const RobotParams& robot_params,
+                                         const byte eeprom_address)
+    : one_(one), robot_params_(robot_params), eeprom_address_(eeprom_address) {}
+
+void OdometryCalibration::driveSquare(const float side_mm,
+                                      const bool clockwise,
+                                      const float speed) const {
+  const MotionGenerator mg(one_, 1.0, robot_params_);
+  const float angle_deg = clockwise ? -90 : 90;
+  for (int i = 0; i < 4; ++i) {
+    mg.moveStraightAtSpeed(side_mm, speed);
+    delay(500);  // Let the robot settle before turning
+    mg.rotateAngleDegAtSpeed(angle_deg, speed);
+    delay(500);
+  }
+}
+
+RobotParams OdometryCalibration::computeCorrectedParams(
+    const float side_mm,
+    const float x_error_cw_mm,
+    const float x_error_ccw_mm) const {
+  // Turn error caused by the track width (type B) and curvature of the
+  // straight legs caused by the wheel diameter ratio (type A)
+  const float alpha_rad = (x_error_cw_mm + x_error_ccw_mm) / (-4.0 * side_mm);
+  const float beta_rad = (x_error_cw_mm - x_error_ccw_mm) / (-4.0 * side_mm);
+
+  const float track_width_mm = robot_params_.track_width_mm;
+  float diameter_ratio_error = 1.0;  // Actual right / left diameter ratio
+  if (beta_rad != 0) {
+    const float radius_mm = (side_mm / 2.0) / sin(beta_rad / 2.0);
+    diameter_ratio_error = (radius_mm + track_width_mm / 2.0) /
+                           (radius_mm - track_width_mm / 2.0);
+  }
+  const float track_width_error = HALF_PI / (HALF_PI - alpha_rad);
+
+  const float left_mm = robot_params_.left_wheel_diameter_mm;
+  const float right_mm = robot_params_.right_wheel_diameter_mm;
+  const float mean_diameter_mm = (left_mm + right_mm) / 2.0;
+  const float ratio = diameter_ratio_error * (right_mm / left_mm);
+
+  RobotParams params = robot_params_;
+  params.left_wheel_diameter_mm = 2.0 * mean_diameter_mm / (ratio + 1.0);
+  params.right_wheel_diameter_mm =
+      2.0 * mean_diameter_mm / ((1.0 / ratio) + 1.0);
+  params.track_width_mm = track_width_error * track_width_mm;
+  return params;
+}
+
+void OdometryCalibration::save(const RobotParams& params) const {
+  saveEepromWord(eeprom_address_,
+                 (int)(params.left_wheel_diameter_mm * EEPROM_SCALE));
+  saveEepromWord(eeprom_address_ + 2,
+                 (int)(params.right_wheel_diameter_mm * EEPROM_SCALE));
+  saveEepromWord(eeprom_address_ + 4,
+                 (int)(params.track_width_mm * EEPROM_SCALE));
+}
+
+RobotParams OdometryCalibration::load() const {
+  const float left_mm = loadEepromWord(eeprom_address_) / EEPROM_SCALE;
+  const float right_mm = loadEepromWord(eeprom_address_ + 2) / EEPROM_SCALE;
+  const float track_width_mm =
+      loadEepromWord(eeprom_address_ + 4) / EEPROM_SCALE;
+
+  RobotParams params = robot_params_;
+  const float diameter_mm = robot_params_.wheel_diameter_mm;
+  if (isWithinTolerance(left_mm, diameter_mm, DIAMETER_TOLERANCE) &&
+      isWithinTolerance(right_mm, diameter_mm, DIAMETER_TOLERANCE) &&
+      isWithinTolerance(track_width_mm,
+                        robot_params_.axis_length_mm,
+                        TRACK_WIDTH_TOLERANCE)) {
+    params.left_wheel_diameter_mm = left_mm;
+    params.right_wheel_diameter_mm = right_mm;
+    params.track_width_mm = track_width_mm;
+  }
+  return params;
+}
+
+bool OdometryCalibration::isWithinTolerance(const float value,
+                                            const float reference,
+                                            const float tolerance) const {
+  return abs(value - reference) <= reference * tolerance;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "RobotParams.h"
+
+#define ODOMETRY_EEPROM_ADDRESS 140  // Default EEPROM address of calibrations
+
+/**
+ * @class OdometryCalibration
+ * @brief Calibrates the wheel diameters and the track width with the UMBmark
+ * procedure (Borenstein and Feng, 1996).
+ *
+ * The robot drives a square clockwise and counterclockwise. For each run the
+ * closure error is measured: how far ahead (positive) or behind (negative) of
+ * the start point the robot stops, along its initial heading. The mean errors
+ * of both directions separate the wheel diameter ratio error from the track
+ * width error, and the corrected values are stored in EEPROM.
+ */
+class OdometryCalibration {
+ public:
+  /**
+   * @brief Constructor for OdometryCalibration.
+   * @param one Reference to BnrOneAPlus object.
+   * @param robot_params Robot params used to drive the test squares.
+   * @param eeprom_address First EEPROM address of the stored values (6 bytes).
+   */
+  OdometryCalibration(const BnrOneAPlus& one,
+                      const RobotParams& robot_params = RobotParams(),
+                      const byte eeprom_address = ODOMETRY_EEPROM_ADDRESS);
+
+  /**
+   * @brief Drives a square starting and finishing at the current position.
+   * @param side_mm Length of each side in millimeters.
+   * @param clockwise true for right turns, false for left turns.
+   * @param speed Speed in millimeters per second.
+   */
+  void driveSquare(const float side_mm,
+                   const bool clockwise,
+                   const float speed = 150) const;
+
+  /**
+   * @brief Computes the corrected robot params from the closure errors.
+   * @param side_mm Length of the side of the squares in millimeters.
+   * @param x_error_cw_mm Mean closure error of the clockwise runs along the
+   * initial heading, in millimeters.
+   * @param x_error_ccw_mm Mean closure error of the counterclockwise runs
+   * along the initial heading, in millimeters.
+   * @return Robot params with calibrated wheel diameters and track width.
+   */
+  RobotParams computeCorrectedParams(const float side_mm,
+                                     const float x_error_cw_mm,
+                                     const float x_error_ccw_mm) const;
+
+  /**
+   * @brief Saves the calibrated wheel diameters and track width in EEPROM.
+   * @param params Calibrated robot params.
+   */
+  void save(const RobotParams& params) const;
+
+  /**
+   * @brief Loads the calibrated wheel diameters and track width from EEPROM.
+   * @return The robot params given in the constructor with the calibrated
+   * values, or unchanged if nothing valid is stored.
+   */
+  RobotParams load() const;
+
+ private:
+  /**
+   * @brief Checks if a value is within a relative tolerance of a reference.
+   */
+  bool isWithinTolerance(const float value,
+                         const float reference,
+                         const float tolerance) const;
+
+  const BnrOneAPlus& one_;    ///< Reference to BnrOneAPlus object.
+  RobotParams robot_params_;  ///< Robot params used to drive the squares.
+  byte eeprom_address_;       ///< First EEPROM address of the stored values.
+};
@@ -0,0 +1,207 @@
+#include "PathFollower.h"
+
+#include "FastTrig.h"
+
+#define CONTROL_PERIOD_US 5000
+#define GOAL_TOLERANCE_MM 5  // Distance to the end at which the robot stops
+
+PathFollower::PathFollower(const BnrOneAPlus& one,
+                           const RobotParams& robot_params)
+    : one_(one),
+      cut_(ControlUtils(robot_params)),
+      track_width_mm_(robot_params.track_width_mm),
+      max_accel_mmps2_(robot_params.max_accel_mmps2),
+      waypoints_(nullptr),
+      num_waypoints_(0),
+      in_progmem_(false),
+      path_length_mm_(0),
+      look_ahead_mm_(150),
+      max_speed_mmps_(300),
+      max_lateral_accel_mmps2_(500),
+      min_speed_mmps_(30),
+      pose_(Pose()),
+      segment_(0),
+      segment_start_mm_(0),
+      remaining_mm_(0),
+      speed_mmps_(0),
+      running_(false),
+      last_step_us_(0) {}
+
+void PathFollower::setPath(const Waypoint waypoints[],
+                           const int num_waypoints,
+                           const bool in_progmem) {
+  waypoints_ = waypoints;
+  num_waypoints_ = num_waypoints;
+  in_progmem_ = in_progmem;
+  path_length_mm_ = 0;
+  for (int i = 0; i < num_waypoints_ - 1; ++i) {
+    path_length_mm_ += getSegmentLength(i);
+  }
+}
+
+void PathFollower::setLookAheadMm(const float look_ahead_mm) {
+  look_ahead_mm_ = abs(look_ahead_mm);
+}
+
+void PathFollower::setSpeedLimits(const float max_speed_mmps,
+                                  const float max_lateral_accel_mmps2,
+                                  const float min_speed_mmps) {
+  max_speed_mmps_ = abs(max_speed_mmps);
+  max_lateral_accel_mmps2_ = abs(max_lateral_accel_mmps2);
+  min_speed_mmps_ = min(abs(min_speed_mmps), max_speed_mmps_);
+}
+
+void PathFollower::start(const Pose& start_pose) {
+  // Discard the pulses counted before the start
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.readAndResetEncoders(left_encoder, right_encoder);
+  pose_ = start_pose;
+  segment_ = 0;
+  segment_start_mm_ = 0;
+  remaining_mm_ = path_length_mm_;
+  speed_mmps_ = 0;
+  running_ = (num_waypoints_ >= 2);
+  last_step_us_ = micros() - CONTROL_PERIOD_US;
+}
+
+bool PathFollower::step() {
+  if (!running_) return false;
+
+  const unsigned long now_us = micros();
+  if (now_us - last_step_us_ < CONTROL_PERIOD_US) return true;
+  last_step_us_ = now_us;
+
+  const float along_mm = projectOnPath();
+  remaining_mm_ = path_length_mm_ - (segment_start_mm_ + along_mm);
+  if (remaining_mm_ <= GOAL_TOLERANCE_MM) {
+    abort();
+    return false;
+  }
+
+  float target_x_mm = 0;
+  float target_y_mm = 0;
+  findLookAheadPoint(along_mm, target_x_mm, target_y_mm);
+  const float curvature = computePursuitCurvature(target_x_mm, target_y_mm);
+  speed_mmps_ = computeSpeed(curvature, remaining_mm_);
+
+  const auto wheel_speeds_mmps =
+      cut_.computeWheelSpeeds(speed_mmps_, speed_mmps_ * curvature);
+  const auto wheel_speeds_rpm = cut_.computeSpeedsRpm(wheel_speeds_mmps);
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.moveRpmGetEncoders(wheel_speeds_rpm.getLeft(),
+                          wheel_speeds_rpm.getRight(),
+                          left_encoder,
+                          right_encoder);
+  updatePose(left_encoder, right_encoder);
+  return true;
+}
+
+void PathFollower::follow(const Pose& start_pose) {
+  start(start_pose);
+  while (step()) {
+  }
+}
+
+bool PathFollower::isDone() const { return !running_; }
+
+void PathFollower::abort() {
+  if (running_) {
+    one_.brake(100, 100);
+    running_ = false;
+  }
+}
+
+Pose PathFollower::getPose() const { return pose_; }
+
+float PathFollower::getRemainingMm() const { return remaining_mm_; }
+
+Waypoint PathFollower::getWaypoint(const int index) const {
+  if (!in_progmem_) return waypoints_[index];
+
+  Waypoint waypoint;
+  waypoint.x_mm = (int16_t)pgm_read_word(&waypoints_[index].x_mm);
+  waypoint.y_mm = (int16_t)pgm_read_word(&waypoints_[index].y_mm);
+  return waypoint;
+}
+
+void PathFollower::updatePose(const int left_pulses, const int right_pulses) {
+  const float left_mm = cut_.computeLeftDistanceFromPulses(left_pulses);
+  const float right_mm = cut_.computeRightDistanceFromPulses(right_pulses);
+  pose_.updatePose((left_mm + right_mm) / 2.0,
+                   (right_mm - left_mm) / track_width_mm_);
+}
+
+float PathFollower::projectOnPath() {
+  while (true) {
+    const Waypoint start = getWaypoint(segment_);
+    const Waypoint end = getWaypoint(segment_ + 1);
+    const float length_mm = getSegmentLength(segment_);
+    float along_mm = 0;
+    if (length_mm > 0) {
+      along_mm = ((pose_.getXMm() - start.x_mm) * (end.x_mm - start.x_mm) +
+                  (pose_.getYMm() - start.y_mm) * (end.y_mm - start.y_mm)) /
+                 length_mm;
+    }
+    // The last segment is not clipped so overshooting the end is detected
+    if (along_mm < length_mm || segment_ >= num_waypoints_ - 2) {
+      return max(0.0, along_mm);
+    }
+    segment_start_mm_ += length_mm;
+    ++segment_;
+  }
+}
+
+void PathFollower::findLookAheadPoint(const float along_mm,
+                                      float& x_mm,
+                                      float& y_mm) const {
+  int index = segment_;
+  float offset_mm = along_mm + look_ahead_mm_;
+  float length_mm = getSegmentLength(index);
+  while (offset_mm > length_mm && index < num_waypoints_ - 2) {
+    offset_mm -= length_mm;
+    ++index;
+    length_mm = getSegmentLength(index);
+  }
+  // Beyond the end the last segment is extended to keep steering straight
+  const Waypoint start = getWaypoint(index);
+  const Waypoint end = getWaypoint(index + 1);
+  const float ratio = (length_mm > 0) ? offset_mm / length_mm : 0;
+  x_mm = start.x_mm + ratio * (end.x_mm - start.x_mm);
+  y_mm = start.y_mm + ratio * (end.y_mm - start.y_mm);
+}
+
+float PathFollower::computePursuitCurvature(const float x_mm,
+                                            const float y_mm) const {
+  const float dx_mm = x_mm - pose_.getXMm();
+  const float dy_mm = y_mm - pose_.getYMm();
+  const float distance_sq = dx_mm * dx_mm + dy_mm * dy_mm;
+  if (distance_sq <= 0) return 0;
+
+  // Lateral offset of the point in the frame of the robot
+  const float theta_rad = pose_.getThetaRad();
+  const float lateral_mm =
+      -fastSin(theta_rad) * dx_mm + fastCos(theta_rad) * dy_mm;
+  return 2.0 * lateral_mm / distance_sq;
+}
+
+float PathFollower::computeSpeed(const float curvature,
+                                 const float remaining_mm) const {
+  float speed = max_speed_mmps_;
+  if (curvature != 0) {
+    speed = min(speed, (float)sqrt(max_lateral_accel_mmps2_ / abs(curvature)));
+  }
+  speed = min(speed, (float)sqrt(2.0 * max_accel_mmps2_ * remaining_mm));
+  const float period_s = CONTROL_PERIOD_US / 1000000.0;
+  speed = min(speed, speed_mmps_ + max_accel_mmps2_ * period_s);
+  return max(min_speed_mmps_, speed);
+}
+
+float PathFollower::getSegmentLength(const int index) const {
+  const Waypoint start = getWaypoint(index);
+  const Waypoint end = getWaypoint(index + 1);
+  const float dx_mm = end.x_mm - start.x_mm;
+  const float dy_mm = end.y_mm - start.y_mm;
+  return sqrt(dx_mm * dx_mm + dy_mm * dy_mm);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "ControlUtils.h"
+#include "RobotParams.h"
+
+/**
+ * @brief Point of a path in millimeters. Stored as 16 bit integers so paths
+ * are compact and can be placed in PROGMEM.
+ */
+struct Waypoint {
+  int16_t x_mm;  ///< x-coordinate in millimeters.
+  int16_t y_mm;  ///< y-coordinate in millimeters.
+};
+
+/**
+ * @class PathFollower
+ * @brief Follows a path given by a list of waypoints using pure pursuit.
+ *
+ * The pose of the robot is estimated from the encoders every control cycle.
+ * The robot steers along the arc that reaches the point of the path found one
+ * look-ahead distance ahead of its projection on the path. The speed is
+ * limited by the lateral acceleration on that arc, the maximum acceleration
+ * of RobotParams and the distance left to the end of the path, where the
+ * robot stops.
+ */
+class PathFollower {
+ public:
+  /**
+   * @brief Constructor for PathFollower.
+   * @param one Reference to BnrOneAPlus object.
+   * @param robot_params Robot params.
+   */
+  PathFollower(const BnrOneAPlus& one,
+               const RobotParams& robot_params = RobotParams());
+
+  /**
+   * @brief Sets the path to follow. The array is not copied and must remain
+   * valid while the path is followed.
+   * @param waypoints Waypoints in the frame of the start pose.
+   * @param num_waypoints Number of waypoints (at least 2).
+   * @param in_progmem true if the waypoints are stored in PROGMEM.
+   */
+  void setPath(const Waypoint waypoints[],
+               const int num_waypoints,
+               const bool in_progmem = false);
+
+  /**
+   * @brief Sets the look-ahead distance. Longer distances give smoother but
+   * less accurate paths.
+   * @param look_ahead_mm Look-ahead distance in millimeters.
+   */
+  void setLookAheadMm(const float look_ahead_mm);
+
+  /**
+   * @brief Sets the speed limits.
+   * @param max_speed_mmps Speed on straight parts of the path.
+   * @param max_lateral_accel_mmps2 Maximum lateral acceleration, which limits
+   * the speed on curves.
+   * @param min_speed_mmps Lowest speed, used when starting and stopping.
+   */
+  void setSpeedLimits(const float max_speed_mmps,
+                      const float max_lateral_accel_mmps2,
+                      const float min_speed_mmps = 30);
+
+  /**
+   * @brief Starts following the path from the given pose without blocking.
+   * Call step() until it returns false.
+   * @param start_pose Pose of the robot in the frame of the waypoints.
+   */
+  void start(const Pose& start_pose = Pose());
+
+  /**
+   * @brief Updates the pose, the steering and the wheel speeds. Returns
+   * without any SPI communication if called again before the control period
+   * has elapsed. Brakes at the end of the path.
+   * @return true while following the path, false when done.
+   */
+  bool step();
+
+  /**
+   * @brief Follows the whole path from the given pose. Blocks until the end
+   * of the path is reached.
+   * @param start_pose Pose of the robot in the frame of the waypoints.
+   */
+  void follow(const Pose& start_pose = Pose());
+
+  /**
+   * @brief Checks if the end of the path was reached or following aborted.
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Brakes the robot and stops following the path.
+   */
+  void abort();
+
+  /**
+   * @brief Gets the pose estimated from the encoders.
+   */
+  Pose getPose() const;
+
+  /**
+   * @brief Gets the distance left to the end of the path.
+   * @return Distance in millimeters along the path.
+   */
+  float getRemainingMm() const;
+
+ private:
+  /**
+   * @brief Gets a waypoint from RAM or PROGMEM.
+   */
+  Waypoint getWaypoint(const int index) const;
+
+  /**
+   * @brief Updates the pose with the pulses counted since the previous cycle.
+   */
+  void updatePose(const int left_pulses, const int right_pulses);
+
+  /**
+   * @brief Projects the robot on the path, advancing to the next segment once
+   * the current one has been passed.
+   * @return Position of the projection along the current segment, in
+   * millimeters from its start.
+   */
+  float projectOnPath();
+
+  /**
+   * @brief Finds the point of the path at a given distance ahead of a
+   * position on the current segment.
+   * @param along_mm Position along the current segment.
+   * @param x_mm Output x-coordinate of the point.
+   * @param y_mm Output y-coordinate of the point.
+   */
+  void findLookAheadPoint(const float along_mm, float& x_mm, float& y_mm) const;
+
+  /**
+   * @brief Computes the curvature of the arc from the robot to a point.
+   * @return Curvature in 1/mm, positive counterclockwise.
+   */
+  float computePursuitCurvature(const float x_mm, const float y_mm) const;
+
+  /**
+   * @brief Computes the speed allowed by the curvature, the acceleration and
+   * the distance left.
+   */
+  float computeSpeed(const float curvature, const float remaining_mm) const;
+
+  /**
+   * @brief Gets the length of a segment of the path.
+   */
+  float getSegmentLength(const int index) const;
+
+  const BnrOneAPlus& one_;         ///< Reference to BnrOneAPlus object.
+  ControlUtils cut_;               ///< Control utils object
+  float track_width_mm_;           ///< Effective track width.
+  float max_accel_mmps2_;          ///< Maximum acceleration.
+  const Waypoint* waypoints_;      ///< Waypoints of the path.
+  int num_waypoints_;              ///< Number of waypoints.
+  bool in_progmem_;                ///< Whether waypoints are in PROGMEM.
+  float path_length_mm_;           ///< Total length of the path.
+  float look_ahead_mm_;            ///< Look-ahead distance.
+  float max_speed_mmps_;           ///< Speed on straight parts.
+  float max_lateral_accel_mmps2_;  ///< Maximum lateral acceleration.
+  float min_speed_mmps_;           ///< Lowest speed.
+  Pose pose_;                      ///< Pose estimated from the encoders.
+  int segment_;                    ///< Index of the current segment.
+  float segment_start_mm_;         ///< Path length before the segment.
+  float remaining_mm_;             ///< Distance left to the end.
+  float speed_mmps_;               ///< Speed commanded in the last cycle.
+  bool running_;                   ///< Whether the path is being followed.
+  unsigned long last_step_us_;     ///< Time of the last control cycle.
+};
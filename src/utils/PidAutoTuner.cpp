@@ -0,0 +1,185 @@
+#include "PidAutoTuner.h"
+
+#include "EepromUtils.h"
+
+#define SETTLING_CYCLES 2  // Oscillations discarded before measuring
+#define MEASURED_CYCLES 4  // Oscillations averaged
+#define TUNING_TIMEOUT_MS 15000
+#define LINE_LIMIT 100   // Line position at the end of the sensor
+#define KP_SCALE 1000.0  // Stored gains scales, as in LineFollowPID
+#define KI_SCALE 10000.0
+#define KD_SCALE 1000.0
+#define GAINS_OFFSET 2  // Gains follow the speed and extra speed bytes
+
+PidAutoTuner::PidAutoTuner(const BnrOneAPlus& one, const int eeprom_address)
+    : one_(one),
+      eeprom_address_(eeprom_address),
+      base_speed_(30),
+      relay_amplitude_(20),
+      hysteresis_(5),
+      control_period_us_(10000),
+      relay_output_(0),
+      num_cycles_(-1),
+      line_min_(0),
+      line_max_(0),
+      cycle_start_us_(0),
+      amplitude_sum_(0),
+      period_sum_us_(0),
+      ultimate_gain_(0),
+      ultimate_period_ms_(0),
+      running_(false),
+      done_(false),
+      error_(false),
+      start_ms_(0) {}
+
+void PidAutoTuner::setRelay(const int base_speed,
+                            const int relay_amplitude,
+                            const int hysteresis,
+                            const int control_period_ms) {
+  base_speed_ = base_speed;
+  relay_amplitude_ = abs(relay_amplitude);
+  hysteresis_ = abs(hysteresis);
+  control_period_us_ = max(control_period_ms, 1) * 1000UL;
+}
+
+void PidAutoTuner::start() {
+  relay_output_ = relay_amplitude_;
+  num_cycles_ = -1;
+  line_min_ = LINE_LIMIT;
+  line_max_ = -LINE_LIMIT;
+  amplitude_sum_ = 0;
+  period_sum_us_ = 0;
+  ultimate_gain_ = 0;
+  ultimate_period_ms_ = 0;
+  running_ = true;
+  done_ = false;
+  error_ = false;
+  start_ms_ = millis();
+}
+
+bool PidAutoTuner::step(const int line_position) {
+  if (!running_) return false;
+
+  const unsigned long now_us = micros();
+  if (millis() - start_ms_ > TUNING_TIMEOUT_MS) {
+    fail();
+    return false;
+  }
+
+  line_min_ = min(line_min_, line_position);
+  line_max_ = max(line_max_, line_position);
+
+  // Steer towards the line, switching once it is beyond the hysteresis band.
+  // A switch to the left marks the end of an oscillation.
+  if (relay_output_ > 0 && line_position > hysteresis_) {
+    relay_output_ = -relay_amplitude_;
+  } else if (relay_output_ < 0 && line_position < -hysteresis_) {
+    relay_output_ = relay_amplitude_;
+    closeCycle(now_us);
+    if (!running_) return false;
+  }
+  one_.move(base_speed_ - relay_output_, base_speed_ + relay_output_);
+  return true;
+}
+
+bool PidAutoTuner::isDone() const { return done_; }
+
+bool PidAutoTuner::hasError() const { return error_; }
+
+void PidAutoTuner::abort() {
+  running_ = false;
+  one_.stop();
+}
+
+float PidAutoTuner::getUltimateGain() const { return ultimate_gain_; }
+
+float PidAutoTuner::getUltimatePeriodMs() const { return ultimate_period_ms_; }
+
+PidGains PidAutoTuner::computeGains(const Rule rule) const {
+  // Proportional gain and integral and derivative times in ultimate periods
+  float kp = 0;
+  float integral_time = 1;
+  float derivative_time = 0;
+  switch (rule) {
+    case Rule::ZIEGLER_NICHOLS:
+      kp = 0.6 * ultimate_gain_;
+      integral_time = 0.5;
+      derivative_time = 0.125;
+      break;
+    case Rule::TYREUS_LUYBEN:
+      kp = 0.45 * ultimate_gain_;
+      integral_time = 2.2;
+      derivative_time = 1 / 6.3;
+      break;
+  }
+
+  // Convert the times to control cycles
+  const float period_cycles =
+      ultimate_period_ms_ * 1000.0 / control_period_us_;
+  PidGains gains;
+  gains.kp = kp;
+  gains.ki = 0;
+  gains.kd = 0;
+  if (period_cycles > 0) {
+    gains.ki = kp / (integral_time * period_cycles);
+    gains.kd = kp * derivative_time * period_cycles;
+  }
+  return gains;
+}
+
+void PidAutoTuner::save(const PidGains& gains) const {
+  const int address = eeprom_address_ + GAINS_OFFSET;
+  saveEepromWord(address, (int)round(gains.kp * KP_SCALE));
+  saveEepromWord(address + 2, (int)round(gains.ki * KI_SCALE));
+  saveEepromWord(address + 4, (int)round(gains.kd * KD_SCALE));
+}
+
+bool PidAutoTuner::load(PidGains& gains) const {
+  const int address = eeprom_address_ + GAINS_OFFSET;
+  const int kp = loadEepromWord(address);
+  const int ki = loadEepromWord(address + 2);
+  const int kd = loadEepromWord(address + 4);
+
+  // Erased EEPROM reads as -1
+  if (kp <= 0 || ki < 0 || kd < 0) return false;
+  gains.kp = kp / KP_SCALE;
+  gains.ki = ki / KI_SCALE;
+  gains.kd = kd / KD_SCALE;
+  return true;
+}
+
+void PidAutoTuner::closeCycle(const unsigned long now_us) {
+  ++num_cycles_;
+  if (num_cycles_ > SETTLING_CYCLES) {
+    // The relay output is clipped at the end of the sensor
+    if (line_min_ <= -LINE_LIMIT || line_max_ >= LINE_LIMIT) {
+      fail();
+      return;
+    }
+    amplitude_sum_ += (line_max_ - line_min_) / 2.0;
+    period_sum_us_ += now_us - cycle_start_us_;
+  }
+  cycle_start_us_ = now_us;
+  line_min_ = LINE_LIMIT;
+  line_max_ = -LINE_LIMIT;
+
+  if (num_cycles_ < SETTLING_CYCLES + MEASURED_CYCLES) return;
+
+  abort();
+  const float amplitude = amplitude_sum_ / MEASURED_CYCLES;
+  if (amplitude <= hysteresis_) {
+    fail();
+    return;
+  }
+  // Describing function of a relay with hysteresis
+  const float amplitude_above_hysteresis =
+      sqrt(amplitude * amplitude - hysteresis_ * hysteresis_);
+  ultimate_gain_ = 4.0 * relay_amplitude_ / (PI * amplitude_above_hysteresis);
+  ultimate_period_ms_ = period_sum_us_ / (MEASURED_CYCLES * 1000.0);
+  done_ = true;
+}
+
+void PidAutoTuner::fail() {
+  abort();
+  error_ = true;
+}
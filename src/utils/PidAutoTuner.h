@@ -0,0 +1,162 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#define LINE_FOLLOW_PID_EEPROM_ADDRESS 10  // EEPROM address of LineFollowPID
+
+/**
+ * @brief Gains of a PID controller, with the integral and derivative gains
+ * per control cycle as used by PidController.
+ */
+struct PidGains {
+  float kp;  ///< Proportional gain.
+  float ki;  ///< Integral gain per control cycle.
+  float kd;  ///< Derivative gain per control cycle.
+};
+
+/**
+ * @class PidAutoTuner
+ * @brief Tunes the PID gains of line following with a relay experiment
+ * (Astrom and Hagglund, 1984).
+ *
+ * The robot follows the line with bang-bang steering: the wheel speeds are
+ * split by a fixed amount towards the side of the line, switching when the
+ * line crosses the centre beyond a hysteresis band. This makes the robot
+ * oscillate around the line at the ultimate period of the loop. The
+ * amplitude of the oscillation gives the ultimate gain, from which the
+ * gains are computed with the selected tuning rule.
+ *
+ * The gains are for a controller whose output splits the speeds given to
+ * BnrOneAPlus::move() and that runs at the control period of the tuning, as
+ * in the LineFollowPID example. They are stored in the EEPROM settings of
+ * that example, which loads them at start: it must run at the control period
+ * of the tuning, 10 ms in the examples, since ki and kd are per cycle.
+ */
+class PidAutoTuner {
+ public:
+  /**
+   * @brief Tuning rules.
+   */
+  enum class Rule {
+    ZIEGLER_NICHOLS,  ///< Fast response, some overshoot.
+    TYREUS_LUYBEN     ///< Less overshoot and more robust, slower.
+  };
+
+  /**
+   * @brief Constructor for PidAutoTuner.
+   * @param one Reference to BnrOneAPlus object, used to drive the motors.
+   * @param eeprom_address First EEPROM address of the LineFollowPID settings:
+   * the speed and extra speed bytes, then the kp, ki and kd words.
+   */
+  PidAutoTuner(const BnrOneAPlus& one,
+               const int eeprom_address = LINE_FOLLOW_PID_EEPROM_ADDRESS);
+
+  /**
+   * @brief Sets the relay experiment.
+   * @param base_speed Speed of both wheels, as given to BnrOneAPlus::move().
+   * @param relay_amplitude Speed added to one wheel and removed from the
+   * other to steer towards the line.
+   * @param hysteresis Line position around the centre in which the steering
+   * does not switch, to reject sensor noise.
+   * @param control_period_ms Period at which step() is called, which must
+   * also be the period of the tuned controller.
+   */
+  void setRelay(const int base_speed,
+                const int relay_amplitude,
+                const int hysteresis = 5,
+                const int control_period_ms = 10);
+
+  /**
+   * @brief Starts the relay experiment. The robot must be on the line.
+   */
+  void start();
+
+  /**
+   * @brief Runs a control cycle of the relay experiment. Call every control
+   * period.
+   * @param line_position Line position in the range [-100, 100], as returned
+   * by BnrOneAPlus::readLine(), positive when the line is on the right.
+   * @return true while the experiment is running.
+   */
+  bool step(const int line_position);
+
+  /**
+   * @brief Checks if the ultimate gain and period were measured.
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Checks if the experiment failed, because the robot did not
+   * oscillate in time or the oscillation reached the end of the line sensor.
+   */
+  bool hasError() const;
+
+  /**
+   * @brief Stops the experiment and the motors.
+   */
+  void abort();
+
+  /**
+   * @brief Gets the measured ultimate gain.
+   * @return Steering speed per line unit.
+   */
+  float getUltimateGain() const;
+
+  /**
+   * @brief Gets the measured ultimate period.
+   * @return Period in milliseconds.
+   */
+  float getUltimatePeriodMs() const;
+
+  /**
+   * @brief Computes the gains from the measured ultimate gain and period.
+   * @param rule Tuning rule.
+   * @return Gains per control cycle.
+   */
+  PidGains computeGains(const Rule rule = Rule::ZIEGLER_NICHOLS) const;
+
+  /**
+   * @brief Saves gains in EEPROM, keeping the stored speeds.
+   * @param gains Gains to save.
+   */
+  void save(const PidGains& gains) const;
+
+  /**
+   * @brief Loads the gains from EEPROM.
+   * @param gains Loaded gains, unchanged if nothing valid is stored.
+   * @return true if valid gains were loaded.
+   */
+  bool load(PidGains& gains) const;
+
+ private:
+  /**
+   * @brief Accounts a full oscillation ending at the given time and finishes
+   * the experiment after enough oscillations.
+   */
+  void closeCycle(const unsigned long now_us);
+
+  /**
+   * @brief Stops the experiment with an error.
+   */
+  void fail();
+
+  const BnrOneAPlus& one_;           ///< Reference to BnrOneAPlus object.
+  int eeprom_address_;               ///< EEPROM address of the settings.
+  int base_speed_;                   ///< Speed of both wheels.
+  int relay_amplitude_;              ///< Steering speed of the relay.
+  int hysteresis_;                   ///< Switching band of the relay.
+  unsigned long control_period_us_;  ///< Control period.
+  int relay_output_;                 ///< Current steering speed.
+  int num_cycles_;                   ///< Oscillations, -1 before the first.
+  int line_min_;                     ///< Lowest line of the oscillation.
+  int line_max_;                     ///< Highest line of the oscillation.
+  unsigned long cycle_start_us_;     ///< Start time of the oscillation.
+  float amplitude_sum_;              ///< Sum of the measured amplitudes.
+  unsigned long period_sum_us_;      ///< Sum of the measured periods.
+  float ultimate_gain_;              ///< Measured ultimate gain.
+  float ultimate_period_ms_;         ///< Measured ultimate period.
+  bool running_;                     ///< Whether the experiment is running.
+  bool done_;                        ///< Whether the experiment succeeded.
+  bool error_;                       ///< Whether the experiment failed.
+  unsigned long start_ms_;           ///< Start time of the experiment.
+};
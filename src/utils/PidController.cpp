@@ -0,0 +1,209 @@
+#include "PidController.h"
+
+#define PID_MAX_INPUT 16383  // Largest setpoint and measurement magnitude
+
+PidController::PidController(const float kp,
+                             const float ki,
+                             const float kd,
+                             const int output_min,
+                             const int output_max)
+    : kp_(0),
+      ki_(0),
+      kd_(0),
+      proportional_weight_(toFixed(1.0)),
+      derivative_weight_(0),
+      kp_setpoint_(0),
+      kd_setpoint_(0),
+      alpha_(toFixed(1.0)),
+      output_min_(0),
+      output_max_(0),
+      integral_(0),
+      derivative_(0),
+      previous_setpoint_(0),
+      previous_measurement_(0),
+      first_cycle_(true) {
+  setGains(kp, ki, kd);
+  setOutputLimits(output_min, output_max);
+}
+
+void PidController::setGains(const float kp, const float ki, const float kd) {
+  kp_ = toFixed(constrain(kp, -PID_MAX_GAIN, PID_MAX_GAIN));
+  ki_ = (int32_t)round(
+      constrain(ki, -PID_MAX_INTEGRAL_GAIN, PID_MAX_INTEGRAL_GAIN) *
+      (1L << PID_INTEGRAL_FRACTION_BITS));
+  kd_ = toFixed(constrain(kd, -PID_MAX_GAIN, PID_MAX_GAIN));
+  updateSetpointGains();
+}
+
+void PidController::setOutputLimits(const int output_min,
+                                    const int output_max) {
+  output_min_ = constrain(output_min, -PID_MAX_OUTPUT, PID_MAX_OUTPUT);
+  output_max_ = constrain(output_max, output_min_, PID_MAX_OUTPUT);
+  integral_ = constrain(integral_,
+                        output_min_ << PID_INTEGRAL_FRACTION_BITS,
+                        output_max_ << PID_INTEGRAL_FRACTION_BITS);
+}
+
+void PidController::setSetpointWeights(const float proportional_weight,
+                                       const float derivative_weight) {
+  proportional_weight_ = toFixed(constrain(proportional_weight, 0.0, 1.0));
+  derivative_weight_ = toFixed(constrain(derivative_weight, 0.0, 1.0));
+  updateSetpointGains();
+}
+
+void PidController::setDerivativeFilter(const float alpha) {
+  alpha_ = toFixed(constrain(alpha, 0.0, 1.0));
+}
+
+void PidController::reset() {
+  integral_ = 0;
+  derivative_ = 0;
+  first_cycle_ = true;
+}
+
+void PidController::resetIntegral() { integral_ = 0; }
+
+int PidController::compute(const int setpoint, const int measurement) {
+  const int32_t r = constrain(setpoint, -PID_MAX_INPUT, PID_MAX_INPUT);
+  const int32_t y = constrain(measurement, -PID_MAX_INPUT, PID_MAX_INPUT);
+  const int32_t error = r - y;
+
+  // kp * (b * r - y) with the weighted gain, so b * r is not rounded
+  const int32_t proportional = kp_setpoint_ * r - kp_ * y;
+
+  // Derivative of the weighted error, without a kick on the first cycle
+  if (first_cycle_) {
+    previous_setpoint_ = r;
+    previous_measurement_ = y;
+    first_cycle_ = false;
+  }
+  const int32_t max_derivative = (int32_t)PID_MAX_OUTPUT << PID_FRACTION_BITS;
+  const int32_t raw_derivative =
+      constrain(kd_setpoint_ * (r - previous_setpoint_) -
+                    kd_ * (y - previous_measurement_),
+                -max_derivative,
+                max_derivative);
+  previous_setpoint_ = r;
+  previous_measurement_ = y;
+  derivative_ += roundFixed(alpha_ * (raw_derivative - derivative_));
+
+  // The integral only grows until the output reaches its limit, and is not
+  // reduced by the limit either. Unlike freezing the integral while the
+  // output is saturated, this does not jump with the rounding of the output.
+  const int integral_shift = PID_INTEGRAL_FRACTION_BITS - PID_FRACTION_BITS;
+  const int32_t output_min = output_min_ << PID_FRACTION_BITS;
+  const int32_t output_max = output_max_ << PID_FRACTION_BITS;
+  const int32_t headroom =
+      constrain(((error > 0) ? output_max : output_min) - proportional -
+                    derivative_,
+                output_min,
+                output_max)
+      << integral_shift;
+  const int32_t integral_error =
+      constrain(error, -PID_MAX_INPUT, PID_MAX_INPUT);
+  int32_t integral = integral_ + ki_ * integral_error;
+  if (error > 0) {
+    integral = min(integral, max(integral_, headroom));
+  } else if (error < 0) {
+    integral = max(integral, min(integral_, headroom));
+  }
+  integral_ = constrain(
+      integral, output_min << integral_shift, output_max << integral_shift);
+
+  const int32_t output =
+      proportional + (integral_ >> integral_shift) + derivative_;
+  return constrain(roundFixed(output), output_min_, output_max_);
+}
+
+int32_t PidController::toFixed(const float value) {
+  return (int32_t)round(value * (1L << PID_FRACTION_BITS));
+}
+
+int32_t PidController::roundFixed(const int32_t value) {
+  return (value + (1L << (PID_FRACTION_BITS - 1))) >> PID_FRACTION_BITS;
+}
+
+void PidController::updateSetpointGains() {
+  kp_setpoint_ = roundFixed(kp_ * proportional_weight_);
+  kd_setpoint_ = roundFixed(kd_ * derivative_weight_);
+}
+
+PidControllerFloat::PidControllerFloat(const float kp,
+                                       const float ki,
+                                       const float kd,
+                                       const float output_min,
+                                       const float output_max)
+    : kp_(kp),
+      ki_(ki),
+      kd_(kd),
+      proportional_weight_(1.0),
+      derivative_weight_(0),
+      alpha_(1.0),
+      output_min_(output_min),
+      output_max_(max(output_min, output_max)),
+      integral_(0),
+      derivative_(0),
+      previous_input_(0),
+      first_cycle_(true) {}
+
+void PidControllerFloat::setGains(const float kp,
+                                  const float ki,
+                                  const float kd) {
+  kp_ = kp;
+  ki_ = ki;
+  kd_ = kd;
+}
+
+void PidControllerFloat::setOutputLimits(const float output_min,
+                                         const float output_max) {
+  output_min_ = output_min;
+  output_max_ = max(output_min, output_max);
+  integral_ = constrain(integral_, output_min_, output_max_);
+}
+
+void PidControllerFloat::setSetpointWeights(const float proportional_weight,
+                                            const float derivative_weight) {
+  proportional_weight_ = constrain(proportional_weight, 0.0, 1.0);
+  derivative_weight_ = constrain(derivative_weight, 0.0, 1.0);
+}
+
+void PidControllerFloat::setDerivativeFilter(const float alpha) {
+  alpha_ = constrain(alpha, 0.0, 1.0);
+}
+
+void PidControllerFloat::reset() {
+  integral_ = 0;
+  derivative_ = 0;
+  first_cycle_ = true;
+}
+
+void PidControllerFloat::resetIntegral() { integral_ = 0; }
+
+float PidControllerFloat::compute(const float setpoint,
+                                  const float measurement) {
+  const float error = setpoint - measurement;
+  const float proportional =
+      kp_ * (proportional_weight_ * setpoint - measurement);
+
+  const float derivative_input = derivative_weight_ * setpoint - measurement;
+  if (first_cycle_) {
+    previous_input_ = derivative_input;
+    first_cycle_ = false;
+  }
+  const float raw_derivative = kd_ * (derivative_input - previous_input_);
+  previous_input_ = derivative_input;
+  derivative_ += alpha_ * (raw_derivative - derivative_);
+
+  const float headroom =
+      ((error > 0) ? output_max_ : output_min_) - proportional - derivative_;
+  float integral = integral_ + ki_ * error;
+  if (error > 0) {
+    integral = min(integral, max(integral_, headroom));
+  } else if (error < 0) {
+    integral = max(integral, min(integral_, headroom));
+  }
+  integral_ = constrain(integral, output_min_, output_max_);
+
+  const float output = proportional + integral_ + derivative_;
+  return constrain(output, output_min_, output_max_);
+}
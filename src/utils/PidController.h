@@ -0,0 +1,198 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define PID_FRACTION_BITS 10           // Q-format of gains and internal state
+#define PID_MAX_OUTPUT 1000            // Largest output limit magnitude
+#define PID_MAX_GAIN 31.0              // Largest proportional/derivative gain
+#define PID_INTEGRAL_FRACTION_BITS 16  // Q-format of the integral
+#define PID_MAX_INTEGRAL_GAIN 1.0      // Largest integral gain
+
+/**
+ * @class PidController
+ * @brief Discrete PID controller with fixed-point arithmetic.
+ *
+ * The output is computed once per control cycle as
+ *   P = kp * (b * setpoint - measurement)
+ *   I = sum of ki * (setpoint - measurement)
+ *   D = filtered kd * change of (c * setpoint - measurement)
+ * where b and c are the setpoint weights, so the gains are per control
+ * cycle and compute() must be called at a fixed rate. The integral is
+ * clamped to the output limits and only grows in the direction of the error
+ * until the output reaches its limit (anti-windup). The derivative goes
+ * through a first-order low-pass filter.
+ *
+ * Gains, weights and state are Q22.10 integers, with a Q16.16 integral so
+ * that small integral gains do not drift. A call always takes the same few
+ * 32 bit multiplications and no floating point. Setpoints and measurements
+ * must be within +-16383, gains below PID_MAX_GAIN, the integral gain below
+ * PID_MAX_INTEGRAL_GAIN and output limits within +-PID_MAX_OUTPUT.
+ * PidControllerFloat implements the same controller with floats as a
+ * reference.
+ */
+class PidController {
+ public:
+  /**
+   * @brief Constructor for PidController.
+   * @param kp Proportional gain.
+   * @param ki Integral gain per control cycle.
+   * @param kd Derivative gain per control cycle.
+   * @param output_min Lowest output.
+   * @param output_max Highest output.
+   */
+  PidController(const float kp = 1.0,
+                const float ki = 0,
+                const float kd = 0,
+                const int output_min = -100,
+                const int output_max = 100);
+
+  /**
+   * @brief Sets the gains. The integral and derivative gains are per control
+   * cycle.
+   */
+  void setGains(const float kp, const float ki, const float kd);
+
+  /**
+   * @brief Sets the output limits, which also limit the integral.
+   */
+  void setOutputLimits(const int output_min, const int output_max);
+
+  /**
+   * @brief Sets the weights of the setpoint in the proportional and
+   * derivative terms. Weights below 1 reduce the overshoot after setpoint
+   * changes without changing the response to disturbances.
+   * @param proportional_weight Weight b, from 0 to 1 (default 1).
+   * @param derivative_weight Weight c, from 0 to 1 (default 0, i.e. the
+   * derivative of the measurement only).
+   */
+  void setSetpointWeights(const float proportional_weight,
+                          const float derivative_weight);
+
+  /**
+   * @brief Sets the low-pass filter of the derivative term.
+   * @param alpha Fraction of the new derivative taken every cycle, from 0 to
+   * 1 (1 disables the filter).
+   */
+  void setDerivativeFilter(const float alpha);
+
+  /**
+   * @brief Clears the integral and the derivative history.
+   */
+  void reset();
+
+  /**
+   * @brief Clears the integral only, e.g. when the error changes sign.
+   */
+  void resetIntegral();
+
+  /**
+   * @brief Computes the output for a control cycle.
+   * @param setpoint Desired value.
+   * @param measurement Measured value.
+   * @return Output within the output limits.
+   */
+  int compute(const int setpoint, const int measurement);
+
+ private:
+  /**
+   * @brief Converts a value to the Q-format.
+   */
+  static int32_t toFixed(const float value);
+
+  /**
+   * @brief Divides a Q-format value by 2^PID_FRACTION_BITS, rounding to the
+   * nearest integer.
+   */
+  static int32_t roundFixed(const int32_t value);
+
+  /**
+   * @brief Updates the gains applied to the setpoint from the gains and the
+   * setpoint weights.
+   */
+  void updateSetpointGains();
+
+  int32_t kp_;                    ///< Proportional gain.
+  int32_t ki_;                    ///< Integral gain, Q16.16.
+  int32_t kd_;                    ///< Derivative gain.
+  int32_t proportional_weight_;   ///< Setpoint weight b.
+  int32_t derivative_weight_;     ///< Setpoint weight c.
+  int32_t kp_setpoint_;           ///< Proportional gain times b.
+  int32_t kd_setpoint_;           ///< Derivative gain times c.
+  int32_t alpha_;                 ///< Derivative filter coefficient.
+  int32_t output_min_;            ///< Lowest output.
+  int32_t output_max_;            ///< Highest output.
+  int32_t integral_;              ///< Integral term, Q16.16.
+  int32_t derivative_;            ///< Filtered derivative term.
+  int32_t previous_setpoint_;     ///< Setpoint of the last cycle.
+  int32_t previous_measurement_;  ///< Measurement of the last cycle.
+  bool first_cycle_;              ///< Whether no cycle ran since reset.
+};
+
+/**
+ * @class PidControllerFloat
+ * @brief Floating-point reference implementation of PidController. Same
+ * equations and interface, without the range limits.
+ */
+class PidControllerFloat {
+ public:
+  /**
+   * @brief Constructor for PidControllerFloat. See PidController.
+   */
+  PidControllerFloat(const float kp = 1.0,
+                     const float ki = 0,
+                     const float kd = 0,
+                     const float output_min = -100,
+                     const float output_max = 100);
+
+  /**
+   * @brief Sets the gains. See PidController::setGains.
+   */
+  void setGains(const float kp, const float ki, const float kd);
+
+  /**
+   * @brief Sets the output limits. See PidController::setOutputLimits.
+   */
+  void setOutputLimits(const float output_min, const float output_max);
+
+  /**
+   * @brief Sets the setpoint weights. See
+   * PidController::setSetpointWeights.
+   */
+  void setSetpointWeights(const float proportional_weight,
+                          const float derivative_weight);
+
+  /**
+   * @brief Sets the derivative filter. See
+   * PidController::setDerivativeFilter.
+   */
+  void setDerivativeFilter(const float alpha);
+
+  /**
+   * @brief Clears the integral and the derivative history.
+   */
+  void reset();
+
+  /**
+   * @brief Clears the integral only. See PidController::resetIntegral.
+   */
+  void resetIntegral();
+
+  /**
+   * @brief Computes the output for a control cycle.
+   */
+  float compute(const float setpoint, const float measurement);
+
+ private:
+  float kp_;                   ///< Proportional gain.
+  float ki_;                   ///< Integral gain.
+  float kd_;                   ///< Derivative gain.
+  float proportional_weight_;  ///< Setpoint weight b.
+  float derivative_weight_;    ///< Setpoint weight c.
+  float alpha_;                ///< Derivative filter coefficient.
+  float output_min_;           ///< Lowest output.
+  float output_max_;           ///< Highest output.
+  float integral_;             ///< Integral term.
+  float derivative_;           ///< Filtered derivative term.
+  float previous_input_;       ///< Derivative input of the last cycle.
+  bool first_cycle_;           ///< Whether no cycle ran since reset.
+};
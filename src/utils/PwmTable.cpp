@@ -0,0 +1,71 @@
+#include "PwmTable.h"
+
+#include <EEPROM.h>  // EEPROM reading and writing
+
+#define SPEED_STEP 10  // Speed between entries, in %
+
+PwmTable::PwmTable() {
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    left_[i] = i * SPEED_STEP;
+    right_[i] = i * SPEED_STEP;
+  }
+}
+
+void PwmTable::setEntry(const byte index,
+                        const byte left_duty_cycle,
+                        const byte right_duty_cycle) {
+  if (index >= PWM_TABLE_SIZE) return;
+  left_[index] = min(left_duty_cycle, (byte)100);
+  right_[index] = min(right_duty_cycle, (byte)100);
+}
+
+int PwmTable::computeLeftDutyCycle(const int speed) const {
+  return interpolate(left_, speed);
+}
+
+int PwmTable::computeRightDutyCycle(const int speed) const {
+  return interpolate(right_, speed);
+}
+
+void PwmTable::setFromProgmem(const byte table[]) {
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    setEntry(i,
+             pgm_read_byte(&table[i]),
+             pgm_read_byte(&table[PWM_TABLE_SIZE + i]));
+  }
+}
+
+void PwmTable::save(const int eeprom_address) const {
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    EEPROM.update(eeprom_address + i, left_[i]);
+    EEPROM.update(eeprom_address + PWM_TABLE_SIZE + i, right_[i]);
+  }
+}
+
+bool PwmTable::load(const int eeprom_address) {
+  byte left[PWM_TABLE_SIZE];
+  byte right[PWM_TABLE_SIZE];
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    left[i] = EEPROM.read(eeprom_address + i);
+    right[i] = EEPROM.read(eeprom_address + PWM_TABLE_SIZE + i);
+    // A valid table has increasing duty cycles up to 100
+    if (left[i] > 100 || right[i] > 100) return false;
+    if (i > 0 && (left[i] < left[i - 1] || right[i] < right[i - 1])) {
+      return false;
+    }
+  }
+  memcpy(left_, left, sizeof(left_));
+  memcpy(right_, right, sizeof(right_));
+  return true;
+}
+
+int PwmTable::interpolate(const byte duty_cycles[], const int speed) {
+  if (speed == 0) return 0;
+  const int magnitude = min(abs(speed), 100);
+  const byte index = min(magnitude / SPEED_STEP, PWM_TABLE_SIZE - 2);
+  const int fraction = magnitude - index * SPEED_STEP;
+  const int duty_cycle =
+      duty_cycles[index] +
+      ((duty_cycles[index + 1] - duty_cycles[index]) * fraction) / SPEED_STEP;
+  return speed > 0 ? duty_cycle : -duty_cycle;
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define PWM_TABLE_SIZE 11              // Entries for speeds 0, 10, ..., 100 %
+#define PWM_TABLE_EEPROM_ADDRESS 160  // Default EEPROM address of the table
+
+/**
+ * @class PwmTable
+ * @brief Lookup table that linearises the open-loop speed of the motors.
+ *
+ * For each wheel the table holds the duty cycle that gives 0, 10, ..., 100 %
+ * of the top speed common to both wheels, with the duty cycle at which the
+ * wheel starts to move as the 0 % entry. Speeds in between are linearly
+ * interpolated and negative speeds mirror the positive ones, so the wheels
+ * turn at speeds proportional to the command and equal to each other.
+ */
+class PwmTable {
+ public:
+  /**
+   * @brief Constructor for PwmTable. The default table is the identity.
+   */
+  PwmTable();
+
+  /**
+   * @brief Sets the duty cycle of an entry.
+   * @param index Entry index, for a speed of index * 10 %.
+   * @param left_duty_cycle Duty cycle of the left motor.
+   * @param right_duty_cycle Duty cycle of the right motor.
+   */
+  void setEntry(const byte index,
+                const byte left_duty_cycle,
+                const byte right_duty_cycle);
+
+  /**
+   * @brief Computes the duty cycle of the left motor for a speed.
+   * @param speed Speed in the range [-100, 100] % of the top speed.
+   * @return Duty cycle in the range [-100, 100].
+   */
+  int computeLeftDutyCycle(const int speed) const;
+
+  /**
+   * @brief Computes the duty cycle of the right motor for a speed.
+   * @param speed Speed in the range [-100, 100] % of the top speed.
+   * @return Duty cycle in the range [-100, 100].
+   */
+  int computeRightDutyCycle(const int speed) const;
+
+  /**
+   * @brief Sets the table from PROGMEM, e.g. values printed by
+   * MotorsCalibrate and compiled into a sketch.
+   * @param table Left duty cycles followed by right duty cycles
+   * (2 * PWM_TABLE_SIZE bytes).
+   */
+  void setFromProgmem(const byte table[]);
+
+  /**
+   * @brief Saves the table in EEPROM.
+   * @param eeprom_address First EEPROM address (2 * PWM_TABLE_SIZE bytes).
+   */
+  void save(const int eeprom_address = PWM_TABLE_EEPROM_ADDRESS) const;
+
+  /**
+   * @brief Loads the table from EEPROM.
+   * @param eeprom_address First EEPROM address (2 * PWM_TABLE_SIZE bytes).
+   * @return true if a valid table was loaded, otherwise the table is
+   * unchanged.
+   */
+  bool load(const int eeprom_address = PWM_TABLE_EEPROM_ADDRESS);
+
+ private:
+  /**
+   * @brief Interpolates the duty cycle of a speed in the table of a wheel.
+   */
+  static int interpolate(const byte duty_cycles[], const int speed);
+
+  byte left_[PWM_TABLE_SIZE];   ///< Duty cycles of the left motor.
+  byte right_[PWM_TABLE_SIZE];  ///< Duty cycles of the right motor.
+};
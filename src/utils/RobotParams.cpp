@@ -6,12 +6,35 @@
  * @param axis_length_mm_in Axis length in millimeters.
  * @param wheel_diameter_mm_in Wheel diameter in millimeters.
  * @param pulses_per_rev_in Number of pulses per revolution.
+ * @param left_wheel_diameter_mm_in Calibrated left wheel diameter.
+ * @param right_wheel_diameter_mm_in Calibrated right wheel diameter.
+ * @param track_width_mm_in Calibrated effective track width.
+ * @param max_accel_mmps2_in Maximum wheel acceleration.
+ * @param max_jerk_mmps3_in Maximum wheel jerk.
+ * @param max_lateral_accel_mmps2_in Maximum lateral acceleration.
  */
 RobotParams::RobotParams(const int max_speed_rpm_in,
                          const float axis_length_mm_in,
                          const float wheel_diameter_mm_in,
-                         const int pulses_per_rev_in)
+                         const int pulses_per_rev_in,
+                         const float left_wheel_diameter_mm_in,
+                         const float right_wheel_diameter_mm_in,
+                         const float track_width_mm_in,
+                         const float max_accel_mmps2_in,
+                         const float max_jerk_mmps3_in,
+                         const float max_lateral_accel_mmps2_in)
     : max_speed_rpm(max_speed_rpm_in),
       axis_length_mm(axis_length_mm_in),
       wheel_diameter_mm(wheel_diameter_mm_in),
-      pulses_per_rev(pulses_per_rev_in) {}
+      pulses_per_rev(pulses_per_rev_in),
+      left_wheel_diameter_mm(left_wheel_diameter_mm_in > 0
+                                 ? left_wheel_diameter_mm_in
+                                 : wheel_diameter_mm_in),
+      right_wheel_diameter_mm(right_wheel_diameter_mm_in > 0
+                                  ? right_wheel_diameter_mm_in
+                                  : wheel_diameter_mm_in),
+      track_width_mm(track_width_mm_in > 0 ? track_width_mm_in
+                                           : axis_length_mm_in),
+      max_accel_mmps2(max_accel_mmps2_in),
+      max_jerk_mmps3(max_jerk_mmps3_in),
+      max_lateral_accel_mmps2(max_lateral_accel_mmps2_in) {}
@@ -12,14 +12,38 @@ class RobotParams {
    * @param axis_length_mm_in Axis length in millimeters.
    * @param wheel_diameter_mm_in Wheel diameter in millimeters.
    * @param pulses_per_rev_in Number of pulses per revolution.
+   * @param left_wheel_diameter_mm_in Calibrated left wheel diameter in
+   * millimeters (0 to use wheel_diameter_mm_in).
+   * @param right_wheel_diameter_mm_in Calibrated right wheel diameter in
+   * millimeters (0 to use wheel_diameter_mm_in).
+   * @param track_width_mm_in Calibrated effective distance between the wheel
+   * contact points in millimeters (0 to use axis_length_mm_in).
+   * @param max_accel_mmps2_in Maximum wheel acceleration in millimeters per
+   * second squared.
+   * @param max_jerk_mmps3_in Maximum wheel jerk in millimeters per second
+   * cubed.
+   * @param max_lateral_accel_mmps2_in Maximum lateral acceleration in curves
+   * in millimeters per second squared.
    */
   RobotParams(const int max_speed_rpm_in = 300,
               const float axis_length_mm_in = 165,
               const float wheel_diameter_mm_in = 63,
-              const int pulses_per_rev_in = 2251);
+              const int pulses_per_rev_in = 2251,
+              const float left_wheel_diameter_mm_in = 0,
+              const float right_wheel_diameter_mm_in = 0,
+              const float track_width_mm_in = 0,
+              const float max_accel_mmps2_in = 800,
+              const float max_jerk_mmps3_in = 8000,
+              const float max_lateral_accel_mmps2_in = 2000);
 
-  int max_speed_rpm;        ///< Maximum speed in RPM.
-  float axis_length_mm;     ///< Axis length in millimeters.
-  float wheel_diameter_mm;  ///< Wheel diameter in millimeters.
-  int pulses_per_rev;       ///< Number of pulses per revolution.
+  int max_speed_rpm;              ///< Maximum speed in RPM.
+  float axis_length_mm;           ///< Axis length in millimeters.
+  float wheel_diameter_mm;        ///< Wheel diameter in millimeters.
+  int pulses_per_rev;             ///< Number of pulses per revolution.
+  float left_wheel_diameter_mm;   ///< Calibrated left wheel diameter.
+  float right_wheel_diameter_mm;  ///< Calibrated right wheel diameter.
+  float track_width_mm;           ///< Calibrated effective track width.
+  float max_accel_mmps2;          ///< Maximum wheel acceleration.
+  float max_jerk_mmps3;           ///< Maximum wheel jerk.
+  float max_lateral_accel_mmps2;  ///< Maximum lateral acceleration.
 };
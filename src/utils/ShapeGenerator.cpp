@@ -1,10 +1,65 @@
 #include "ShapeGenerator.h"
 
+#include "FastTrig.h"
+
+namespace {
+struct Polygon {
+  float side_mm;
+  float angle_deg;
+  float speed;
+};
+
+struct FibonacciSpiral {
+  const int* fibonacci_sequence;
+  float seed_radius;
+  float speed;
+};
+
+struct Snake {
+  float snaking_angle_deg;
+  float radius_of_curvature_mm;
+  float turning_rate_deg;
+  float speed;
+};
+
+MotionSegment polygonSegment(const int index, const void* shape) {
+  const Polygon& polygon = *static_cast<const Polygon*>(shape);
+  if (index % 2 == 0) {
+    return MotionSegment::straight(polygon.side_mm, polygon.speed);
+  }
+  return MotionSegment::rotation(polygon.angle_deg, polygon.speed);
+}
+
+MotionSegment fibonacciSegment(const int index, const void* shape) {
+  const FibonacciSpiral& spiral = *static_cast<const FibonacciSpiral*>(shape);
+  float radius_of_curvature =
+      spiral.fibonacci_sequence[index] * spiral.seed_radius;
+  return MotionSegment::arc(90, radius_of_curvature, spiral.speed);
+}
+
+MotionSegment snakeSegment(const int index, const void* shape) {
+  const Snake& snake = *static_cast<const Snake*>(shape);
+  if (index == 0) {
+    return MotionSegment::rotation(-snake.snaking_angle_deg / 2, snake.speed);
+  }
+  // The snaking angle alternates its sign on every element
+  const float snaking_angle_deg =
+      (index % 2 == 1) ? snake.snaking_angle_deg : -snake.snaking_angle_deg;
+  return MotionSegment::arc(snaking_angle_deg + snake.turning_rate_deg,
+                            snake.radius_of_curvature_mm,
+                            snake.speed);
+}
+}  // namespace
+
 ShapeGenerator::ShapeGenerator(const BnrOneAPlus& one,
                                const float slip_factor,
                                const RobotParams& robot_params)
     : mg_(one, slip_factor, robot_params) {}
 
+void ShapeGenerator::setVelocityProfile(const VelocityProfile::Type type) {
+  mg_.setVelocityProfile(type);
+}
+
 void ShapeGenerator::rotateAngleDegAtSpeed(
     const float angle_deg,
     const float speed,
@@ -29,10 +84,15 @@ void ShapeGenerator::polygon(const float side_mm,
                              const int num_sides,
                              const float speed) const {
   float angle_deg = 180 - ((num_sides - 2) * 180.0) / num_sides;
-  for (int i = 0; i < num_sides; ++i) {
-    mg_.moveStraightAtSpeed(side_mm, speed, side_mm / 5.0);
-    mg_.rotateAngleDegAtSpeed(angle_deg, speed, 0, 45);
+  if (mg_.getVelocityProfile() == VelocityProfile::Type::NONE) {
+    for (int i = 0; i < num_sides; ++i) {
+      mg_.moveStraightAtSpeed(side_mm, speed, side_mm / 5.0);
+      mg_.rotateAngleDegAtSpeed(angle_deg, speed, 0, 45);
+    }
+    return;
   }
+  const Polygon polygon = {side_mm, angle_deg, speed};
+  mg_.followSegments(polygonSegment, &polygon, 2 * num_sides);
 }
 
 void ShapeGenerator::triangle(const float side_mm, const float speed) const {
@@ -57,22 +117,32 @@ void ShapeGenerator::fibonacciSpiral(const float seed_radius,
                                      const float speed) const {
   int fibonacci_sequence[num_segments];
   computeFibonacciSequence(num_segments, fibonacci_sequence);
-  for (int i = 0; i < num_segments; ++i) {
-    float radius_of_curvature = fibonacci_sequence[i] * seed_radius;
-    mg_.rotateAngleDegAtSpeed(90, speed, radius_of_curvature);
-  }
+  const FibonacciSpiral spiral = {fibonacci_sequence, seed_radius, speed};
+  mg_.followSegments(fibonacciSegment, &spiral, num_segments);
 }
 
 void ShapeGenerator::archimedeanSpiral(const float spiral_factor,
                                        const float total_angle_deg,
                                        const float speed) const {
-  float angle_step = 5;
-  float current_angle = 0;
-  for (int i = 0; i < total_angle_deg; i += angle_step) {
-    float radius_of_curvature_mm = spiral_factor * current_angle;
-    mg_.rotateAngleDegAtSpeed(angle_step, speed, radius_of_curvature_mm);
-    current_angle += angle_step;
-  }
+  mg_.spiralAngleDegAtSpeed(
+      total_angle_deg, speed, 0, spiral_factor * total_angle_deg);
+}
+
+void ShapeGenerator::smoothFibonacciSpiral(const float seed_radius,
+                                           const int num_segments,
+                                           const float speed) const {
+  int fibonacci_sequence[num_segments];
+  computeFibonacciSequence(num_segments, fibonacci_sequence);
+  const float end_radius = fibonacci_sequence[num_segments - 1] * seed_radius;
+  mg_.spiralAngleDegAtSpeed(
+      90 * num_segments, speed, seed_radius, end_radius, true);
+}
+
+void ShapeGenerator::clothoid(const float length_mm,
+                              const float end_radius_mm,
+                              const float speed) const {
+  if (end_radius_mm == 0) return;
+  mg_.moveClothoidAtSpeed(length_mm, speed, 0, 1.0 / end_radius_mm);
 }
 
 void ShapeGenerator::snake(const float length_mm,
@@ -83,23 +153,22 @@ void ShapeGenerator::snake(const float length_mm,
   float snaking_angle_deg = snaking_angle_deg_in;
   float secant_length = length_mm / num_elements;
   float theta_rad = radians(snaking_angle_deg);
-  float radius_of_curvature_mm = secant_length / (2 * sin(theta_rad / 2));
-  mg_.rotateAngleDegAtSpeed(-snaking_angle_deg / 2, speed);
-  for (int i = 0; i < num_elements; ++i) {
-    mg_.rotateAngleDegAtSpeed(
-        snaking_angle_deg + turning_rate_deg, speed, radius_of_curvature_mm);
-    snaking_angle_deg = -snaking_angle_deg;
-  }
+  float radius_of_curvature_mm =
+      secant_length / (2 * fastSin(theta_rad / 2));
+  const Snake snake = {
+      snaking_angle_deg, radius_of_curvature_mm, turning_rate_deg, speed};
+  mg_.followSegments(snakeSegment, &snake, num_elements + 1);
 }
 
 void ShapeGenerator::heart() const {
   float speed = 200;
-  mg_.rotateAngleDegAtSpeed(45, speed);
-  mg_.moveStraightAtSpeed(200, speed);
-  mg_.rotateAngleDegAtSpeed(230, speed, 100);
-  mg_.rotateAngleDegAtSpeed(-180, speed);
-  mg_.rotateAngleDegAtSpeed(230, speed, 100);
-  mg_.moveStraightAtSpeed(230, speed);
+  const MotionSegment segments[] = {MotionSegment::rotation(45, speed),
+                                    MotionSegment::straight(200, speed),
+                                    MotionSegment::arc(230, 100, speed),
+                                    MotionSegment::rotation(-180, speed),
+                                    MotionSegment::arc(230, 100, speed),
+                                    MotionSegment::straight(230, speed)};
+  mg_.followSegments(segments, 6);
 }
 
 void ShapeGenerator::computeFibonacciSequence(const int number_of_elements,
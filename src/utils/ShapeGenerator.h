@@ -9,6 +9,11 @@
  * @class ShapeGenerator
  * @brief Class that wraps the MotionGenerator module and offers predefined
  * shapes.
+ *
+ * Shapes made of several lines and arcs are executed as a single sequence of
+ * segments. With a velocity profile set, the speed is carried through the
+ * junctions and the robot only stops where required. Without one, the robot
+ * stops at the end of every line and arc.
  */
 class ShapeGenerator {
  public:
@@ -21,6 +26,12 @@ class ShapeGenerator {
                  const float slip_factor = 1.0,
                  const RobotParams& robot_params = RobotParams());
 
+  /**
+   * @brief Sets the velocity profile of the shapes drawn afterwards.
+   * @param type Shape of the profile, NONE to stop after every line and arc.
+   */
+  void setVelocityProfile(const VelocityProfile::Type type);
+
   /**
    * @brief Rotates the robot the specified angle at the given speed.
    * @param angle_deg Angle to rotate in degrees.
@@ -101,7 +112,19 @@ class ShapeGenerator {
                        const float speed = 200) const;
 
   /**
-   * @brief Describes an Archimedean spiral motion.
+   * @brief Describes a Fibonacci spiral as a single motion whose radius grows
+   * continuously instead of in steps every 90 degrees.
+   * @param seed_radius Initial radius of the spiral.
+   * @param num_segments Number of segments of 90 degrees of the spiral.
+   * @param speed Speed to move at.
+   */
+  void smoothFibonacciSpiral(const float seed_radius,
+                             const int num_segments,
+                             const float speed = 200) const;
+
+  /**
+   * @brief Describes an Archimedean spiral motion. The radius grows
+   * continuously with the turned angle.
    * @param spiral_factor Constant factor for the spiral.
    * @param total_angle_deg Total angle of the spiral in degrees.
    * @param speed Speed to move at.
@@ -110,6 +133,18 @@ class ShapeGenerator {
                          const float total_angle_deg,
                          const float speed = 200) const;
 
+  /**
+   * @brief Describes a clothoid that turns from a straight line into an arc
+   * of the given radius, with a curvature that grows linearly with the
+   * travelled distance.
+   * @param length_mm Length of the clothoid.
+   * @param end_radius_mm Radius at the end, positive counterclockwise.
+   * @param speed Speed to move at.
+   */
+  void clothoid(const float length_mm,
+                const float end_radius_mm,
+                const float speed = 200) const;
+
   /**
    * @brief Describes an ondulatory motion (like a snake).
    * @param length_mm Length of the motion in millimeters.
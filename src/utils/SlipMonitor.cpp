@@ -0,0 +1,106 @@
+#include "SlipMonitor.h"
+
+#define STALL_RATIO 0.1              // Stalled below this fraction of expected
+#define MIN_CHECKED_RPM 10           // Expected speeds below are not checked
+#define SLIP_BACK_OFF 0.8            // Scale applied every period of slip
+#define SCALE_RECOVERY_PS 1.0        // Scale recovered per second without slip
+#define CO_PROCESSOR_PERIOD_S 0.025  // Delay of the speed controller
+#define US_PER_MIN 60000000.0
+
+SlipMonitor::SlipMonitor(const RobotParams& robot_params,
+                         const float response_time_ms)
+    : pulses_per_rev_(robot_params.pulses_per_rev),
+      response_time_s_(response_time_ms / 1000.0),
+      margin_rpm_(20),
+      margin_ratio_(0.3) {
+  reset();
+}
+
+void SlipMonitor::setMargins(const float margin_rpm, const float margin_ratio) {
+  margin_rpm_ = abs(margin_rpm);
+  margin_ratio_ = abs(margin_ratio);
+}
+
+void SlipMonitor::reset() {
+  left_ = {0, 0, 0, WheelState::OK, WheelState::OK, 0};
+  right_ = {0, 0, 0, WheelState::OK, WheelState::OK, 0};
+  traction_scale_ = 1.0;
+}
+
+void SlipMonitor::update(const int left_rpm,
+                         const int right_rpm,
+                         const int left_pulses,
+                         const int right_pulses,
+                         const unsigned long period_us) {
+  if (period_us == 0) return;
+  const float rpm_per_pulse = US_PER_MIN / (pulses_per_rev_ * period_us);
+  const float period_s = period_us / 1000000.0;
+  updateWheel(left_, left_rpm, left_pulses * rpm_per_pulse, period_s);
+  updateWheel(right_, right_rpm, right_pulses * rpm_per_pulse, period_s);
+
+  if (isSlipping()) {
+    traction_scale_ = max(MIN_TRACTION_SCALE, traction_scale_ * SLIP_BACK_OFF);
+  } else {
+    traction_scale_ = min(1.0, traction_scale_ + SCALE_RECOVERY_PS * period_s);
+  }
+}
+
+SlipMonitor::WheelState SlipMonitor::getLeftState() const {
+  return left_.state;
+}
+
+SlipMonitor::WheelState SlipMonitor::getRightState() const {
+  return right_.state;
+}
+
+bool SlipMonitor::isSlipping() const {
+  return left_.state == WheelState::SLIPPING ||
+         right_.state == WheelState::SLIPPING;
+}
+
+bool SlipMonitor::isBlocked() const {
+  return left_.state == WheelState::BLOCKED ||
+         left_.state == WheelState::STALLED ||
+         right_.state == WheelState::BLOCKED ||
+         right_.state == WheelState::STALLED;
+}
+
+float SlipMonitor::getTractionScale() const { return traction_scale_; }
+
+void SlipMonitor::updateWheel(Wheel& wheel,
+                              const float command_rpm,
+                              const float measured_rpm,
+                              const float period_s) const {
+  // Speed expected at the end of the last period, which was driven by the
+  // command sent at its start. The command only reaches the motor at the
+  // next control period of the co-processor, a delay approximated by a
+  // first order lag.
+  const float delay_alpha = period_s / (CO_PROCESSOR_PERIOD_S + period_s);
+  wheel.delayed_rpm += delay_alpha * (wheel.command_rpm - wheel.delayed_rpm);
+  const float alpha = period_s / (response_time_s_ + period_s);
+  wheel.expected_rpm += alpha * (wheel.delayed_rpm - wheel.expected_rpm);
+  wheel.command_rpm = command_rpm;
+
+  const WheelState state = classify(wheel.expected_rpm, measured_rpm);
+  if (state != wheel.pending) {
+    wheel.pending = state;
+    wheel.count = 0;
+  }
+  if (wheel.count < DETECTION_PERIODS) ++wheel.count;
+  if (wheel.count >= DETECTION_PERIODS) wheel.state = state;
+}
+
+SlipMonitor::WheelState SlipMonitor::classify(const float expected_rpm,
+                                              const float measured_rpm) const {
+  if (abs(expected_rpm) < MIN_CHECKED_RPM) return WheelState::OK;
+  // Speeds along the direction of motion
+  const float expected = abs(expected_rpm);
+  const float measured = expected_rpm > 0 ? measured_rpm : -measured_rpm;
+  const float margin = margin_rpm_ + margin_ratio_ * expected;
+  if (measured > expected + margin) return WheelState::SLIPPING;
+  // Below the margin a wheel still starting cannot be told from a loaded one
+  if (expected < margin) return WheelState::OK;
+  if (measured < STALL_RATIO * expected) return WheelState::STALLED;
+  if (measured < expected - margin) return WheelState::BLOCKED;
+  return WheelState::OK;
+}
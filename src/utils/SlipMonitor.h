@@ -0,0 +1,146 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "RobotParams.h"
+
+#define DETECTION_PERIODS 2     // Periods in a row before a state is reported
+#define MIN_TRACTION_SCALE 0.4  // Lowest scale of the speeds after slip
+
+/**
+ * @class SlipMonitor
+ * @brief Detects wheel slip, blocked and stalled wheels by comparing the
+ * speeds commanded with moveRpm() to the speeds measured by the encoders.
+ *
+ * The speed of each wheel expected from the commands is modelled as the
+ * first order response of the speed controller of the co-processor, after
+ * the delay of its control period. Every control
+ * period the measured speed is compared to it:
+ *  - faster than expected: the wheel lost grip and spins up unloaded,
+ *  - slower than expected: the wheel is pushing against an obstacle,
+ *  - not turning although commanded: the wheel is stalled.
+ * A state is reported after DETECTION_PERIODS periods in a row, so faults
+ * are flagged within two control periods while single noisy readings are
+ * ignored.
+ *
+ * While a wheel slips the monitor backs off a traction scale that the
+ * caller applies to the commanded speeds, so the speed controller lowers the
+ * torque until the wheels grip again. The scale recovers gradually once the
+ * slip ends. MotionGenerator applies the scale and can abort a motion when a
+ * wheel is blocked or stalled (see MotionGenerator::setSlipMonitor).
+ */
+class SlipMonitor {
+ public:
+  /**
+   * @brief State of a wheel.
+   */
+  enum class WheelState {
+    OK,        ///< Measured speed matches the command.
+    SLIPPING,  ///< Faster than expected, the wheel spins.
+    BLOCKED,   ///< Slower than expected, the wheel is loaded.
+    STALLED    ///< Not turning although commanded.
+  };
+
+  /**
+   * @brief Constructor for SlipMonitor.
+   * @param robot_params Robot params.
+   * @param response_time_ms Time constant of the speed controller of the
+   * co-processor with the robot on the floor, after the delay of its 25 ms
+   * control period. Too short gives false blocks, too long false slips.
+   */
+  SlipMonitor(const RobotParams& robot_params = RobotParams(),
+              const float response_time_ms = 60);
+
+  /**
+   * @brief Sets the tolerance of the measured speeds.
+   * @param margin_rpm Speed difference always tolerated.
+   * @param margin_ratio Fraction of the expected speed also tolerated.
+   */
+  void setMargins(const float margin_rpm, const float margin_ratio);
+
+  /**
+   * @brief Clears the states and the expected speeds, e.g. before a motion
+   * starts from standstill.
+   */
+  void reset();
+
+  /**
+   * @brief Updates the states with the encoder pulses of the last control
+   * period and records the commands sent for the next one.
+   * @param left_rpm Left wheel speed commanded for the next period.
+   * @param right_rpm Right wheel speed commanded for the next period.
+   * @param left_pulses Left encoder pulses of the last period.
+   * @param right_pulses Right encoder pulses of the last period.
+   * @param period_us Duration of the last period.
+   */
+  void update(const int left_rpm,
+              const int right_rpm,
+              const int left_pulses,
+              const int right_pulses,
+              const unsigned long period_us);
+
+  /**
+   * @brief Gets the state of the left wheel.
+   */
+  WheelState getLeftState() const;
+
+  /**
+   * @brief Gets the state of the right wheel.
+   */
+  WheelState getRightState() const;
+
+  /**
+   * @brief Checks if a wheel slips.
+   */
+  bool isSlipping() const;
+
+  /**
+   * @brief Checks if a wheel is blocked or stalled.
+   */
+  bool isBlocked() const;
+
+  /**
+   * @brief Gets the scale to apply to the commanded speeds.
+   * @return Value from MIN_TRACTION_SCALE to 1, below 1 after slip.
+   */
+  float getTractionScale() const;
+
+ private:
+  /**
+   * @brief Expected speed and detection state of a wheel.
+   */
+  struct Wheel {
+    float command_rpm;   ///< Speed commanded for the current period.
+    float delayed_rpm;   ///< Command delayed by the co-processor.
+    float expected_rpm;  ///< Speed expected from the commands.
+    WheelState state;    ///< Reported state.
+    WheelState pending;  ///< State seen in the last periods.
+    byte count;          ///< Periods in a row with the pending state.
+  };
+
+  /**
+   * @brief Updates the state of a wheel.
+   * @param wheel Wheel to update.
+   * @param command_rpm Speed commanded for the next period.
+   * @param measured_rpm Speed measured in the last period.
+   * @param period_s Duration of the last period.
+   */
+  void updateWheel(Wheel& wheel,
+                   const float command_rpm,
+                   const float measured_rpm,
+                   const float period_s) const;
+
+  /**
+   * @brief Classifies a wheel by comparing the measured and expected speeds.
+   */
+  WheelState classify(const float expected_rpm,
+                      const float measured_rpm) const;
+
+  float pulses_per_rev_;   ///< Encoder pulses per wheel revolution.
+  float response_time_s_;  ///< Time constant of the speed controller.
+  float margin_rpm_;       ///< Speed difference always tolerated.
+  float margin_ratio_;     ///< Fraction of the expected speed tolerated.
+  Wheel left_;             ///< Left wheel.
+  Wheel right_;            ///< Right wheel.
+  float traction_scale_;   ///< Scale applied to the commanded speeds.
+};
@@ -0,0 +1,74 @@
+#include "SpeedGovernor.h"
+
+#define CURVATURE_DECAY_MM 150  // Distance to forget a curve after it ends
+
+SpeedGovernor::SpeedGovernor(const RobotParams& robot_params)
+    : cut_(ControlUtils(robot_params)),
+      track_width_mm_(robot_params.track_width_mm),
+      max_accel_mmps2_(robot_params.max_accel_mmps2),
+      max_lateral_accel_mmps2_(robot_params.max_lateral_accel_mmps2),
+      max_speed_mmps_(1000),
+      min_speed_mmps_(100),
+      speed_mmps_(100),
+      curvature_(0),
+      sample_distance_mm_(0),
+      sample_heading_rad_(0),
+      sample_line_bearing_rad_(0),
+      line_bearing_rad_(0) {}
+
+void SpeedGovernor::setSpeedLimits(const float max_speed_mmps,
+                                   const float min_speed_mmps) {
+  max_speed_mmps_ = abs(max_speed_mmps);
+  min_speed_mmps_ = min(abs(min_speed_mmps), max_speed_mmps_);
+  speed_mmps_ = constrain(speed_mmps_, min_speed_mmps_, max_speed_mmps_);
+}
+
+void SpeedGovernor::setLateralAccelLimit(const float max_lateral_accel_mmps2) {
+  max_lateral_accel_mmps2_ = abs(max_lateral_accel_mmps2);
+}
+
+void SpeedGovernor::reset() {
+  speed_mmps_ = min_speed_mmps_;
+  curvature_ = 0;
+  sample_distance_mm_ = 0;
+  sample_heading_rad_ = 0;
+  sample_line_bearing_rad_ = line_bearing_rad_;
+}
+
+void SpeedGovernor::update(const int left_pulses,
+                           const int right_pulses,
+                           const int line_position) {
+  const float left_mm = cut_.computeLeftDistanceFromPulses(left_pulses);
+  const float right_mm = cut_.computeRightDistanceFromPulses(right_pulses);
+  const float distance_mm = (left_mm + right_mm) / 2.0;
+  sample_distance_mm_ += abs(distance_mm);
+  sample_heading_rad_ += (right_mm - left_mm) / track_width_mm_;
+  line_bearing_rad_ = cut_.computeLineBearingRad(line_position);
+  if (sample_distance_mm_ < GOVERNOR_SAMPLE_DISTANCE_MM) return;
+
+  // The track turns by the robot turn plus the change of the line bearing.
+  // The estimate follows a curve at once and forgets it over a distance.
+  const float track_turn_rad =
+      sample_heading_rad_ + (line_bearing_rad_ - sample_line_bearing_rad_);
+  const float curvature = abs(track_turn_rad) / sample_distance_mm_;
+  const float decay = max(0.0, 1.0 - sample_distance_mm_ / CURVATURE_DECAY_MM);
+  curvature_ = max(curvature, curvature_ * decay);
+
+  float speed_mmps = max_speed_mmps_;
+  if (curvature_ > 0) {
+    speed_mmps = min(speed_mmps, sqrt(max_lateral_accel_mmps2_ / curvature_));
+  }
+  speed_mmps = max(speed_mmps, min_speed_mmps_);
+  // Accelerate over the distance travelled, brake at once
+  const float accelerated_mmps = sqrt(
+      speed_mmps_ * speed_mmps_ + 2 * max_accel_mmps2_ * sample_distance_mm_);
+  speed_mmps_ = min(speed_mmps, accelerated_mmps);
+
+  sample_distance_mm_ = 0;
+  sample_heading_rad_ = 0;
+  sample_line_bearing_rad_ = line_bearing_rad_;
+}
+
+float SpeedGovernor::getSpeedMmps() const { return speed_mmps_; }
+
+float SpeedGovernor::getCurvature() const { return curvature_; }
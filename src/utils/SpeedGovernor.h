@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "ControlUtils.h"
+#include "RobotParams.h"
+
+#define GOVERNOR_SAMPLE_DISTANCE_MM 10  // Distance per curvature estimate
+
+/**
+ * @class SpeedGovernor
+ * @brief Schedules the speed of line following from the curvature of the
+ * track.
+ *
+ * The curvature is estimated every GOVERNOR_SAMPLE_DISTANCE_MM travelled, not
+ * every control cycle, from the turn of the robot, given by the wheel
+ * distance difference, plus the change of the bearing of the line seen by
+ * the sensor, given by readLine(). As the sensor is ahead of the wheels, the
+ * line starts to drift under it before the robot turns, so a curve is
+ * detected before the robot reaches it.
+ *
+ * The speed is the one allowed by the lateral acceleration limit on the
+ * estimated curvature. It drops at once when a curve is detected and rises
+ * with the maximum acceleration of RobotParams once the track straightens.
+ * The steering is still done by the caller from the line position.
+ */
+class SpeedGovernor {
+ public:
+  /**
+   * @brief Constructor for SpeedGovernor.
+   * @param robot_params Robot params, including the lateral acceleration
+   * limit.
+   */
+  SpeedGovernor(const RobotParams& robot_params = RobotParams());
+
+  /**
+   * @brief Sets the speed limits.
+   * @param max_speed_mmps Speed on straights.
+   * @param min_speed_mmps Lowest speed, on the tightest curves.
+   */
+  void setSpeedLimits(const float max_speed_mmps,
+                      const float min_speed_mmps = 100);
+
+  /**
+   * @brief Sets the lateral acceleration limit, overriding RobotParams.
+   * @param max_lateral_accel_mmps2 Maximum lateral acceleration in
+   * millimeters per second squared.
+   */
+  void setLateralAccelLimit(const float max_lateral_accel_mmps2);
+
+  /**
+   * @brief Restarts at the lowest speed, e.g. after the robot stopped.
+   */
+  void reset();
+
+  /**
+   * @brief Updates the odometry, and the curvature estimate and the speed
+   * once enough distance was travelled. Call every control cycle.
+   * @param left_pulses Left encoder pulses since the previous update.
+   * @param right_pulses Right encoder pulses since the previous update.
+   * @param line_position Line position in the range [-100, 100], as returned
+   * by BnrOneAPlus::readLine(), positive when the line is on the right.
+   */
+  void update(const int left_pulses,
+              const int right_pulses,
+              const int line_position);
+
+  /**
+   * @brief Gets the speed to drive at.
+   * @return Speed in millimeters per second.
+   */
+  float getSpeedMmps() const;
+
+  /**
+   * @brief Gets the estimated curvature of the track ahead.
+   * @return Absolute curvature in 1/mm.
+   */
+  float getCurvature() const;
+
+ private:
+  ControlUtils cut_;               ///< Control utils object
+  float track_width_mm_;           ///< Effective track width.
+  float max_accel_mmps2_;          ///< Maximum acceleration.
+  float max_lateral_accel_mmps2_;  ///< Maximum lateral acceleration.
+  float max_speed_mmps_;           ///< Speed on straights.
+  float min_speed_mmps_;           ///< Lowest speed.
+  float speed_mmps_;               ///< Scheduled speed.
+  float curvature_;                ///< Estimated curvature, 1/mm.
+  float sample_distance_mm_;       ///< Distance since the last estimate.
+  float sample_heading_rad_;       ///< Robot turn since the last estimate.
+  float sample_line_bearing_rad_;  ///< Line bearing at the last estimate.
+  float line_bearing_rad_;         ///< Line bearing of the last update.
+};
@@ -0,0 +1,130 @@
+#include "TaskScheduler.h"
+
+namespace {
+const TaskStats NO_STATS = {0, 0, 0, 0, 0};
+}
+
+TaskScheduler::TaskScheduler()
+    : num_tasks_(0), next_background_(0), start_us_(0), busy_us_(0) {}
+
+int TaskScheduler::addTask(TaskFunction function,
+                           const unsigned long period_ms,
+                           const byte priority) {
+  if (num_tasks_ >= MAX_TASKS || function == nullptr) return -1;
+  Task& task = tasks_[num_tasks_];
+  task.function = function;
+  task.period_us = period_ms * 1000;
+  task.priority = priority;
+  task.enabled = true;
+  task.release_us = micros();
+  task.stats = NO_STATS;
+  return num_tasks_++;
+}
+
+void TaskScheduler::setEnabled(const int task_id, const bool enabled) {
+  if (task_id < 0 || task_id >= num_tasks_) return;
+  Task& task = tasks_[task_id];
+  if (enabled && !task.enabled) task.release_us = micros();
+  task.enabled = enabled;
+}
+
+void TaskScheduler::start() {
+  const unsigned long now_us = micros();
+  for (byte i = 0; i < num_tasks_; ++i) {
+    tasks_[i].release_us = now_us;
+  }
+  resetStats();
+  start_us_ = now_us;
+}
+
+bool TaskScheduler::run() {
+  const unsigned long now_us = micros();
+  int index = findReleasedTask(now_us);
+  if (index < 0) index = findBackgroundTask();
+  if (index < 0) return false;
+  runTask(tasks_[index], now_us);
+  return true;
+}
+
+const TaskStats& TaskScheduler::getStats(const int task_id) const {
+  if (task_id < 0 || task_id >= num_tasks_) return NO_STATS;
+  return tasks_[task_id].stats;
+}
+
+unsigned long TaskScheduler::getMeanRunUs(const int task_id) const {
+  const TaskStats& stats = getStats(task_id);
+  if (stats.run_count == 0) return 0;
+  return stats.total_run_us / stats.run_count;
+}
+
+float TaskScheduler::getLoad() const {
+  const unsigned long elapsed_us = micros() - start_us_;
+  if (elapsed_us == 0) return 0;
+  return 100.0 * busy_us_ / elapsed_us;
+}
+
+void TaskScheduler::resetStats() {
+  for (byte i = 0; i < num_tasks_; ++i) {
+    tasks_[i].stats = NO_STATS;
+  }
+  start_us_ = micros();
+  busy_us_ = 0;
+}
+
+int TaskScheduler::findReleasedTask(const unsigned long now_us) const {
+  int index = -1;
+  unsigned long oldest_us = 0;
+  for (byte i = 0; i < num_tasks_; ++i) {
+    const Task& task = tasks_[i];
+    if (!task.enabled || task.period_us == 0) continue;
+    const unsigned long age_us = now_us - task.release_us;
+    // Not released yet
+    if ((long)age_us < 0) continue;
+    if (index < 0 || task.priority > tasks_[index].priority ||
+        (task.priority == tasks_[index].priority && age_us > oldest_us)) {
+      index = i;
+      oldest_us = age_us;
+    }
+  }
+  return index;
+}
+
+int TaskScheduler::findBackgroundTask() {
+  for (byte i = 0; i < num_tasks_; ++i) {
+    const byte index = (next_background_ + i) % num_tasks_;
+    const Task& task = tasks_[index];
+    if (task.enabled && task.period_us == 0) {
+      next_background_ = index + 1;
+      return index;
+    }
+  }
+  return -1;
+}
+
+void TaskScheduler::runTask(Task& task, const unsigned long now_us) {
+  const bool periodic = task.period_us > 0;
+  if (periodic) {
+    task.stats.max_latency_us =
+        max(task.stats.max_latency_us, now_us - task.release_us);
+    // Releases that passed before the task could start are skipped
+    while (now_us - task.release_us >= task.period_us) {
+      task.release_us += task.period_us;
+      ++task.stats.missed_deadlines;
+    }
+  }
+
+  const unsigned long start_us = micros();
+  task.function();
+  const unsigned long end_us = micros();
+  const unsigned long run_us = end_us - start_us;
+
+  ++task.stats.run_count;
+  task.stats.total_run_us += run_us;
+  task.stats.max_run_us = max(task.stats.max_run_us, run_us);
+  if (!periodic) return;
+
+  busy_us_ += run_us;
+  task.release_us += task.period_us;
+  // Completed after its next release
+  if ((long)(end_us - task.release_us) > 0) ++task.stats.missed_deadlines;
+}
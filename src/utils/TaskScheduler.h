@@ -0,0 +1,143 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define MAX_TASKS 8  // Tasks that can be added to a scheduler
+
+/**
+ * @brief Function run by a task.
+ */
+typedef void (*TaskFunction)();
+
+/**
+ * @brief Run-time statistics of a task.
+ */
+struct TaskStats {
+  unsigned long run_count;         ///< Number of runs.
+  unsigned long missed_deadlines;  ///< Releases not completed in time.
+  unsigned long max_run_us;        ///< Longest run time.
+  unsigned long total_run_us;      ///< Sum of the run times.
+  unsigned long max_latency_us;    ///< Longest delay from release to start.
+};
+
+/**
+ * @class TaskScheduler
+ * @brief Cooperative scheduler of fixed-rate tasks, called from loop().
+ *
+ * Each task is released every period, counted from its first release, so
+ * the timing does not drift with the run times. Every call to run() starts
+ * the released task of highest priority, the oldest release first among
+ * equal priorities, and returns after it completes. A task must complete
+ * before its next release: otherwise, or if it starts so late that a
+ * release was skipped, a deadline miss is counted. Tasks with a period of 0
+ * run in the background, whenever no periodic task is released, so the
+ * spare CPU time is used and measured.
+ *
+ * Tasks are not preempted, so a task must not block (e.g. with delay()):
+ * the control period is then held as long as every task is shorter than the
+ * slack of the tasks with higher priority. Tasks are stored in static arrays
+ * and no memory is allocated.
+ */
+class TaskScheduler {
+ public:
+  /**
+   * @brief Constructor for TaskScheduler.
+   */
+  TaskScheduler();
+
+  /**
+   * @brief Adds a task.
+   * @param function Function run by the task.
+   * @param period_ms Release period, or 0 for a background task.
+   * @param priority Priority, higher values run first.
+   * @return Task id, or -1 if MAX_TASKS tasks were already added.
+   */
+  int addTask(TaskFunction function,
+              const unsigned long period_ms,
+              const byte priority = 0);
+
+  /**
+   * @brief Enables or disables a task. An enabled task is released at once
+   * and then every period.
+   * @param task_id Task id returned by addTask.
+   * @param enabled true to run the task.
+   */
+  void setEnabled(const int task_id, const bool enabled);
+
+  /**
+   * @brief Releases all the enabled tasks now and clears the statistics.
+   * Call at the end of setup().
+   */
+  void start();
+
+  /**
+   * @brief Runs the released task of highest priority, or a background task
+   * if none is released. Call from loop() as often as possible.
+   * @return true if a task was run.
+   */
+  bool run();
+
+  /**
+   * @brief Gets the statistics of a task.
+   * @param task_id Task id returned by addTask.
+   */
+  const TaskStats& getStats(const int task_id) const;
+
+  /**
+   * @brief Gets the mean run time of a task.
+   * @param task_id Task id returned by addTask.
+   * @return Mean run time in microseconds.
+   */
+  unsigned long getMeanRunUs(const int task_id) const;
+
+  /**
+   * @brief Gets the fraction of the CPU time used by the periodic tasks since
+   * the start.
+   * @return Load in %.
+   */
+  float getLoad() const;
+
+  /**
+   * @brief Clears the statistics of all the tasks.
+   */
+  void resetStats();
+
+ private:
+  /**
+   * @brief Task and its schedule.
+   */
+  struct Task {
+    TaskFunction function;     ///< Function run by the task.
+    unsigned long period_us;   ///< Release period, 0 in the background.
+    byte priority;             ///< Priority, higher values run first.
+    bool enabled;              ///< Whether the task runs.
+    unsigned long release_us;  ///< Time of the pending release.
+    TaskStats stats;           ///< Run-time statistics.
+  };
+
+  /**
+   * @brief Finds the released task to run next.
+   * @param now_us Current time in microseconds.
+   * @return Task index, or -1 if no periodic task is released.
+   */
+  int findReleasedTask(const unsigned long now_us) const;
+
+  /**
+   * @brief Finds the next background task to run, in turn.
+   * @return Task index, or -1 if there is none.
+   */
+  int findBackgroundTask();
+
+  /**
+   * @brief Runs a task and updates its statistics and release.
+   * @param task Task to run.
+   * @param now_us Time at which the task starts.
+   */
+  void runTask(Task& task, const unsigned long now_us);
+
+  Task tasks_[MAX_TASKS];   ///< Tasks added.
+  byte num_tasks_;          ///< Number of tasks added.
+  byte next_background_;    ///< Background task to run next.
+  unsigned long start_us_;  ///< Time of the start.
+  unsigned long busy_us_;   ///< Run time of the periodic tasks.
+};
@@ -0,0 +1,144 @@
+#include "TrajectoryRecorder.h"
+
+#include <EEPROM.h>  // EEPROM reading and writing
+
+#define RECORDING_HEADER_SIZE 4  // Samples (2 bytes), period and line flag
+
+TrajectoryRecorder::TrajectoryRecorder(const BnrOneAPlus& one,
+                                       byte buffer[],
+                                       const int buffer_size,
+                                       const RobotParams& robot_params)
+    : one_(one),
+      cut_(ControlUtils(robot_params)),
+      buffer_(buffer),
+      buffer_size_(buffer_size),
+      num_samples_(0),
+      sample_period_ms_(50),
+      record_line_(false),
+      recording_(false),
+      left_residue_mm_(0),
+      right_residue_mm_(0),
+      last_sample_us_(0) {}
+
+void TrajectoryRecorder::start(const byte sample_period_ms,
+                               const bool record_line) {
+  // Discard the pulses counted before the start
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.readAndResetEncoders(left_encoder, right_encoder);
+  num_samples_ = 0;
+  sample_period_ms_ = max(1, sample_period_ms);
+  record_line_ = record_line;
+  left_residue_mm_ = 0;
+  right_residue_mm_ = 0;
+  recording_ = true;
+  last_sample_us_ = micros();
+}
+
+bool TrajectoryRecorder::step() { return sample(0); }
+
+bool TrajectoryRecorder::step(const int line_position) {
+  return sample(line_position);
+}
+
+void TrajectoryRecorder::stop() { recording_ = false; }
+
+bool TrajectoryRecorder::isRecording() const { return recording_; }
+
+int TrajectoryRecorder::getNumSamples() const { return num_samples_; }
+
+byte TrajectoryRecorder::getSamplePeriodMs() const {
+  return sample_period_ms_;
+}
+
+bool TrajectoryRecorder::hasLinePosition() const { return record_line_; }
+
+int TrajectoryRecorder::getLeftMm(const int index) const {
+  return (int8_t)buffer_[index * getSampleSize()];
+}
+
+int TrajectoryRecorder::getRightMm(const int index) const {
+  return (int8_t)buffer_[index * getSampleSize() + 1];
+}
+
+int TrajectoryRecorder::getLinePosition(const int index) const {
+  if (!record_line_) return 0;
+  return (int8_t)buffer_[index * getSampleSize() + 2];
+}
+
+bool TrajectoryRecorder::save(const int eeprom_address) const {
+  const int size = num_samples_ * getSampleSize();
+  if (eeprom_address + RECORDING_HEADER_SIZE + size > (int)EEPROM.length()) {
+    return false;
+  }
+  // Update only writes the bytes that changed, saving EEPROM wear
+  EEPROM.update(eeprom_address, highByte(num_samples_));
+  EEPROM.update(eeprom_address + 1, lowByte(num_samples_));
+  EEPROM.update(eeprom_address + 2, sample_period_ms_);
+  EEPROM.update(eeprom_address + 3, record_line_ ? 1 : 0);
+  for (int i = 0; i < size; ++i) {
+    EEPROM.update(eeprom_address + RECORDING_HEADER_SIZE + i, buffer_[i]);
+  }
+  return true;
+}
+
+bool TrajectoryRecorder::load(const int eeprom_address) {
+  const int num_samples =
+      word(EEPROM.read(eeprom_address), EEPROM.read(eeprom_address + 1));
+  const byte sample_period_ms = EEPROM.read(eeprom_address + 2);
+  const byte line_flag = EEPROM.read(eeprom_address + 3);
+  // Erased EEPROM reads 0xFF
+  if (num_samples < 0 || sample_period_ms == 0 || line_flag > 1) {
+    return false;
+  }
+  const int size = num_samples * (line_flag ? 3 : 2);
+  if (size > buffer_size_ ||
+      eeprom_address + RECORDING_HEADER_SIZE + size > (int)EEPROM.length()) {
+    return false;
+  }
+  for (int i = 0; i < size; ++i) {
+    buffer_[i] = EEPROM.read(eeprom_address + RECORDING_HEADER_SIZE + i);
+  }
+  num_samples_ = num_samples;
+  sample_period_ms_ = sample_period_ms;
+  record_line_ = (line_flag == 1);
+  recording_ = false;
+  return true;
+}
+
+bool TrajectoryRecorder::sample(const int line_position) {
+  if (!recording_) return false;
+
+  const unsigned long now_us = micros();
+  if (now_us - last_sample_us_ < sample_period_ms_ * 1000UL) return true;
+  last_sample_us_ = now_us;
+
+  const int sample_size = getSampleSize();
+  if ((num_samples_ + 1) * sample_size > buffer_size_) {
+    recording_ = false;
+    return false;
+  }
+
+  int left_encoder = 0;
+  int right_encoder = 0;
+  one_.readAndResetEncoders(left_encoder, right_encoder);
+  left_residue_mm_ += cut_.computeLeftDistanceFromPulses(left_encoder);
+  right_residue_mm_ += cut_.computeRightDistanceFromPulses(right_encoder);
+
+  byte* sample = &buffer_[num_samples_ * sample_size];
+  sample[0] = (byte)encodeDistance(left_residue_mm_);
+  sample[1] = (byte)encodeDistance(right_residue_mm_);
+  if (record_line_) {
+    sample[2] = (byte)(int8_t)constrain(line_position, -100, 100);
+  }
+  ++num_samples_;
+  return true;
+}
+
+int TrajectoryRecorder::getSampleSize() const { return record_line_ ? 3 : 2; }
+
+int8_t TrajectoryRecorder::encodeDistance(float& residue_mm) const {
+  const int distance_mm = constrain((int)round(residue_mm), -127, 127);
+  residue_mm -= distance_mm;
+  return (int8_t)distance_mm;
+}
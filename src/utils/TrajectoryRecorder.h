@@ -0,0 +1,150 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "ControlUtils.h"
+#include "RobotParams.h"
+
+#define TRAJECTORY_EEPROM_ADDRESS 512  // Default EEPROM address of recordings
+
+/**
+ * @class TrajectoryRecorder
+ * @brief Records the path driven by the robot, e.g. pushed by hand or
+ * following a line, so that it can be replayed with TrajectoryReplayer.
+ *
+ * At fixed intervals the encoders are read and reset and the distance
+ * travelled by each wheel is stored as a signed byte in millimeters, with
+ * the fraction and anything above the byte range carried over to the next
+ * sample so no distance is lost. The line position can optionally be stored
+ * with each sample. Samples are kept in a buffer given by the caller and can
+ * be saved in EEPROM.
+ *
+ * The encoders must not be read and reset by other code while recording.
+ */
+class TrajectoryRecorder {
+ public:
+  /**
+   * @brief Constructor for TrajectoryRecorder.
+   * @param one Reference to BnrOneAPlus object.
+   * @param buffer Buffer where the samples are stored.
+   * @param buffer_size Size of the buffer in bytes.
+   * @param robot_params Robot params.
+   */
+  TrajectoryRecorder(const BnrOneAPlus& one,
+                     byte buffer[],
+                     const int buffer_size,
+                     const RobotParams& robot_params = RobotParams());
+
+  /**
+   * @brief Clears the buffer and starts recording. Call step() until it
+   * returns false or stop() is called.
+   * @param sample_period_ms Time between samples in milliseconds.
+   * @param record_line true to store the line position passed to step().
+   */
+  void start(const byte sample_period_ms = 50, const bool record_line = false);
+
+  /**
+   * @brief Stores a sample if the sample period has elapsed.
+   * @return true while recording, false when stopped or the buffer is full.
+   */
+  bool step();
+
+  /**
+   * @brief Stores a sample with the line position if the sample period has
+   * elapsed.
+   * @param line_position Line position in the range [-100, 100], as returned
+   * by BnrOneAPlus::readLine().
+   * @return true while recording, false when stopped or the buffer is full.
+   */
+  bool step(const int line_position);
+
+  /**
+   * @brief Stops recording.
+   */
+  void stop();
+
+  /**
+   * @brief Checks if recording is in progress.
+   */
+  bool isRecording() const;
+
+  /**
+   * @brief Gets the number of samples recorded.
+   */
+  int getNumSamples() const;
+
+  /**
+   * @brief Gets the time between samples in milliseconds.
+   */
+  byte getSamplePeriodMs() const;
+
+  /**
+   * @brief Checks if the line position is stored with the samples.
+   */
+  bool hasLinePosition() const;
+
+  /**
+   * @brief Gets the distance travelled by the left wheel during a sample.
+   * @param index Index of the sample.
+   * @return Distance in millimeters.
+   */
+  int getLeftMm(const int index) const;
+
+  /**
+   * @brief Gets the distance travelled by the right wheel during a sample.
+   * @param index Index of the sample.
+   * @return Distance in millimeters.
+   */
+  int getRightMm(const int index) const;
+
+  /**
+   * @brief Gets the line position at the end of a sample.
+   * @param index Index of the sample.
+   * @return Line position in the range [-100, 100], 0 if not recorded.
+   */
+  int getLinePosition(const int index) const;
+
+  /**
+   * @brief Saves the recording in EEPROM.
+   * @param eeprom_address First EEPROM address of the recording.
+   * @return false if the recording does not fit in EEPROM.
+   */
+  bool save(const int eeprom_address = TRAJECTORY_EEPROM_ADDRESS) const;
+
+  /**
+   * @brief Loads a recording saved in EEPROM into the buffer.
+   * @param eeprom_address First EEPROM address of the recording.
+   * @return false if no recording that fits in the buffer is saved there.
+   */
+  bool load(const int eeprom_address = TRAJECTORY_EEPROM_ADDRESS);
+
+ private:
+  /**
+   * @brief Reads the encoders and stores a sample if the sample period has
+   * elapsed.
+   */
+  bool sample(const int line_position);
+
+  /**
+   * @brief Gets the number of bytes of each sample.
+   */
+  int getSampleSize() const;
+
+  /**
+   * @brief Converts a distance to the stored byte, keeping in the residue
+   * what does not fit.
+   */
+  int8_t encodeDistance(float& residue_mm) const;
+
+  const BnrOneAPlus& one_;        ///< Reference to BnrOneAPlus object.
+  ControlUtils cut_;              ///< Control utils object
+  byte* buffer_;                  ///< Buffer where the samples are stored.
+  int buffer_size_;               ///< Size of the buffer in bytes.
+  int num_samples_;               ///< Number of samples recorded.
+  byte sample_period_ms_;         ///< Time between samples.
+  bool record_line_;              ///< Whether the line position is stored.
+  bool recording_;                ///< Whether recording is in progress.
+  float left_residue_mm_;         ///< Left distance not stored yet.
+  float right_residue_mm_;        ///< Right distance not stored yet.
+  unsigned long last_sample_us_;  ///< Time of the last sample.
+};
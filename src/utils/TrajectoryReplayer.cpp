@@ -0,0 +1,130 @@
+#include "TrajectoryReplayer.h"
+
+#define SEGMENT_LENGTH_MM 60  // Samples are merged up to this length
+#define SEGMENT_ANGLE_DEG 20  // or up to this angle
+
+TrajectoryReplayer::TrajectoryReplayer(const TrajectoryRecorder& recorder,
+                                       MotionGenerator& mg,
+                                       const RobotParams& robot_params)
+    : recorder_(recorder),
+      mg_(mg),
+      track_width_mm_(robot_params.track_width_mm),
+      speed_multiplier_(1.0),
+      max_speed_mmps_(600),
+      max_lateral_accel_mmps2_(1000),
+      min_speed_mmps_(50),
+      next_sample_(0),
+      running_(false) {}
+
+void TrajectoryReplayer::setSpeedLimits(const float speed_multiplier,
+                                        const float max_speed_mmps,
+                                        const float max_lateral_accel_mmps2,
+                                        const float min_speed_mmps) {
+  speed_multiplier_ = abs(speed_multiplier);
+  max_speed_mmps_ = abs(max_speed_mmps);
+  max_lateral_accel_mmps2_ = abs(max_lateral_accel_mmps2);
+  min_speed_mmps_ = min(abs(min_speed_mmps), max_speed_mmps_);
+}
+
+void TrajectoryReplayer::start() {
+  mg_.abort();
+  mg_.setSegmentQueue(queue_, MAX_QUEUED_SEGMENTS);
+  next_sample_ = 0;
+  running_ = true;
+  // The first segments are queued before the first one starts so its exit
+  // speed can be planned
+  queueSegments();
+}
+
+bool TrajectoryReplayer::step() {
+  if (!running_) return false;
+
+  queueSegments();
+  if (!mg_.step() && next_sample_ >= recorder_.getNumSamples()) {
+    mg_.setSegmentQueue(nullptr, 0);
+    running_ = false;
+  }
+  return running_;
+}
+
+void TrajectoryReplayer::replay() {
+  start();
+  while (step()) {
+  }
+}
+
+bool TrajectoryReplayer::isDone() const { return !running_; }
+
+void TrajectoryReplayer::abort() {
+  mg_.abort();
+  mg_.setSegmentQueue(nullptr, 0);
+  running_ = false;
+}
+
+void TrajectoryReplayer::queueSegments() {
+  const int num_samples = recorder_.getNumSamples();
+  const float period_s = recorder_.getSamplePeriodMs() / 1000.0;
+  // Backward arcs take two segments
+  while (next_sample_ < num_samples &&
+         mg_.getNumQueuedSegments() <= MAX_QUEUED_SEGMENTS - 2) {
+    long int left_mm = 0;
+    long int right_mm = 0;
+    int num_moving_samples = 0;
+    while (next_sample_ < num_samples) {
+      const int left_sample_mm = recorder_.getLeftMm(next_sample_);
+      const int right_sample_mm = recorder_.getRightMm(next_sample_);
+      // Forward and backward motions are not merged
+      if ((left_sample_mm + right_sample_mm) * (left_mm + right_mm) < 0) {
+        break;
+      }
+      ++next_sample_;
+      if (left_sample_mm == 0 && right_sample_mm == 0) continue;
+
+      left_mm += left_sample_mm;
+      right_mm += right_sample_mm;
+      ++num_moving_samples;
+      const float angle_deg = degrees((right_mm - left_mm) / track_width_mm_);
+      if (abs(left_mm + right_mm) / 2.0 >= SEGMENT_LENGTH_MM ||
+          abs(angle_deg) >= SEGMENT_ANGLE_DEG) {
+        break;
+      }
+    }
+    if (num_moving_samples == 0) return;
+
+    const float time_s = num_moving_samples * period_s;
+    const float wheel_mm = max(abs(left_mm), abs(right_mm));
+    const float distance_mm = (left_mm + right_mm) / 2.0;
+    const float angle_rad = (right_mm - left_mm) / track_width_mm_;
+    MotionSegment segment;
+    if (left_mm == right_mm) {
+      segment = MotionSegment::straight(distance_mm);
+    } else if (distance_mm > 0) {
+      segment = MotionSegment::arc(degrees(angle_rad), distance_mm / angle_rad);
+    } else {
+      // Arcs can only be driven forwards, so backward arcs are replaced by a
+      // rotation followed by a backward line
+      segment = MotionSegment::rotation(degrees(angle_rad));
+      segment.speed = computeSpeed(segment, wheel_mm, time_s);
+      mg_.queueSegment(segment);
+      if (distance_mm == 0) continue;
+      segment = MotionSegment::straight(distance_mm);
+    }
+    segment.speed = computeSpeed(segment, wheel_mm, time_s);
+    mg_.queueSegment(segment);
+  }
+}
+
+float TrajectoryReplayer::computeSpeed(const MotionSegment& segment,
+                                       const float wheel_mm,
+                                       const float time_s) const {
+  // Rotations in place are driven at the wheel speed, the rest at the speed
+  // of the centre of the robot
+  const float length_mm = segment.getLengthMm();
+  const float recorded_mm = (length_mm > 0) ? length_mm : wheel_mm;
+  float speed = speed_multiplier_ * recorded_mm / time_s;
+  const float curvature = abs(segment.getCurvature());
+  if (curvature > 0) {
+    speed = min(speed, (float)sqrt(max_lateral_accel_mmps2_ / curvature));
+  }
+  return constrain(speed, min_speed_mmps_, max_speed_mmps_);
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "MotionGenerator.h"
+#include "RobotParams.h"
+#include "TrajectoryRecorder.h"
+
+/**
+ * @class TrajectoryReplayer
+ * @brief Replays a path recorded with TrajectoryRecorder through the segment
+ * queue of a MotionGenerator.
+ *
+ * Consecutive samples are merged into straight lines, arcs and rotations in
+ * place. Each segment is driven at the recorded speed multiplied by a speed
+ * multiplier, limited by a maximum speed and, on arcs, by the maximum
+ * lateral acceleration. The replayer owns the segment queue of the
+ * MotionGenerator while it runs and keeps it filled so the speed at the
+ * junctions ahead can be planned. Pauses of the recording are skipped.
+ */
+class TrajectoryReplayer {
+ public:
+  /**
+   * @brief Constructor for TrajectoryReplayer.
+   * @param recorder Recorder holding the recorded path.
+   * @param mg Motion generator that executes the segments.
+   * @param robot_params Robot params.
+   */
+  TrajectoryReplayer(const TrajectoryRecorder& recorder,
+                     MotionGenerator& mg,
+                     const RobotParams& robot_params = RobotParams());
+
+  /**
+   * @brief Sets the speed of the replay.
+   * @param speed_multiplier Ratio between the replay and recorded speeds.
+   * @param max_speed_mmps Highest speed in millimeters per second.
+   * @param max_lateral_accel_mmps2 Maximum lateral acceleration, which limits
+   * the speed on arcs.
+   * @param min_speed_mmps Lowest speed in millimeters per second.
+   */
+  void setSpeedLimits(const float speed_multiplier,
+                      const float max_speed_mmps = 600,
+                      const float max_lateral_accel_mmps2 = 1000,
+                      const float min_speed_mmps = 50);
+
+  /**
+   * @brief Starts replaying the recording from the beginning without
+   * blocking. Call step() until it returns false.
+   */
+  void start();
+
+  /**
+   * @brief Queues the next segments and steps the motion generator.
+   * @return true while replaying, false when done.
+   */
+  bool step();
+
+  /**
+   * @brief Replays the whole recording. Blocks until the replay is complete.
+   */
+  void replay();
+
+  /**
+   * @brief Checks if the replay is complete or was aborted.
+   */
+  bool isDone() const;
+
+  /**
+   * @brief Brakes the robot and stops replaying.
+   */
+  void abort();
+
+ private:
+  /**
+   * @brief Merges the next samples into segments and adds them to the
+   * queue of the motion generator while there is room.
+   */
+  void queueSegments();
+
+  /**
+   * @brief Computes the speed of a segment from the recorded speed and the
+   * speed limits.
+   * @param segment Segment driven.
+   * @param wheel_mm Distance travelled by the fastest wheel.
+   * @param time_s Recorded time of the segment.
+   */
+  float computeSpeed(const MotionSegment& segment,
+                     const float wheel_mm,
+                     const float time_s) const;
+
+  const TrajectoryRecorder& recorder_;  ///< Recorded path.
+  MotionGenerator& mg_;                 ///< Executes the segments.
+  float track_width_mm_;                ///< Effective track width.
+  float speed_multiplier_;              ///< Replay to recorded speed ratio.
+  float max_speed_mmps_;                ///< Highest speed.
+  float max_lateral_accel_mmps2_;       ///< Maximum lateral acceleration.
+  float min_speed_mmps_;                ///< Lowest speed.
+  MotionSegment queue_[MAX_QUEUED_SEGMENTS];  ///< Queue used while running.
+  int next_sample_;                     ///< First sample not queued yet.
+  bool running_;                        ///< Whether replaying.
+};
@@ -0,0 +1,154 @@
+#include "VelocityEstimator.h"
+
+VelocityEstimator::VelocityEstimator(const RobotParams& robot_params,
+                                     const byte window_size,
+                                     const Method method,
+                                     const float filter_alpha)
+    : cut_(ControlUtils(robot_params)),
+      pulses_per_rev_(robot_params.pulses_per_rev),
+      window_size_(constrain(window_size, 2, MAX_VELOCITY_WINDOW)),
+      method_(method),
+      filter_alpha_(constrain(filter_alpha, 0.01, 1.0)) {
+  reset();
+}
+
+void VelocityEstimator::reset() {
+  newest_ = 0;
+  num_samples_ = 0;
+  left_pps_ = 0;
+  right_pps_ = 0;
+}
+
+void VelocityEstimator::readAndUpdate(const BnrOneAPlus& one) {
+  int left_pulses = 0;
+  int right_pulses = 0;
+  const unsigned long start_us = micros();
+  one.readAndResetEncoders(left_pulses, right_pulses);
+  const unsigned long end_us = micros();
+  addSample(left_pulses, right_pulses, start_us + (end_us - start_us) / 2);
+}
+
+void VelocityEstimator::addSample(const int left_pulses,
+                                  const int right_pulses) {
+  addSample(left_pulses, right_pulses, micros());
+}
+
+void VelocityEstimator::addSample(const int left_pulses,
+                                  const int right_pulses,
+                                  const unsigned long timestamp_us) {
+  long left_position = left_pulses;
+  long right_position = right_pulses;
+  if (num_samples_ > 0) {
+    left_position += left_position_[newest_];
+    right_position += right_position_[newest_];
+    newest_ = (newest_ + 1) % window_size_;
+  }
+  left_position_[newest_] = left_position;
+  right_position_[newest_] = right_position;
+  timestamp_us_[newest_] = timestamp_us;
+  if (num_samples_ < window_size_) {
+    ++num_samples_;
+  }
+  if (!isValid()) {
+    return;
+  }
+
+  float left_pps = 0;
+  float right_pps = 0;
+  if (method_ == Method::LEAST_SQUARES) {
+    computeLeastSquares(left_pps, right_pps);
+  } else {
+    computeFiniteDifference(left_pps, right_pps);
+  }
+  if (num_samples_ == 2) {
+    // First estimate: nothing to filter against
+    left_pps_ = left_pps;
+    right_pps_ = right_pps;
+  } else {
+    left_pps_ += filter_alpha_ * (left_pps - left_pps_);
+    right_pps_ += filter_alpha_ * (right_pps - right_pps_);
+  }
+}
+
+bool VelocityEstimator::isValid() const { return num_samples_ >= 2; }
+
+byte VelocityEstimator::indexOf(const byte i) const {
+  return (newest_ + window_size_ - (num_samples_ - 1) + i) % window_size_;
+}
+
+void VelocityEstimator::computeFiniteDifference(float& left_pps,
+                                                float& right_pps) const {
+  const byte oldest = indexOf(0);
+  const unsigned long elapsed_us =
+      timestamp_us_[newest_] - timestamp_us_[oldest];
+  if (elapsed_us == 0) {
+    left_pps = left_pps_;
+    right_pps = right_pps_;
+    return;
+  }
+  const float elapsed_s = elapsed_us / 1000000.0;
+  left_pps = (left_position_[newest_] - left_position_[oldest]) / elapsed_s;
+  right_pps =
+      (right_position_[newest_] - right_position_[oldest]) / elapsed_s;
+}
+
+void VelocityEstimator::computeLeastSquares(float& left_pps,
+                                            float& right_pps) const {
+  // Times and positions relative to the oldest sample keep the sums small
+  const byte oldest = indexOf(0);
+  float sum_t = 0;
+  float sum_tt = 0;
+  float sum_left = 0;
+  float sum_right = 0;
+  float sum_t_left = 0;
+  float sum_t_right = 0;
+  for (byte i = 0; i < num_samples_; ++i) {
+    const byte index = indexOf(i);
+    const float t =
+        (timestamp_us_[index] - timestamp_us_[oldest]) / 1000000.0;
+    const float left = left_position_[index] - left_position_[oldest];
+    const float right = right_position_[index] - right_position_[oldest];
+    sum_t += t;
+    sum_tt += t * t;
+    sum_left += left;
+    sum_right += right;
+    sum_t_left += t * left;
+    sum_t_right += t * right;
+  }
+  const float denominator = num_samples_ * sum_tt - sum_t * sum_t;
+  if (denominator <= 0) {
+    left_pps = left_pps_;
+    right_pps = right_pps_;
+    return;
+  }
+  left_pps = (num_samples_ * sum_t_left - sum_t * sum_left) / denominator;
+  right_pps = (num_samples_ * sum_t_right - sum_t * sum_right) / denominator;
+}
+
+float VelocityEstimator::getLeftPulsesPerSec() const { return left_pps_; }
+
+float VelocityEstimator::getRightPulsesPerSec() const { return right_pps_; }
+
+float VelocityEstimator::getLeftMmps() const {
+  return getSpeedsMmps().getLeft();
+}
+
+float VelocityEstimator::getRightMmps() const {
+  return getSpeedsMmps().getRight();
+}
+
+float VelocityEstimator::getLeftRpm() const {
+  return (left_pps_ * 60) / pulses_per_rev_;
+}
+
+float VelocityEstimator::getRightRpm() const {
+  return (right_pps_ * 60) / pulses_per_rev_;
+}
+
+WheelSpeeds VelocityEstimator::getSpeedsMmps() const {
+  return cut_.computeSpeedsMmps(getSpeedsRpm());
+}
+
+WheelSpeeds VelocityEstimator::getSpeedsRpm() const {
+  return WheelSpeeds(getLeftRpm(), getRightRpm());
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <BnrOneAPlus.h>
+
+#include "ControlUtils.h"
+#include "RobotParams.h"
+
+#define MAX_VELOCITY_WINDOW 8  // Maximum number of samples in the window
+
+/**
+ * @class VelocityEstimator
+ * @brief Estimates the speed of each wheel from timestamped encoder samples.
+ *
+ * Every sample is stamped with micros() so the estimate does not depend on
+ * the caller reading the encoders at an exact period. The speed is computed
+ * over a sliding window of samples, either from the first and last samples
+ * or from the least squares slope of all of them, and can be smoothed by a
+ * first order low-pass filter.
+ */
+class VelocityEstimator {
+ public:
+  /**
+   * @brief Method used to compute the speed over the window.
+   */
+  enum class Method {
+    FINITE_DIFFERENCE,  ///< Newest minus oldest sample over elapsed time.
+    LEAST_SQUARES       ///< Slope of the best fit line through all samples.
+  };
+
+  /**
+   * @brief Constructor for VelocityEstimator.
+   * @param robot_params Robot params.
+   * @param window_size Number of samples in the window [2,
+   * MAX_VELOCITY_WINDOW].
+   * @param method Method used to compute the speed over the window.
+   * @param filter_alpha Low-pass filter coefficient in ]0, 1]. 1 disables the
+   * filter, lower values smooth more.
+   */
+  VelocityEstimator(const RobotParams& robot_params = RobotParams(),
+                    const byte window_size = 4,
+                    const Method method = Method::FINITE_DIFFERENCE,
+                    const float filter_alpha = 1.0);
+
+  /**
+   * @brief Clears the window and the filtered speeds.
+   */
+  void reset();
+
+  /**
+   * @brief Reads and resets both encoders in a single SPI request and adds
+   * the readings stamped with the middle of the request.
+   * @param one Reference to BnrOneAPlus object.
+   */
+  void readAndUpdate(const BnrOneAPlus& one);
+
+  /**
+   * @brief Adds the pulses counted since the previous sample, stamped with
+   * the current micros().
+   * @param left_pulses Left encoder pulses since the previous sample.
+   * @param right_pulses Right encoder pulses since the previous sample.
+   */
+  void addSample(const int left_pulses, const int right_pulses);
+
+  /**
+   * @brief Adds the pulses counted since the previous sample.
+   * @param left_pulses Left encoder pulses since the previous sample.
+   * @param right_pulses Right encoder pulses since the previous sample.
+   * @param timestamp_us Time at which the encoders were read (micros()).
+   */
+  void addSample(const int left_pulses,
+                 const int right_pulses,
+                 const unsigned long timestamp_us);
+
+  /**
+   * @brief Checks if there are enough samples to estimate the speed.
+   * @return true if at least two samples were added since the last reset.
+   */
+  bool isValid() const;
+
+  /**
+   * @brief Gets the speed of the left wheel in pulses per second.
+   */
+  float getLeftPulsesPerSec() const;
+
+  /**
+   * @brief Gets the speed of the right wheel in pulses per second.
+   */
+  float getRightPulsesPerSec() const;
+
+  /**
+   * @brief Gets the speed of the left wheel in millimeters per second.
+   */
+  float getLeftMmps() const;
+
+  /**
+   * @brief Gets the speed of the right wheel in millimeters per second.
+   */
+  float getRightMmps() const;
+
+  /**
+   * @brief Gets the speed of the left wheel in RPM.
+   */
+  float getLeftRpm() const;
+
+  /**
+   * @brief Gets the speed of the right wheel in RPM.
+   */
+  float getRightRpm() const;
+
+  /**
+   * @brief Gets the speeds of both wheels in millimeters per second.
+   */
+  WheelSpeeds getSpeedsMmps() const;
+
+  /**
+   * @brief Gets the speeds of both wheels in RPM.
+   */
+  WheelSpeeds getSpeedsRpm() const;
+
+ private:
+  /**
+   * @brief Computes the speeds over the window using the first and last
+   * samples.
+   */
+  void computeFiniteDifference(float& left_pps, float& right_pps) const;
+
+  /**
+   * @brief Computes the speeds over the window as the least squares slope of
+   * position over time.
+   */
+  void computeLeastSquares(float& left_pps, float& right_pps) const;
+
+  /**
+   * @brief Gets the buffer index of the i-th sample, 0 being the oldest.
+   */
+  byte indexOf(const byte i) const;
+
+  ControlUtils cut_;      ///< Control utils object
+  float pulses_per_rev_;  ///< Number of pulses per revolution.
+  byte window_size_;      ///< Number of samples in the window.
+  Method method_;         ///< Method used to compute the speed.
+  float filter_alpha_;    ///< Low-pass filter coefficient.
+  long left_position_[MAX_VELOCITY_WINDOW];   ///< Accumulated left pulses.
+  long right_position_[MAX_VELOCITY_WINDOW];  ///< Accumulated right pulses.
+  unsigned long timestamp_us_[MAX_VELOCITY_WINDOW];  ///< Sample timestamps.
+  byte newest_;       ///< Buffer index of the newest sample.
+  byte num_samples_;  ///< Number of samples in the window.
+  float left_pps_;    ///< Filtered left speed in pulses per second.
+  float right_pps_;   ///< Filtered right speed in pulses per second.
+};
@@ -0,0 +1,127 @@
+#include "VelocityProfile.h"
+
+VelocityProfile::VelocityProfile(const Type type,
+                                 const float distance_mm,
+                                 const float cruise_speed_mmps,
+                                 const float max_accel_mmps2,
+                                 const float max_jerk_mmps3,
+                                 const float min_speed_mmps,
+                                 const float entry_speed_mmps,
+                                 const float exit_speed_mmps)
+    : type_(type),
+      distance_mm_(abs(distance_mm)),
+      cruise_speed_mmps_(abs(cruise_speed_mmps)),
+      max_accel_mmps2_(max_accel_mmps2),
+      max_jerk_mmps3_(max_jerk_mmps3),
+      min_speed_mmps_(min(min_speed_mmps, abs(cruise_speed_mmps))),
+      accel_offset_mm_(0),
+      decel_offset_mm_(0),
+      ramp_length_mm_(0) {
+  if (type_ == Type::S_CURVE && cruise_speed_mmps_ > 0 &&
+      max_accel_mmps2_ > 0 && max_jerk_mmps3_ > 0) {
+    const float cruise = cruise_speed_mmps_;
+    const float jerk = max_jerk_mmps3_;
+    // The acceleration limit is not reached if the cruise speed is low
+    max_accel_mmps2_ = min(max_accel_mmps2_, (float)sqrt(cruise * jerk));
+    // Increasing, constant and decreasing acceleration phases, the last one
+    // being the mirror image of the first
+    const float jerk_time_s = max_accel_mmps2_ / jerk;
+    const float speed_1 = computeJerkPhaseSpeed();
+    const float speed_2 = cruise - speed_1;
+    ramp_length_mm_ = computeJerkPhaseDistance() +
+                      (speed_2 * speed_2 - speed_1 * speed_1) /
+                          (2.0 * max_accel_mmps2_) +
+                      (cruise - speed_1 / 3.0) * jerk_time_s;
+  }
+  // The ramps start from the point where they reach the entry and exit
+  // speeds
+  accel_offset_mm_ =
+      computeRampDistance(max(min_speed_mmps_, abs(entry_speed_mmps)));
+  decel_offset_mm_ =
+      computeRampDistance(max(min_speed_mmps_, abs(exit_speed_mmps)));
+}
+
+VelocityProfile::Type VelocityProfile::getType() const { return type_; }
+
+float VelocityProfile::getSpeedAtDistance(const float travelled_mm) const {
+  if (type_ == Type::NONE) return cruise_speed_mmps_;
+
+  const float accel_speed = computeRampSpeed(travelled_mm + accel_offset_mm_);
+  const float decel_speed =
+      computeRampSpeed(distance_mm_ - travelled_mm + decel_offset_mm_);
+  return max(min_speed_mmps_, min(accel_speed, decel_speed));
+}
+
+float VelocityProfile::computeRampSpeed(const float ramp_distance_mm) const {
+  if (ramp_distance_mm <= 0) return 0;
+
+  if (type_ == Type::TRAPEZOIDAL) {
+    return min(cruise_speed_mmps_,
+               (float)sqrt(2.0 * max_accel_mmps2_ * ramp_distance_mm));
+  }
+
+  if (ramp_distance_mm >= ramp_length_mm_) return cruise_speed_mmps_;
+  const float cruise = cruise_speed_mmps_;
+  const float accel = max_accel_mmps2_;
+  const float jerk = max_jerk_mmps3_;
+  const float speed_1 = computeJerkPhaseSpeed();
+  const float distance_1 = computeJerkPhaseDistance();
+  if (ramp_distance_mm <= distance_1) {
+    // distance = jerk * t^3 / 6
+    const float t = cbrt(6.0 * ramp_distance_mm / jerk);
+    return jerk * t * t / 2.0;
+  }
+  const float jerk_time_s = accel / jerk;
+  const float to_cruise_mm = ramp_length_mm_ - ramp_distance_mm;
+  if (to_cruise_mm >= (cruise - speed_1 / 3.0) * jerk_time_s) {
+    return sqrt(speed_1 * speed_1 + 2.0 * accel * (ramp_distance_mm -
+                                                   distance_1));
+  }
+  // The remaining distance is cruise * tau - jerk * tau^3 / 6, where tau is
+  // the time left to the cruise speed. It is concave in tau, so Newton's
+  // method started below the root converges from below.
+  float tau = to_cruise_mm / cruise;
+  for (byte i = 0; i < 3; ++i) {
+    const float error = cruise * tau - jerk * tau * tau * tau / 6.0 -
+                        to_cruise_mm;
+    tau -= error / (cruise - jerk * tau * tau / 2.0);
+  }
+  return cruise - jerk * tau * tau / 2.0;
+}
+
+float VelocityProfile::computeRampDistance(const float speed_mmps) const {
+  if (speed_mmps <= 0) return 0;
+
+  if (type_ == Type::TRAPEZOIDAL) {
+    if (max_accel_mmps2_ <= 0) return 0;
+    return speed_mmps * speed_mmps / (2.0 * max_accel_mmps2_);
+  }
+
+  if (ramp_length_mm_ <= 0) return 0;
+  const float cruise = cruise_speed_mmps_;
+  if (speed_mmps >= cruise) return ramp_length_mm_;
+  const float accel = max_accel_mmps2_;
+  const float jerk = max_jerk_mmps3_;
+  const float speed_1 = computeJerkPhaseSpeed();
+  if (speed_mmps <= speed_1) {
+    // speed = jerk * t^2 / 2
+    const float t = sqrt(2.0 * speed_mmps / jerk);
+    return jerk * t * t * t / 6.0;
+  }
+  if (speed_mmps <= cruise - speed_1) {
+    return computeJerkPhaseDistance() +
+           (speed_mmps * speed_mmps - speed_1 * speed_1) / (2.0 * accel);
+  }
+  const float tau = sqrt(2.0 * (cruise - speed_mmps) / jerk);
+  return ramp_length_mm_ - (cruise * tau - jerk * tau * tau * tau / 6.0);
+}
+
+float VelocityProfile::computeJerkPhaseSpeed() const {
+  return max_accel_mmps2_ * max_accel_mmps2_ / (2.0 * max_jerk_mmps3_);
+}
+
+float VelocityProfile::computeJerkPhaseDistance() const {
+  // The speed grows with the square of the time, so the mean speed is a
+  // third of the final one
+  return computeJerkPhaseSpeed() * (max_accel_mmps2_ / max_jerk_mmps3_) / 3.0;
+}
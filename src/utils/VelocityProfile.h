@@ -0,0 +1,101 @@
+#pragma once
+
+#include <Arduino.h>
+
+/**
+ * @class VelocityProfile
+ * @brief Speed profile of a motion as a function of the travelled distance.
+ *
+ * The speed ramps up from the entry speed, cruises and ramps down to the exit
+ * speed, never going below a low minimum speed. Trapezoidal profiles limit the
+ * acceleration, S-curve profiles also limit the jerk so the acceleration
+ * builds up gradually. The ramps are evaluated in closed form from the
+ * travelled distance and the deceleration ramp is the mirror image of the
+ * acceleration ramp, so a profile only keeps a few parameters. Short motions
+ * that cannot reach the cruise speed peak before it.
+ */
+class VelocityProfile {
+ public:
+  /**
+   * @brief Shape of the profile.
+   */
+  enum class Type {
+    NONE,         ///< Cruise speed along the whole motion.
+    TRAPEZOIDAL,  ///< Acceleration limited ramps.
+    S_CURVE       ///< Acceleration and jerk limited ramps.
+  };
+
+  /**
+   * @brief Constructor for VelocityProfile.
+   * @param type Shape of the profile.
+   * @param distance_mm Total distance of the motion in millimeters.
+   * @param cruise_speed_mmps Maximum speed in millimeters per second.
+   * @param max_accel_mmps2 Maximum acceleration in millimeters per second
+   * squared.
+   * @param max_jerk_mmps3 Maximum jerk in millimeters per second cubed (only
+   * used by S-curve profiles).
+   * @param min_speed_mmps Lowest speed, used at the start and at the end of
+   * the motion unless the entry or exit speeds are higher.
+   * @param entry_speed_mmps Speed at the start of the motion.
+   * @param exit_speed_mmps Speed at the end of the motion.
+   */
+  VelocityProfile(const Type type = Type::NONE,
+                  const float distance_mm = 0,
+                  const float cruise_speed_mmps = 0,
+                  const float max_accel_mmps2 = 800,
+                  const float max_jerk_mmps3 = 8000,
+                  const float min_speed_mmps = 30,
+                  const float entry_speed_mmps = 0,
+                  const float exit_speed_mmps = 0);
+
+  /**
+   * @brief Gets the shape of the profile.
+   */
+  Type getType() const;
+
+  /**
+   * @brief Gets the speed at a given point of the motion.
+   * @param travelled_mm Distance travelled since the start of the motion.
+   * @return Speed in millimeters per second.
+   */
+  float getSpeedAtDistance(const float travelled_mm) const;
+
+ private:
+  /**
+   * @brief Computes the speed reached after accelerating from rest over the
+   * given distance, capped at the cruise speed.
+   * @param ramp_distance_mm Distance of the ramp in millimeters.
+   * @return Speed in millimeters per second.
+   */
+  float computeRampSpeed(const float ramp_distance_mm) const;
+
+  /**
+   * @brief Computes the distance needed to reach a speed when accelerating
+   * from rest.
+   * @param speed_mmps Speed in millimeters per second.
+   * @return Distance of the ramp in millimeters.
+   */
+  float computeRampDistance(const float speed_mmps) const;
+
+  /**
+   * @brief Computes the speed at the end of the increasing acceleration
+   * phase of the S-curve ramp.
+   */
+  float computeJerkPhaseSpeed() const;
+
+  /**
+   * @brief Computes the distance of the increasing acceleration phase of the
+   * S-curve ramp.
+   */
+  float computeJerkPhaseDistance() const;
+
+  Type type_;                ///< Shape of the profile.
+  float distance_mm_;        ///< Total distance of the motion.
+  float cruise_speed_mmps_;  ///< Maximum speed.
+  float max_accel_mmps2_;    ///< Maximum acceleration reached.
+  float max_jerk_mmps3_;     ///< Maximum jerk.
+  float min_speed_mmps_;     ///< Lowest speed.
+  float accel_offset_mm_;    ///< Ramp distance to reach the entry speed.
+  float decel_offset_mm_;    ///< Ramp distance to reach the exit speed.
+  float ramp_length_mm_;     ///< S-curve distance to reach the cruise speed.
+};
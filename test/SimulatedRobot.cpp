@@ -0,0 +1,181 @@
+#include "SimulatedRobot.h"
+
+#include <SPI.h>
+
+#include "SpiCommands.h"
+
+#define PULSES_PER_REV 2251
+#define WHEEL_DIAMETER_MM 63
+#define AXIS_LENGTH_MM 165
+#define SIM_STEP_US 1000
+#define CONTROL_PERIOD_US 25000  // Control period of the co-processor
+
+namespace {
+SimulatedWheel createWheel() {
+  SimulatedWheel wheel;
+  wheel.dead_band = 20;
+  wheel.gain_pps = 130;
+  wheel.saturation = 0.003;
+  wheel.time_constant_ms = 60;
+  wheel.speed_scale = 1;
+  wheel.blocked = false;
+  wheel.command_pps = 0;
+  wheel.target_pps = 0;
+  wheel.speed_pps = 0;
+  wheel.position = 0;
+  wheel.read_position = 0;
+  return wheel;
+}
+
+float advanceWheel(SimulatedWheel& wheel, const float period_s) {
+  const float target_pps = wheel.blocked ? 0 : wheel.target_pps;
+  wheel.speed_pps += (target_pps - wheel.speed_pps) *
+                     (1 - exp(-period_s * 1000 / wheel.time_constant_ms));
+  if (wheel.blocked) wheel.speed_pps = 0;
+  const float pulses = wheel.speed_pps * period_s;
+  wheel.position += pulses;
+  return pulses;
+}
+
+int takePulses(SimulatedWheel& wheel) {
+  const int pulses = (int)(wheel.position - wheel.read_position);
+  wheel.read_position += pulses;
+  return pulses;
+}
+
+float computeRawSpeed(const SimulatedWheel& wheel, const int duty_cycle) {
+  const float above_band = abs(duty_cycle) - wheel.dead_band;
+  if (above_band <= 0) return 0;
+  return wheel.gain_pps * above_band * (1 - wheel.saturation * above_band);
+}
+}  // namespace
+
+SimulatedRobot* SimulatedRobot::active_ = nullptr;
+
+SimulatedRobot::SimulatedRobot()
+    : left(createWheel()),
+      right(createWheel()),
+      control_period_us(CONTROL_PERIOD_US),
+      heading_rad_(0),
+      distance_mm_(0),
+      last_update_us_(stub_micros),
+      last_tick_us_(stub_micros),
+      frame_size_(0),
+      response_size_(0),
+      response_index_(0) {
+  active_ = this;
+  stub_digital_write = onDigitalWrite;
+  stub_spi_transfer = onSpiTransfer;
+}
+
+SimulatedRobot::~SimulatedRobot() {
+  active_ = nullptr;
+  stub_digital_write = nullptr;
+  stub_spi_transfer = nullptr;
+}
+
+void SimulatedRobot::update() {
+  const float mm_per_pulse = PI * WHEEL_DIAMETER_MM / PULSES_PER_REV;
+  while (stub_micros - last_update_us_ >= SIM_STEP_US) {
+    last_update_us_ += SIM_STEP_US;
+    if (last_update_us_ - last_tick_us_ >= control_period_us) {
+      last_tick_us_ = last_update_us_;
+      left.target_pps = left.command_pps;
+      right.target_pps = right.command_pps;
+    }
+    const float left_mm = advanceWheel(left, SIM_STEP_US / 1e6) * mm_per_pulse;
+    const float right_mm =
+        advanceWheel(right, SIM_STEP_US / 1e6) * mm_per_pulse;
+    heading_rad_ += (right_mm - left_mm) / AXIS_LENGTH_MM;
+    distance_mm_ += (left_mm + right_mm) / 2;
+  }
+}
+
+float SimulatedRobot::getHeadingRad() const { return heading_rad_; }
+
+float SimulatedRobot::getDistanceMm() const { return distance_mm_; }
+
+void SimulatedRobot::onDigitalWrite(uint8_t pin, uint8_t value) {
+  (void)pin;
+  if (active_ == nullptr) return;
+  active_->update();
+  if (value == HIGH) active_->onFrameEnd();
+  active_->frame_size_ = 0;
+  active_->response_size_ = 0;
+  active_->response_index_ = 0;
+}
+
+uint8_t SimulatedRobot::onSpiTransfer(uint8_t data) {
+  if (active_ == nullptr) return 0;
+  SimulatedRobot& robot = *active_;
+  if (robot.response_index_ < robot.response_size_) {
+    return robot.response_[robot.response_index_++];
+  }
+  if (robot.frame_size_ < SIM_MAX_FRAME_SIZE) {
+    robot.frame_[robot.frame_size_++] = data;
+  }
+  robot.update();
+  robot.onRequest();
+  return 0;
+}
+
+void SimulatedRobot::onRequest() {
+  switch (frame_[0]) {
+    case COMMAND_MOVE_RPM_R_ENC:
+      if (frame_size_ == 7) {
+        setRpm(readWord(3), readWord(5));
+        respondEncoders();
+      }
+      break;
+    case COMMAND_ENCODERS_READ:
+      if (frame_size_ == 3) respondEncoders();
+      break;
+  }
+}
+
+void SimulatedRobot::onFrameEnd() {
+  if (frame_size_ == 0) return;
+  switch (frame_[0]) {
+    case COMMAND_MOVE_RPM:
+      if (frame_size_ >= 7) setRpm(readWord(3), readWord(5));
+      break;
+    case COMMAND_MOVE_RAW:
+      if (frame_size_ >= 7) setDutyCycles(readWord(3), readWord(5));
+      break;
+    case COMMAND_STOP:
+    case COMMAND_BRAKE_SET_T:
+    case COMMAND_BRAKE_MAX_T:
+      left.command_pps = 0;
+      right.command_pps = 0;
+      break;
+  }
+}
+
+void SimulatedRobot::respondEncoders() {
+  const int left_pulses = takePulses(left);
+  const int right_pulses = takePulses(right);
+  response_[0] = highByte(left_pulses);
+  response_[1] = lowByte(left_pulses);
+  response_[2] = highByte(right_pulses);
+  response_[3] = lowByte(right_pulses);
+  response_size_ = 4;
+  response_index_ = 0;
+}
+
+int SimulatedRobot::readWord(const int index) const {
+  return (int16_t)word(frame_[index], frame_[index + 1]);
+}
+
+void SimulatedRobot::setRpm(const int left_rpm, const int right_rpm) {
+  left.command_pps = left_rpm * left.speed_scale * PULSES_PER_REV / 60.0;
+  right.command_pps = right_rpm * right.speed_scale * PULSES_PER_REV / 60.0;
+}
+
+void SimulatedRobot::setDutyCycles(const int left_duty_cycle,
+                                   const int right_duty_cycle) {
+  // The duty cycles are applied at once, without the speed controller
+  left.command_pps = computeRawSpeed(left, left_duty_cycle);
+  right.command_pps = computeRawSpeed(right, right_duty_cycle);
+  left.target_pps = left.command_pps;
+  right.target_pps = right.command_pps;
+}
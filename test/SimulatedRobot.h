@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define SIM_MAX_FRAME_SIZE 24  // Longest SPI frame decoded
+
+/**
+ * @brief Model of a wheel and its motor.
+ */
+struct SimulatedWheel {
+  float dead_band;         ///< moveRAW duty cycle at which the wheel starts.
+  float gain_pps;          ///< Speed per duty cycle above the dead band.
+  float saturation;        ///< Loss of gain per duty cycle above the band.
+  float time_constant_ms;  ///< Time to reach 63 % of a speed step.
+  float speed_scale;       ///< Speed reached with moveRpm, per commanded.
+  bool blocked;            ///< Whether the wheel is held still.
+  float command_pps;       ///< Speed commanded for the next tick.
+  float target_pps;        ///< Speed the wheel tends to.
+  float speed_pps;         ///< Current speed.
+  double position;         ///< Pulses since the start of the simulation.
+  double read_position;    ///< Pulses already sent to the library.
+};
+
+/**
+ * @class SimulatedRobot
+ * @brief Simulated co-processor answering the SPI commands of BnrOneAPlus,
+ * with two wheels that follow the commanded speeds or duty cycles.
+ *
+ * Speed commands are applied on the next tick of the speed controller of the
+ * co-processor, and duty cycles at once.
+ * Only one robot can be simulated at a time. Encoder counts are sent as 16
+ * bit words, which the host reads as unsigned, so only forward motion is
+ * simulated.
+ */
+class SimulatedRobot {
+ public:
+  /**
+   * @brief Constructor for SimulatedRobot. Attaches to the SPI and digital
+   * write hooks of the stub.
+   */
+  SimulatedRobot();
+
+  /**
+   * @brief Destructor for SimulatedRobot. Detaches from the hooks.
+   */
+  ~SimulatedRobot();
+
+  /**
+   * @brief Advances the wheels to the current simulated time.
+   */
+  void update();
+
+  /**
+   * @brief Gets the heading change since the start.
+   * @return Heading in radians, positive counterclockwise.
+   */
+  float getHeadingRad() const;
+
+  /**
+   * @brief Gets the distance travelled by the centre of the robot.
+   * @return Distance in millimeters.
+   */
+  float getDistanceMm() const;
+
+  SimulatedWheel left;             ///< Left wheel.
+  SimulatedWheel right;            ///< Right wheel.
+  unsigned long control_period_us;  ///< Co-processor control period.
+
+ private:
+  static void onDigitalWrite(uint8_t pin, uint8_t value);
+  static uint8_t onSpiTransfer(uint8_t data);
+
+  /**
+   * @brief Runs the command of a frame once its request bytes are received.
+   */
+  void onRequest();
+
+  /**
+   * @brief Runs the command of a frame that needs no response.
+   */
+  void onFrameEnd();
+
+  /**
+   * @brief Queues the pulses counted since the last reading as response.
+   */
+  void respondEncoders();
+
+  /**
+   * @brief Gets a 16 bit word of the frame, most significant byte first.
+   */
+  int readWord(const int index) const;
+
+  void setRpm(const int left_rpm, const int right_rpm);
+  void setDutyCycles(const int left_duty_cycle, const int right_duty_cycle);
+
+  static SimulatedRobot* active_;
+
+  float heading_rad_;
+  float distance_mm_;
+  unsigned long last_update_us_;
+  unsigned long last_tick_us_;
+  uint8_t frame_[SIM_MAX_FRAME_SIZE];
+  int frame_size_;
+  uint8_t response_[4];
+  int response_size_;
+  int response_index_;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdio.h>
+
+// Minimal checks for the host tests. Failures are printed and counted, and
+// each test program returns the number of failures.
+
+static int test_failures = 0;
+
+#define CHECK(condition)                                              \
+  do {                                                                \
+    if (!(condition)) {                                               \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,         \
+             #condition);                                             \
+      ++test_failures;                                                \
+    }                                                                 \
+  } while (0)
+
+#define CHECK_NEAR(value, expected, tolerance)                        \
+  do {                                                                \
+    const double check_value = (value);                               \
+    const double check_expected = (expected);                         \
+    if (fabs(check_value - check_expected) > (tolerance)) {           \
+      printf("%s:%d: %s = %g, expected %g +- %g\n", __FILE__,         \
+             __LINE__, #value, check_value, check_expected,           \
+             (double)(tolerance));                                    \
+      ++test_failures;                                                \
+    }                                                                 \
+  } while (0)
+
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
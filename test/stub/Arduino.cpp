@@ -0,0 +1,53 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SPI.h>
+#include <Wire.h>
+
+HardwareSerial Serial;
+SPIClass SPI;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+unsigned long stub_micros = 0;
+void (*stub_digital_write)(uint8_t pin, uint8_t value) = nullptr;
+uint8_t (*stub_spi_transfer)(uint8_t data) = nullptr;
+
+long map(long value, long in_min, long in_max, long out_min, long out_max) {
+  return (value - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+// Every reading takes some time, so that busy waits end
+unsigned long micros() { return stub_micros += 4; }
+
+unsigned long millis() { return micros() / 1000; }
+
+void delay(unsigned long ms) { stub_micros += ms * 1000; }
+
+void delayMicroseconds(unsigned int us) { stub_micros += us; }
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  (void)pin;
+  (void)mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (stub_digital_write != nullptr) stub_digital_write(pin, value);
+}
+
+void noInterrupts() {}
+
+void interrupts() {}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length) {
+    const int data = read();
+    if (data < 0) break;
+    buffer[count++] = (uint8_t)data;
+  }
+  return count;
+}
+
+uint8_t SPIClass::transfer(uint8_t data) {
+  return (stub_spi_transfer != nullptr) ? stub_spi_transfer(data) : 0;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+// Minimal Arduino core for building the library on the host. Time is
+// simulated: every call to micros(), millis() or delay() advances the clock.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+#define DEG_TO_RAD 0.017453292519943295769236907684886
+#define RAD_TO_DEG 57.295779513082320876798154814105
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define abs(x) ((x) > 0 ? (x) : -(x))
+#define constrain(amt, low, high) \
+  ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define round(x) ((x) >= 0 ? (long)((x) + 0.5) : (long)((x)-0.5))
+#define radians(deg) ((deg)*DEG_TO_RAD)
+#define degrees(rad) ((rad)*RAD_TO_DEG)
+#define sq(x) ((x) * (x))
+#define lowByte(w) ((uint8_t)((w)&0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+
+inline unsigned int word(const uint8_t high, const uint8_t low) {
+  return (high << 8) | low;
+}
+
+long map(long value, long in_min, long in_max, long out_min, long out_max);
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+void noInterrupts();
+void interrupts();
+
+class String {
+ public:
+  String(const char* text = "") : text_(text) {}
+  String(const int value) : text_(std::to_string(value)) {}
+  const char* c_str() const { return text_.c_str(); }
+  unsigned int length() const { return text_.size(); }
+  char operator[](const unsigned int index) const { return text_[index]; }
+  void toCharArray(char* buffer, const unsigned int size) const {
+    strncpy(buffer, text_.c_str(), size);
+  }
+
+ private:
+  std::string text_;
+};
+
+class Stream {
+ public:
+  virtual ~Stream() {}
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+  void setTimeout(unsigned long timeout_ms) { (void)timeout_ms; }
+  size_t readBytes(uint8_t* buffer, size_t length);
+  size_t readBytes(char* buffer, size_t length) {
+    return readBytes((uint8_t*)buffer, length);
+  }
+  template <class T>
+  size_t print(const T&) { return 0; }
+  template <class T>
+  size_t print(const T&, int) { return 0; }
+  template <class T>
+  size_t println(const T&) { return 0; }
+  template <class T>
+  size_t println(const T&, int) { return 0; }
+  size_t println() { return 0; }
+};
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end() {}
+};
+
+extern HardwareSerial Serial;
+
+// Hooks of the simulation: the simulated clock, and the pins written, e.g.
+// the SPI slave select of the co-processor
+extern unsigned long stub_micros;
+extern void (*stub_digital_write)(uint8_t pin, uint8_t value);
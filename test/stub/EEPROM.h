@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define STUB_EEPROM_SIZE 1024
+
+class EEPROMClass {
+ public:
+  uint8_t read(int address) const { return data_[address]; }
+  void write(int address, uint8_t value) { data_[address] = value; }
+  void update(int address, uint8_t value) { data_[address] = value; }
+  uint16_t length() const { return STUB_EEPROM_SIZE; }
+  template <class T>
+  T& get(int address, T& value) const {
+    memcpy(&value, &data_[address], sizeof(value));
+    return value;
+  }
+  template <class T>
+  const T& put(int address, const T& value) {
+    memcpy(&data_[address], &value, sizeof(value));
+    return value;
+  }
+
+ private:
+  uint8_t data_[STUB_EEPROM_SIZE] = {};
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <Arduino.h>
+
+#define MSBFIRST 1
+#define SPI_MODE1 1
+#define SPI_CLOCK_DIV2 2
+
+class SPIClass {
+ public:
+  void begin() {}
+  void setBitOrder(uint8_t order) { (void)order; }
+  void setDataMode(uint8_t mode) { (void)mode; }
+  void setClockDivider(uint8_t divider) { (void)divider; }
+  uint8_t transfer(uint8_t data);
+};
+
+extern SPIClass SPI;
+
+// Hook of the simulation: answers every byte sent, 0 if not set
+extern uint8_t (*stub_spi_transfer)(uint8_t data);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+
+class TwoWire {
+ public:
+  void begin() {}
+  void beginTransmission(uint8_t address) { (void)address; }
+  uint8_t endTransmission() { return 0; }
+  uint8_t requestFrom(uint8_t address, uint8_t quantity) {
+    (void)address;
+    (void)quantity;
+    return 0;
+  }
+  int available() { return 0; }
+  int read() { return 0; }
+  size_t write(uint8_t data) {
+    (void)data;
+    return 1;
+  }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,94 @@
+// The table based trigonometry must stay within the error bounds documented
+// in FastTrig.h when compared with libm over the full range of angles and
+// vector directions, including angles beyond one turn.
+
+#include <math.h>
+
+#include "TestUtils.h"
+#include "utils/FastTrig.h"
+
+#define NUM_ANGLES 100000
+#define MAX_ANGLE_RAD (4 * M_PI)  // Angles span two turns each way
+#define NUM_DIRECTIONS 100000
+
+void testQ15() {
+  int max_sin_error = 0;
+  int max_cos_error = 0;
+  for (long brad = 0; brad < BRADS_PER_TURN; ++brad) {
+    const double angle_rad = 2 * M_PI * brad / BRADS_PER_TURN;
+    const int sin_error =
+        abs(sinQ15(brad) - (int)lround(Q15_ONE * sin(angle_rad)));
+    const int cos_error =
+        abs(cosQ15(brad) - (int)lround(Q15_ONE * cos(angle_rad)));
+    max_sin_error = max(max_sin_error, sin_error);
+    max_cos_error = max(max_cos_error, cos_error);
+  }
+  printf("  sinQ15 %d LSB, cosQ15 %d LSB\n", max_sin_error, max_cos_error);
+  CHECK(max_sin_error <= 4);
+  CHECK(max_cos_error <= 4);
+}
+
+void testFastSinCos() {
+  double max_sin_error = 0;
+  double max_cos_error = 0;
+  for (long i = 0; i <= NUM_ANGLES; ++i) {
+    const float angle_rad =
+        -MAX_ANGLE_RAD + 2 * MAX_ANGLE_RAD * i / NUM_ANGLES;
+    max_sin_error = fmax(max_sin_error, fabs(fastSin(angle_rad) -
+                                             sin((double)angle_rad)));
+    max_cos_error = fmax(max_cos_error, fabs(fastCos(angle_rad) -
+                                             cos((double)angle_rad)));
+  }
+  printf("  fastSin %.2g, fastCos %.2g\n", max_sin_error, max_cos_error);
+  CHECK(max_sin_error <= 1.2e-4);
+  CHECK(max_cos_error <= 1.2e-4);
+}
+
+// Angle error wrapped to [-pi, pi], since -pi and pi are the same direction
+double angleError(const double angle_rad, const double expected_rad) {
+  return fabs(remainder(angle_rad - expected_rad, 2 * M_PI));
+}
+
+void testAtan2() {
+  const float magnitudes[] = {0.001, 1, 250, 30000};
+  double max_rad_error = 0;
+  long max_brad_error = 0;
+  for (const float magnitude : magnitudes) {
+    for (long i = 0; i < NUM_DIRECTIONS; ++i) {
+      const double direction_rad = 2 * M_PI * i / NUM_DIRECTIONS - M_PI;
+      const float y = magnitude * sin(direction_rad);
+      const float x = magnitude * cos(direction_rad);
+      const double expected_rad = atan2((double)y, (double)x);
+      max_rad_error =
+          fmax(max_rad_error, angleError(fastAtan2(y, x), expected_rad));
+
+      const long y_int = lround(y);
+      const long x_int = lround(x);
+      if (y_int == 0 && x_int == 0) continue;
+      const double brad_error_rad =
+          angleError(bradToRad(atan2Brad(y_int, x_int)),
+                     atan2((double)y_int, (double)x_int));
+      max_brad_error = max(
+          max_brad_error,
+          lround(brad_error_rad * BRADS_PER_TURN / (2 * M_PI)));
+    }
+  }
+  printf("  fastAtan2 %.2g rad, atan2Brad %ld brads\n", max_rad_error,
+         max_brad_error);
+  CHECK(max_rad_error <= 1.3e-4);
+  CHECK(max_brad_error <= 2);
+
+  // Directions along the axes and the origin
+  CHECK_NEAR(fastAtan2(0, 1), 0, 1.3e-4);
+  CHECK_NEAR(fastAtan2(1, 0), M_PI / 2, 1.3e-4);
+  CHECK_NEAR(fastAtan2(-1, 0), -M_PI / 2, 1.3e-4);
+  CHECK_NEAR(fabs(fastAtan2(0, -1)), M_PI, 1.3e-4);
+  CHECK_NEAR(fastAtan2(0, 0), 0, 1.3e-4);
+}
+
+int main() {
+  testQ15();
+  testFastSinCos();
+  testAtan2();
+  return TEST_RESULT();
+}
@@ -0,0 +1,31 @@
+// A straight 1 m motion at 400 mm/s with the right wheel 5 % slower than
+// commanded drifts off its heading, unless the heading is held.
+
+#include "SimulatedRobot.h"
+#include "TestUtils.h"
+#include "utils/MotionGenerator.h"
+
+#define SSPIN 2
+
+float runStraightMotion(const float heading_gain) {
+  SimulatedRobot robot;
+  robot.right.speed_scale = 0.95;
+  BnrOneAPlus one;
+  one.spiConnect(SSPIN);
+  MotionGenerator mg(one);
+  mg.setHeadingHold(heading_gain);
+  mg.moveStraightAtSpeed(1000, 400);
+  CHECK_NEAR(robot.getDistanceMm(), 1000, 30);
+  return degrees(robot.getHeadingRad());
+}
+
+int main() {
+  const float heading_without_hold_deg = runStraightMotion(0);
+  const float heading_with_hold_deg = runStraightMotion(4);
+  printf("  heading change without hold %.1f deg, with hold %.1f deg\n",
+         heading_without_hold_deg,
+         heading_with_hold_deg);
+  CHECK(abs(heading_without_hold_deg) > 10);
+  CHECK(abs(heading_with_hold_deg) < 1);
+  return TEST_RESULT();
+}
@@ -0,0 +1,76 @@
+// MotorIdentification must recover the dead band and time constant of two
+// different simulated motors, and its table must linearise their speeds. A
+// PWM table and a command shaper left on the robot must not distort the
+// identification signals.
+
+#include "SimulatedRobot.h"
+#include "TestUtils.h"
+#include "utils/CommandShaper.h"
+#include "utils/MotorIdentification.h"
+
+#define SSPIN 2
+
+void setMotor(SimulatedWheel& wheel,
+              const float dead_band,
+              const float gain_pps,
+              const float time_constant_ms) {
+  wheel.dead_band = dead_band;
+  wheel.gain_pps = gain_pps;
+  wheel.time_constant_ms = time_constant_ms;
+}
+
+// Speed of a motor at the duty cycle of the table for a speed percentage
+float computeSpeed(const SimulatedWheel& wheel, const int duty_cycle) {
+  const float above_band = duty_cycle - wheel.dead_band;
+  if (above_band <= 0) return 0;
+  return wheel.gain_pps * above_band * (1 - wheel.saturation * above_band);
+}
+
+int main() {
+  SimulatedRobot robot;
+  setMotor(robot.left, 22, 130, 60);
+  setMotor(robot.right, 27, 120, 80);
+  BnrOneAPlus one;
+  one.spiConnect(SSPIN);
+  PwmTable full_power_table;
+  for (byte i = 0; i < PWM_TABLE_SIZE; ++i) {
+    full_power_table.setEntry(i, 100, 100);
+  }
+  CommandShaper shaper(50, 500);
+  one.setPwmTable(&full_power_table);
+  one.setCommandShaper(&shaper);
+  MotorIdentification identification(one);
+
+  const unsigned long start_us = stub_micros;
+  CHECK(identification.identify());
+  const float duration_s = (stub_micros - start_us) / 1e6;
+
+  const MotorModel& left = identification.getLeftModel();
+  const MotorModel& right = identification.getRightModel();
+  printf("  %.1f s, dead bands %.1f %.1f, time constants %.0f %.0f ms\n",
+         duration_s,
+         left.dead_band,
+         right.dead_band,
+         left.time_constant_ms,
+         right.time_constant_ms);
+  CHECK(duration_s < 8);
+  CHECK_NEAR(left.dead_band, 22, 0.3);
+  CHECK_NEAR(right.dead_band, 27, 0.3);
+  // The fit assumes a linear motor and point speed samples, which biases it
+  CHECK_NEAR(left.time_constant_ms, 60, 0.15 * 60);
+  CHECK_NEAR(right.time_constant_ms, 80, 0.15 * 80);
+
+  // Both wheels reach the same fraction of the slower top speed
+  const PwmTable& table = identification.getPwmTable();
+  const float top_speed = computeSpeed(robot.right, 100);
+  for (int speed = 10; speed <= 100; speed += 10) {
+    const float expected = top_speed * speed / 100.0;
+    CHECK_NEAR(computeSpeed(robot.left, table.computeLeftDutyCycle(speed)),
+               expected,
+               0.05 * top_speed);
+    CHECK_NEAR(computeSpeed(robot.right, table.computeRightDutyCycle(speed)),
+               expected,
+               0.05 * top_speed);
+  }
+  return TEST_RESULT();
+}
@@ -0,0 +1,92 @@
+// PidController must follow its floating-point reference PidControllerFloat
+// within +-1 for any gains, setpoint weights, derivative filter and output
+// limits, including while the output saturates.
+
+#include "TestUtils.h"
+#include "utils/PidController.h"
+
+#define NUM_GAIN_SETS 200
+#define CYCLES_PER_SET 2000
+#define SETPOINT_PERIOD 300  // Cycles between setpoint changes
+
+// Returns a pseudo-random value in [low, high]
+float randomBetween(const float low, const float high) {
+  return low + (high - low) * (rand() / (float)RAND_MAX);
+}
+
+// Largest difference between the controllers driving a first order plant
+int runGainSet(const int seed) {
+  srand(seed);
+  const float kp = randomBetween(0, 4);
+  const float ki = randomBetween(0, 0.1);
+  const float kd = randomBetween(0, 3);
+  const float proportional_weight = randomBetween(0, 1);
+  const float derivative_weight = randomBetween(0, 1);
+  const float alpha = randomBetween(0.01, 1);
+  // Narrow limits saturate the output often
+  const int output_limit = (seed % 2 == 0) ? 255 : 60;
+
+  PidController pid(kp, ki, kd, -output_limit, output_limit);
+  PidControllerFloat reference(kp, ki, kd, -output_limit, output_limit);
+  pid.setSetpointWeights(proportional_weight, derivative_weight);
+  reference.setSetpointWeights(proportional_weight, derivative_weight);
+  pid.setDerivativeFilter(alpha);
+  reference.setDerivativeFilter(alpha);
+
+  int largest_difference = 0;
+  float plant_output = 0;
+  int setpoint = 0;
+  for (int i = 0; i < CYCLES_PER_SET; ++i) {
+    if (i % SETPOINT_PERIOD == 0) setpoint = rand() % 400 - 200;
+    const int measurement = (int)plant_output;
+    const int output = pid.compute(setpoint, measurement);
+    const float reference_output = reference.compute(setpoint, measurement);
+    const int difference = abs(output - (int)lroundf(reference_output));
+    largest_difference = max(largest_difference, difference);
+    plant_output += 0.05 * (reference_output - 0.5 * plant_output);
+  }
+  return largest_difference;
+}
+
+void testAgreesWithReference() {
+  int largest_difference = 0;
+  for (int seed = 0; seed < NUM_GAIN_SETS; ++seed) {
+    largest_difference = max(largest_difference, runGainSet(seed));
+  }
+  printf("  largest difference to the reference: %d\n", largest_difference);
+  CHECK(largest_difference <= 1);
+}
+
+void testIntegralDoesNotWindUp() {
+  PidController pid(1, 0.1, 0, -100, 100);
+  for (int i = 0; i < 1000; ++i) {
+    pid.compute(1000, 0);
+  }
+  // The integral is limited to the output range, so it cannot keep the
+  // output saturated once the error is gone
+  CHECK(pid.compute(0, 0) <= 100);
+  CHECK(pid.compute(0, 100) < 100);
+}
+
+void testResetIntegralKeepsDerivative() {
+  PidController pid(0, 0.1, 1, -100, 100);
+  PidControllerFloat reference(0, 0.1, 1, -100, 100);
+  for (int i = 0; i < 50; ++i) {
+    pid.compute(0, -20);
+    reference.compute(0, -20);
+  }
+  pid.resetIntegral();
+  reference.resetIntegral();
+  // The measurement steps by 30, so only the derivative and one cycle of
+  // integral remain
+  const int output = pid.compute(0, 10);
+  CHECK_NEAR(output, reference.compute(0, 10), 1);
+  CHECK_NEAR(output, -31, 1);
+}
+
+int main() {
+  testAgreesWithReference();
+  testIntegralDoesNotWindUp();
+  testResetIntegralKeepsDerivative();
+  return TEST_RESULT();
+}
@@ -0,0 +1,97 @@
+// SlipMonitor must not flag normal launches, and must flag a wheel that hits
+// a wall or spins freely within a few control periods.
+
+#include <BnrOneAPlus.h>
+
+#include "SimulatedRobot.h"
+#include "TestUtils.h"
+#include "utils/MotionGenerator.h"
+#include "utils/SlipMonitor.h"
+
+#define SSPIN 2
+#define PERIOD_US 5000
+#define SPEED_RPM 150
+#define RUN_TIME_MS 1500
+
+/**
+ * @brief Launches both wheels and checks them every control period.
+ * @param left_time_constant_ms Time constant of the left wheel.
+ * @param block_at_ms Time at which the left wheel is blocked, -1 for never.
+ * @param state State of the left wheel when first flagged.
+ * @return Time of the first flag in milliseconds, -1 if never flagged.
+ */
+long runLaunch(const float left_time_constant_ms,
+               const long block_at_ms,
+               SlipMonitor::WheelState& state) {
+  SimulatedRobot robot;
+  robot.left.time_constant_ms = left_time_constant_ms;
+  BnrOneAPlus one;
+  one.spiConnect(SSPIN);
+  SlipMonitor monitor;
+  state = SlipMonitor::WheelState::OK;
+
+  unsigned long next_us = micros();
+  for (long time_ms = 0; time_ms < RUN_TIME_MS; time_ms += PERIOD_US / 1000) {
+    while (micros() < next_us) {
+    }
+    next_us += PERIOD_US;
+    robot.left.blocked = block_at_ms >= 0 && time_ms >= block_at_ms;
+    const int rpm = round(SPEED_RPM * monitor.getTractionScale());
+    int left_pulses = 0;
+    int right_pulses = 0;
+    one.moveRpmGetEncoders(rpm, rpm, left_pulses, right_pulses);
+    monitor.update(rpm, rpm, left_pulses, right_pulses, PERIOD_US);
+    if (monitor.isSlipping() || monitor.isBlocked()) {
+      state = monitor.getLeftState();
+      return time_ms;
+    }
+  }
+  return -1;
+}
+
+void testNormalLaunches() {
+  SlipMonitor::WheelState state;
+  CHECK(runLaunch(40, -1, state) < 0);
+  CHECK(runLaunch(60, -1, state) < 0);
+  CHECK(runLaunch(80, -1, state) < 0);
+}
+
+void testWallIsDetected() {
+  SlipMonitor::WheelState state;
+  const long flag_ms = runLaunch(60, 800, state);
+  printf("  wall hit at 800 ms flagged at %ld ms\n", flag_ms);
+  CHECK(flag_ms >= 800 && flag_ms <= 810);
+  // A wheel held still is stalled, i.e. not turning at all
+  CHECK(state == SlipMonitor::WheelState::STALLED);
+}
+
+void testSpinningWheelIsDetected() {
+  SlipMonitor::WheelState state;
+  const long flag_ms = runLaunch(5, -1, state);
+  printf("  spinning wheel flagged at %ld ms\n", flag_ms);
+  CHECK(flag_ms >= 0 && flag_ms <= 50);
+  CHECK(state == SlipMonitor::WheelState::SLIPPING);
+}
+
+void testMotionIsAbortedWhenBlocked() {
+  SimulatedRobot robot;
+  robot.left.blocked = true;
+  BnrOneAPlus one;
+  one.spiConnect(SSPIN);
+  SlipMonitor monitor;
+  MotionGenerator mg(one);
+  mg.setSlipMonitor(&monitor);
+  mg.moveStraightAtSpeed(500, 200);
+  printf("  motion with a blocked wheel aborted after %.0f mm\n",
+         robot.getDistanceMm());
+  CHECK(monitor.isBlocked());
+  CHECK(robot.getDistanceMm() < 50);
+}
+
+int main() {
+  testNormalLaunches();
+  testWallIsDetected();
+  testSpinningWheelIsDetected();
+  testMotionIsAbortedWhenBlocked();
+  return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+// TaskScheduler must hold the period of a short control task while slow
+// tasks of lower priority run beside it, and must count the deadlines missed
+// when a task runs longer than the slack.
+
+#include "TestUtils.h"
+#include "utils/TaskScheduler.h"
+
+#define CONTROL_PERIOD_MS 25
+#define RUN_TIME_US 10000000UL
+#define IDLE_STEP_US 10  // Time of a call to run() with nothing to do
+
+unsigned long control_runs = 0;
+unsigned long last_control_us = 0;
+long max_jitter_us = 0;
+unsigned long background_runs = 0;
+
+// Each task advances the simulated clock by its run time
+void controlTask() {
+  if (control_runs > 0) {
+    const long period_us = (long)(stub_micros - last_control_us);
+    const long jitter_us = labs(period_us - CONTROL_PERIOD_MS * 1000L);
+    max_jitter_us = max(max_jitter_us, jitter_us);
+  }
+  last_control_us = stub_micros;
+  ++control_runs;
+  stub_micros += 3000;
+}
+
+void lcdTask() { stub_micros += 12000; }
+
+void telemetryTask() { stub_micros += 4000; }
+
+void backgroundTask() {
+  ++background_runs;
+  stub_micros += 200;
+}
+
+void hogTask() { stub_micros += 60000; }
+
+void resetControlTask() {
+  control_runs = 0;
+  max_jitter_us = 0;
+}
+
+// Runs the scheduler for the given time of the simulated clock
+void runFor(TaskScheduler& scheduler, const unsigned long time_us) {
+  const unsigned long start_us = stub_micros;
+  while (stub_micros - start_us < time_us) {
+    if (!scheduler.run()) stub_micros += IDLE_STEP_US;
+  }
+}
+
+void testControlPeriodIsHeld() {
+  resetControlTask();
+  TaskScheduler scheduler;
+  const int control = scheduler.addTask(controlTask, CONTROL_PERIOD_MS, 3);
+  const int lcd = scheduler.addTask(lcdTask, 200, 0);
+  const int telemetry = scheduler.addTask(telemetryTask, 100, 1);
+  const int background = scheduler.addTask(backgroundTask, 0);
+  scheduler.start();
+  runFor(scheduler, RUN_TIME_US);
+
+  printf("  control period held within %ld us, load %.1f %%\n", max_jitter_us,
+         scheduler.getLoad());
+  // The control task waits at most for the 12 ms LCD task, which fits in
+  // its slack, so only the idle steps and the clock reads of the scheduler
+  // remain
+  CHECK(max_jitter_us <= 200);
+  CHECK_NEAR(control_runs, RUN_TIME_US / (CONTROL_PERIOD_MS * 1000), 1);
+  CHECK(scheduler.getStats(control).missed_deadlines == 0);
+  CHECK(scheduler.getStats(lcd).missed_deadlines == 0);
+  CHECK(scheduler.getStats(telemetry).missed_deadlines == 0);
+  CHECK(scheduler.getStats(lcd).max_run_us >= 12000);
+  CHECK(scheduler.getStats(background).run_count > 0);
+  CHECK(background_runs > 0);
+  // 3 ms every 25 ms, 12 ms every 200 ms and 4 ms every 100 ms
+  CHECK_NEAR(scheduler.getLoad(), 22, 1);
+}
+
+void testOverrunsAreCounted() {
+  resetControlTask();
+  TaskScheduler scheduler;
+  const int control = scheduler.addTask(controlTask, CONTROL_PERIOD_MS, 1);
+  const int hog = scheduler.addTask(hogTask, 100, 0);
+  scheduler.start();
+  runFor(scheduler, 1000000);
+
+  printf("  60 ms task: %lu misses, control task: %lu misses\n",
+         scheduler.getStats(hog).missed_deadlines,
+         scheduler.getStats(control).missed_deadlines);
+  // The 60 ms task is longer than two control periods, so a release of the
+  // control task is skipped
+  CHECK(scheduler.getStats(control).missed_deadlines > 0);
+  CHECK(scheduler.getStats(hog).max_run_us >= 60000);
+  CHECK(max_jitter_us > 5000);
+}
+
+int main() {
+  testControlPeriodIsHeld();
+  testOverrunsAreCounted();
+  return TEST_RESULT();
+}